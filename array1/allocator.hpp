@@ -0,0 +1,182 @@
+#ifndef ALLOCATOR_HPP_
+#define ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <new>
+#include <limits>
+#include <memory>
+
+#include "parallel.hpp"
+
+namespace array {
+
+    // Default buffer alignment: one cache line, which is also the width of an AVX-512 register.
+    constexpr std::size_t kDefaultAlignment = 64;
+
+    // #######################
+    // AlignedAllocator
+    // #######################
+    // Standard-conforming allocator returning storage aligned to `Alignment` bytes.
+    template <typename T, std::size_t Alignment = kDefaultAlignment>
+    class AlignedAllocator {
+        static_assert((Alignment & (Alignment - 1)) == 0, "AlignedAllocator: alignment must be a power of two");
+        static_assert(Alignment >= alignof(T), "AlignedAllocator: alignment smaller than alignof(T)");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        static constexpr std::size_t alignment = Alignment;
+
+        template <typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept { }
+
+        T* allocate(const std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        void deallocate(T* p, const std::size_t) noexcept {
+            ::operator delete(p, std::align_val_t(Alignment));
+        }
+    };
+
+    template <typename T, typename U, std::size_t Alignment>
+    inline bool operator==(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept {
+        return true;
+    }
+
+    template <typename T, typename U, std::size_t Alignment>
+    inline bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&) noexcept {
+        return false;
+    }
+
+    // #######################
+    // FirstTouchAllocator
+    // #######################
+    // AlignedAllocator that touches every page of a new block from the thread
+    // that ParallelForStatic will later assign it to, so that on NUMA systems
+    // each page is placed on the node of the thread that works on it, e.g.
+    //     Array3D<double, FirstTouchAllocator<double>> u(nx, ny, nz);
+    template <typename T, std::size_t Alignment = kDefaultAlignment>
+    class FirstTouchAllocator : public AlignedAllocator<T, Alignment> {
+    public:
+        template <typename U>
+        struct rebind {
+            using other = FirstTouchAllocator<U, Alignment>;
+        };
+
+        FirstTouchAllocator() noexcept = default;
+
+        template <typename U>
+        FirstTouchAllocator(const FirstTouchAllocator<U, Alignment>&) noexcept { }
+
+        T* allocate(const std::size_t n) {
+            T* ptr = AlignedAllocator<T, Alignment>::allocate(n);
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(ptr);
+            ParallelForStatic(n, PageElements<T>(), [bytes](const std::size_t begin, const std::size_t end) {
+                for (std::size_t offset = begin * sizeof(T); offset < end * sizeof(T); offset += kPageSize) {
+                    bytes[offset] = 0;
+                }
+            });
+            return ptr;
+        }
+    };
+
+    template <typename T, typename U, std::size_t Alignment>
+    inline bool operator==(const FirstTouchAllocator<T, Alignment>&, const FirstTouchAllocator<U, Alignment>&) noexcept {
+        return true;
+    }
+
+    template <typename T, typename U, std::size_t Alignment>
+    inline bool operator!=(const FirstTouchAllocator<T, Alignment>&, const FirstTouchAllocator<U, Alignment>&) noexcept {
+        return false;
+    }
+
+    // #######################
+    // OffsetAllocator
+    // #######################
+    // Allocator whose blocks start Offset() elements into a block of the
+    // underlying Allocator, so that an element other than the first one
+    // lands on its alignment (HaloArray aligns its interior rows this way).
+    // The blocks themselves are only aligned to alignof(value_type).
+    template <typename Allocator>
+    class OffsetAllocator {
+        using Traits = std::allocator_traits<Allocator>;
+
+    public:
+        using value_type = typename Traits::value_type;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        template <typename U>
+        struct rebind {
+            using other = OffsetAllocator<typename Traits::template rebind_alloc<U>>;
+        };
+
+        OffsetAllocator() noexcept : allocator_(), offset_(0) { }
+
+        explicit OffsetAllocator(const std::size_t offset, const Allocator& allocator = Allocator()) noexcept
+        : allocator_(allocator), offset_(offset) { }
+
+        template <typename OtherAllocator>
+        OffsetAllocator(const OffsetAllocator<OtherAllocator>& other) noexcept : allocator_(other.Underlying()), offset_(other.Offset()) { }
+
+        value_type* allocate(const std::size_t n) {
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(value_type) - offset_) {
+                throw std::bad_array_new_length();
+            }
+            return Traits::allocate(allocator_, n + offset_) + offset_;
+        }
+
+        void deallocate(value_type* p, const std::size_t n) noexcept {
+            Traits::deallocate(allocator_, p - offset_, n + offset_);
+        }
+
+        inline std::size_t Offset() const noexcept { return offset_; }
+        inline const Allocator& Underlying() const noexcept { return allocator_; }
+
+    private:
+        Allocator allocator_;
+        std::size_t offset_;
+    };
+
+    template <typename A, typename B>
+    inline bool operator==(const OffsetAllocator<A>& lhs, const OffsetAllocator<B>& rhs) noexcept {
+        return lhs.Offset() == rhs.Offset() && lhs.Underlying() == rhs.Underlying();
+    }
+
+    template <typename A, typename B>
+    inline bool operator!=(const OffsetAllocator<A>& lhs, const OffsetAllocator<B>& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    // Alignment guaranteed by an allocator. Allocators that do not declare one
+    // (e.g. std::allocator) only guarantee alignof(value_type).
+    template <typename Allocator>
+    struct AllocatorAlignment {
+        static constexpr std::size_t value = alignof(typename Allocator::value_type);
+    };
+
+    template <typename T, std::size_t Alignment>
+    struct AllocatorAlignment<AlignedAllocator<T, Alignment>> {
+        static constexpr std::size_t value = Alignment;
+    };
+
+    template <typename T, std::size_t Alignment>
+    struct AllocatorAlignment<FirstTouchAllocator<T, Alignment>> {
+        static constexpr std::size_t value = Alignment;
+    };
+}
+
+#endif /* ALLOCATOR_HPP_ */
@@ -7,5 +7,18 @@
 #include "array4d.hpp"
 #include "array5d.hpp"
 #include "array6d.hpp"
+#include "expression.hpp"
+#include "reduction.hpp"
+#include "loop.hpp"
+#include "transpose.hpp"
+#include "matmul.hpp"
+#include "stencil.hpp"
+#include "halo_array.hpp"
+#include "mapped_array.hpp"
+#include "io.hpp"
+#include "npy.hpp"
+#include "chunked.hpp"
+#include "checkpoint.hpp"
+#include "convert.hpp"
 
 #endif /* ARRAY_HPP_ */
\ No newline at end of file
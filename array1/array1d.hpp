@@ -2,18 +2,19 @@
 #define ARRAY1D_HPP_
 
 #include "array_base.hpp"
+#include "array_view.hpp"
 
 namespace array
 {
-    template <typename T>
-    class Array1D : public ArrayBase<T> {
+    template <typename T, typename Allocator = AlignedAllocator<T>>
+    class Array1D : public ArrayBase<T, Allocator> {
     public:
-        Array1D() : ArrayBase<T>({0}) { }
+        Array1D() : ArrayBase<T, Allocator>({0}) { }
 
-        explicit Array1D(const std::size_t n1) : ArrayBase<T>(std::initializer_list<std::size_t>{n1}) { }
+        explicit Array1D(const std::size_t n1) : ArrayBase<T, Allocator>(std::initializer_list<std::size_t>{n1}) { }
 
         Array1D(const std::size_t n1, const T value)
-        : ArrayBase<T>(std::initializer_list<std::size_t>{n1}, value) { }
+        : ArrayBase<T, Allocator>(std::initializer_list<std::size_t>{n1}, value) { }
 
         inline std::size_t Dim1() const { return this->shape_[0]; }
 
@@ -44,12 +45,30 @@ namespace array
         }
 
         void Resize(const std::size_t n1) {
-            std::vector<std::size_t> shape_new = {n1};
+            ArrayShape shape_new = {n1};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Resize(shape_new);
+                ArrayBase<T, Allocator>::Resize(shape_new);
             }
         }
 
+        inline ArrayView<T, 1> View() {
+            return ArrayView<T, 1>(this->ptr_raw_data_, {Dim1()});
+        }
+
+        inline ArrayView<const T, 1> View() const {
+            return ArrayView<const T, 1>(this->ptr_raw_data_, {Dim1()});
+        }
+
+        template <typename E>
+        Array1D& operator=(const Expression<E>& expression) {
+            this->AssignExpression(expression);
+            return *this;
+        }
+
+        // Rank 1 is the same in every layout.
+        template <typename OtherLayout>
+        using rebind_layout = Array1D;
+
         virtual std::size_t  NumDimensions() const noexcept override {
             return 1;
         };
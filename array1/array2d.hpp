@@ -2,29 +2,48 @@
 #define ARRAY2D_HPP_
 
 #include "array_base.hpp"
+#include "array_view.hpp"
+#include "layout.hpp"
 #include "array1d.hpp"
 
 namespace array
 {
-    template <typename T>
-    class Array2D : public ArrayBase<T> {
+    template <typename T, typename Allocator = AlignedAllocator<T>, typename Layout = RowMajor>
+    class Array2D : public ArrayBase<T, Allocator, Layout> {
     public:
-        Array2D() : ArrayBase<T>({0, 0}) { }
+        Array2D() : ArrayBase<T, Allocator, Layout>({0, 0}) { }
 
-        explicit Array2D(const std::size_t n1, const std::size_t n2) : ArrayBase<T>({n1, n2}) { }
+        explicit Array2D(const std::size_t n1, const std::size_t n2) : ArrayBase<T, Allocator, Layout>({n1, n2}) { }
 
         Array2D(const std::size_t n1, const std::size_t n2, const T value)
-        : ArrayBase<T>({n1, n2}, value) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2}, value) { }
+
+        // Rows along the contiguous axis padded as `padding` says, e.g.
+        // Array2D<double> a(2048, 2048, Padding::Auto()); see Pitch().
+        Array2D(const std::size_t n1, const std::size_t n2, const Padding padding)
+        : ArrayBase<T, Allocator, Layout>({n1, n2}, padding) { }
+
+        Array2D(const std::size_t n1, const std::size_t n2, const Padding padding, const T value)
+        : ArrayBase<T, Allocator, Layout>({n1, n2}, padding, value) { }
 
         inline std::size_t Dim1() const { return this->shape_[0]; }
         inline std::size_t Dim2() const { return this->shape_[1]; }
 
+        // Flat offset of (i, j) in the storage order of Layout.
+        inline std::size_t Offset(const std::size_t i, const std::size_t j) const {
+            if constexpr (Layout::kIsColumnMajor) {
+                return j * this->pitch_ + i;
+            } else {
+                return i * this->pitch_ + j;
+            }
+        }
+
         inline T& operator()(const std::size_t i, const std::size_t j) {
-            return this->ptr_raw_data_[i * this->shape_[1] + j];
+            return this->ptr_raw_data_[Offset(i, j)];
         }
 
         inline const T& operator()(const std::size_t i, const std::size_t j) const {
-            return this->ptr_raw_data_[i * this->shape_[1] + j];
+            return this->ptr_raw_data_[Offset(i, j)];
         }
 
         T& At(const std::size_t i, const std::size_t j) {
@@ -45,26 +64,50 @@ namespace array
             return (*this)(i, j);
         }
 
+        inline ArrayView<T, 2> View() {
+            return ArrayView<T, 2>(this->ptr_raw_data_, {Dim1(), Dim2()}, LayoutStrides<Layout, 2>({Dim1(), Dim2()}, this->pitch_));
+        }
+
+        inline ArrayView<const T, 2> View() const {
+            return ArrayView<const T, 2>(this->ptr_raw_data_, {Dim1(), Dim2()}, LayoutStrides<Layout, 2>({Dim1(), Dim2()}, this->pitch_));
+        }
+
+        template <typename E>
+        Array2D& operator=(const Expression<E>& expression) {
+            this->AssignExpression(expression);
+            return *this;
+        }
+
+        // Same array type with another memory layout.
+        template <typename OtherLayout>
+        using rebind_layout = Array2D<T, Allocator, OtherLayout>;
+
         virtual std::size_t  NumDimensions() const noexcept override {
             return 2;
         };
 
+        // Changes the padding of the rows, keeping the values.
+        using ArrayBase<T, Allocator, Layout>::SetPadding;
+
         void Resize(const std::size_t n1, const std::size_t n2) {
-            std::vector<std::size_t> shape_new = {n1, n2};
+            ArrayShape shape_new = {n1, n2};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Resize(shape_new);
+                ArrayBase<T, Allocator, Layout>::Resize(shape_new);
             }
         }
 
         void Reshape(const std::size_t n1, const std::size_t n2) {
-            std::vector<std::size_t> shape_new = {n1, n2};
+            ArrayShape shape_new = {n1, n2};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Reshape(shape_new);
+                ArrayBase<T, Allocator, Layout>::Reshape(shape_new);
             }
         }
 
     private:
     };
+
+    template <typename T, typename Allocator = AlignedAllocator<T>>
+    using ColumnMajorArray2D = Array2D<T, Allocator, ColumnMajor>;
 }
 
 #endif /* ARRAY2D_HPP_ */
\ No newline at end of file
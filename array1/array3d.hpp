@@ -2,30 +2,48 @@
 #define ARRAY3D_HPP_
 
 #include "array_base.hpp"
+#include "array_view.hpp"
+#include "layout.hpp"
 
 namespace array
 {
-    template <typename T>
-    class Array3D : public ArrayBase<T> {
+    template <typename T, typename Allocator = AlignedAllocator<T>, typename Layout = RowMajor>
+    class Array3D : public ArrayBase<T, Allocator, Layout> {
     public:
-        Array3D() : ArrayBase<T>({0, 0, 0}) { }
+        Array3D() : ArrayBase<T, Allocator, Layout>({0, 0, 0}) { }
 
         explicit Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3)
-        : ArrayBase<T>({n1, n2, n3}) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3}) { }
 
         Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T value)
-        : ArrayBase<T>({n1, n2, n3}, value) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3}, value) { }
+
+        // Rows along the contiguous axis padded as `padding` says; see Pitch().
+        Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const Padding padding)
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3}, padding) { }
+
+        Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const Padding padding, const T value)
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3}, padding, value) { }
 
         inline std::size_t Dim1() const { return this->shape_[0]; }
         inline std::size_t Dim2() const { return this->shape_[1]; }
         inline std::size_t Dim3() const { return this->shape_[2]; }
 
+        // Flat offset of (i, j, k) in the storage order of Layout.
+        inline std::size_t Offset(const std::size_t i, const std::size_t j, const std::size_t k) const {
+            if constexpr (Layout::kIsColumnMajor) {
+                return (k * this->shape_[1] + j) * this->pitch_ + i;
+            } else {
+                return (i * this->shape_[1] + j) * this->pitch_ + k;
+            }
+        }
+
         inline T& operator()(const std::size_t i, const std::size_t j, const std::size_t k) {
-            return this->ptr_raw_data_[(i * this->shape_[1] + j) * this->shape_[2] + k];
+            return this->ptr_raw_data_[Offset(i, j, k)];
         }
 
         inline const T& operator()(const std::size_t i, const std::size_t j, const std::size_t k) const {
-            return this->ptr_raw_data_[(i * this->shape_[1] + j) * this->shape_[2] + k];
+            return this->ptr_raw_data_[Offset(i, j, k)];
         }
 
         T& At(const std::size_t i, const std::size_t j, const std::size_t k) {
@@ -46,26 +64,50 @@ namespace array
             return (*this)(i, j, k);
         }
 
+        inline ArrayView<T, 3> View() {
+            return ArrayView<T, 3>(this->ptr_raw_data_, {Dim1(), Dim2(), Dim3()}, LayoutStrides<Layout, 3>({Dim1(), Dim2(), Dim3()}, this->pitch_));
+        }
+
+        inline ArrayView<const T, 3> View() const {
+            return ArrayView<const T, 3>(this->ptr_raw_data_, {Dim1(), Dim2(), Dim3()}, LayoutStrides<Layout, 3>({Dim1(), Dim2(), Dim3()}, this->pitch_));
+        }
+
+        template <typename E>
+        Array3D& operator=(const Expression<E>& expression) {
+            this->AssignExpression(expression);
+            return *this;
+        }
+
+        // Same array type with another memory layout.
+        template <typename OtherLayout>
+        using rebind_layout = Array3D<T, Allocator, OtherLayout>;
+
         virtual std::size_t  NumDimensions() const noexcept override {
             return 3;
         };
 
+        // Changes the padding of the rows, keeping the values.
+        using ArrayBase<T, Allocator, Layout>::SetPadding;
+
         void Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3) {
-            std::vector<std::size_t> shape_new = {n1, n2, n3};
+            ArrayShape shape_new = {n1, n2, n3};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Resize(shape_new);
+                ArrayBase<T, Allocator, Layout>::Resize(shape_new);
             }
         }
 
         void Reshape(const std::size_t n1, const std::size_t n2, const std::size_t n3) {
-            std::vector<std::size_t> shape_new = {n1, n2, n3};
+            ArrayShape shape_new = {n1, n2, n3};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Reshape(shape_new);
+                ArrayBase<T, Allocator, Layout>::Reshape(shape_new);
             }
         }
 
     private:
     };
+
+    template <typename T, typename Allocator = AlignedAllocator<T>>
+    using ColumnMajorArray3D = Array3D<T, Allocator, ColumnMajor>;
 }
 
 #endif /* ARRAY3D_HPP_ */
\ No newline at end of file
@@ -2,31 +2,42 @@
 #define ARRAY4D_HPP_
 
 #include "array_base.hpp"
+#include "array_view.hpp"
+#include "layout.hpp"
 
 namespace array
 {
-    template <typename T>
-    class Array4D : public ArrayBase<T> {
+    template <typename T, typename Allocator = AlignedAllocator<T>, typename Layout = RowMajor>
+    class Array4D : public ArrayBase<T, Allocator, Layout> {
     public:
-        Array4D() : ArrayBase<T>({0, 0, 0, 0}) { }
+        Array4D() : ArrayBase<T, Allocator, Layout>({0, 0, 0, 0}) { }
 
         explicit Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4)
-        : ArrayBase<T>({n1, n2, n3, n4}) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3, n4}) { }
 
         Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T value)
-        : ArrayBase<T>({n1, n2, n3, n4}, value) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3, n4}, value) { }
 
         inline std::size_t Dim1() const { return this->shape_[0]; }
         inline std::size_t Dim2() const { return this->shape_[1]; }
         inline std::size_t Dim3() const { return this->shape_[2]; }
         inline std::size_t Dim4() const { return this->shape_[3]; }
 
+        // Flat offset of (i, j, k, l) in the storage order of Layout.
+        inline std::size_t Offset(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l) const {
+            if constexpr (Layout::kIsColumnMajor) {
+                return ((l * this->shape_[2] + k) * this->shape_[1] + j) * this->shape_[0] + i;
+            } else {
+                return ((i * this->shape_[1] + j) * this->shape_[2] + k) * this->shape_[3] + l;
+            }
+        }
+
         inline T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l) {
-            return this->ptr_raw_data_[((i * this->shape_[1] + j) * this->shape_[2] + k) * this->shape_[3] + l];
+            return this->ptr_raw_data_[Offset(i, j, k, l)];
         }
 
         inline const T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l) const {
-            return this->ptr_raw_data_[((i * this->shape_[1] + j) * this->shape_[2] + k) * this->shape_[3] + l];
+            return this->ptr_raw_data_[Offset(i, j, k, l)];
         }
 
         T& At(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l) {
@@ -47,26 +58,47 @@ namespace array
             return (*this)(i, j, k, l);
         }
 
+        inline ArrayView<T, 4> View() {
+            return ArrayView<T, 4>(this->ptr_raw_data_, {Dim1(), Dim2(), Dim3(), Dim4()}, LayoutStrides<Layout, 4>({Dim1(), Dim2(), Dim3(), Dim4()}));
+        }
+
+        inline ArrayView<const T, 4> View() const {
+            return ArrayView<const T, 4>(this->ptr_raw_data_, {Dim1(), Dim2(), Dim3(), Dim4()}, LayoutStrides<Layout, 4>({Dim1(), Dim2(), Dim3(), Dim4()}));
+        }
+
+        template <typename E>
+        Array4D& operator=(const Expression<E>& expression) {
+            this->AssignExpression(expression);
+            return *this;
+        }
+
+        // Same array type with another memory layout.
+        template <typename OtherLayout>
+        using rebind_layout = Array4D<T, Allocator, OtherLayout>;
+
         virtual std::size_t  NumDimensions() const noexcept override {
             return 4;
         };
 
         void Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4) {
-            std::vector<std::size_t> shape_new = {n1, n2, n3, n4};
+            ArrayShape shape_new = {n1, n2, n3, n4};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Resize(shape_new);
+                ArrayBase<T, Allocator, Layout>::Resize(shape_new);
             }
         }
 
         void Reshape(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4) {
-            std::vector<std::size_t> shape_new = {n1, n2, n3, n4};
+            ArrayShape shape_new = {n1, n2, n3, n4};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Reshape(shape_new);
+                ArrayBase<T, Allocator, Layout>::Reshape(shape_new);
             }
         }
 
     private:
     };
+
+    template <typename T, typename Allocator = AlignedAllocator<T>>
+    using ColumnMajorArray4D = Array4D<T, Allocator, ColumnMajor>;
 }
 
 #endif /* ARRAY4D_HPP_ */
\ No newline at end of file
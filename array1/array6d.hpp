@@ -2,19 +2,21 @@
 #define ARRAY6D_HPP_
 
 #include "array_base.hpp"
+#include "array_view.hpp"
+#include "layout.hpp"
 
 namespace array
 {
-    template <typename T>
-    class Array6D : public ArrayBase<T> {
+    template <typename T, typename Allocator = AlignedAllocator<T>, typename Layout = RowMajor>
+    class Array6D : public ArrayBase<T, Allocator, Layout> {
     public:
-        Array6D() : ArrayBase<T>({0, 0, 0, 0, 0, 0}) { }
+        Array6D() : ArrayBase<T, Allocator, Layout>({0, 0, 0, 0, 0, 0}) { }
 
         explicit Array6D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const std::size_t n6)
-        : ArrayBase<T>({n1, n2, n3, n4, n5, n6}) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3, n4, n5, n6}) { }
 
         Array6D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const std::size_t n6, const T value)
-        : ArrayBase<T>({n1, n2, n3, n4, n5, n6}, value) { }
+        : ArrayBase<T, Allocator, Layout>({n1, n2, n3, n4, n5, n6}, value) { }
 
         inline std::size_t Dim1() const { return this->shape_[0]; }
         inline std::size_t Dim2() const { return this->shape_[1]; }
@@ -23,12 +25,21 @@ namespace array
         inline std::size_t Dim5() const { return this->shape_[4]; }
         inline std::size_t Dim6() const { return this->shape_[5]; }
 
+        // Flat offset of (i, j, k, l, m, n) in the storage order of Layout.
+        inline std::size_t Offset(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m, const std::size_t n) const {
+            if constexpr (Layout::kIsColumnMajor) {
+                return ((((n * this->shape_[4] + m) * this->shape_[3] + l) * this->shape_[2] + k) * this->shape_[1] + j) * this->shape_[0] + i;
+            } else {
+                return ((((i * this->shape_[1] + j) * this->shape_[2] + k) * this->shape_[3] + l) * this->shape_[4] + m) * this->shape_[5] + n;
+            }
+        }
+
         inline T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m, const std::size_t n) {
-            return this->ptr_raw_data_[((((i * this->shape_[1] + j) * this->shape_[2] + k) * this->shape_[3] + l) * this->shape_[4] + m) * this->shape_[5] + n];
+            return this->ptr_raw_data_[Offset(i, j, k, l, m, n)];
         }
 
         inline const T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m, const std::size_t n) const {
-            return this->ptr_raw_data_[((((i * this->shape_[1] + j) * this->shape_[2] + k) * this->shape_[3] + l) * this->shape_[4] + m) * this->shape_[5] + n];
+            return this->ptr_raw_data_[Offset(i, j, k, l, m, n)];
         }
 
         T& At(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m, const std::size_t n) {
@@ -49,26 +60,47 @@ namespace array
             return (*this)(i, j, k, l, m, n);
         }
 
+        inline ArrayView<T, 6> View() {
+            return ArrayView<T, 6>(this->ptr_raw_data_, {Dim1(), Dim2(), Dim3(), Dim4(), Dim5(), Dim6()}, LayoutStrides<Layout, 6>({Dim1(), Dim2(), Dim3(), Dim4(), Dim5(), Dim6()}));
+        }
+
+        inline ArrayView<const T, 6> View() const {
+            return ArrayView<const T, 6>(this->ptr_raw_data_, {Dim1(), Dim2(), Dim3(), Dim4(), Dim5(), Dim6()}, LayoutStrides<Layout, 6>({Dim1(), Dim2(), Dim3(), Dim4(), Dim5(), Dim6()}));
+        }
+
+        template <typename E>
+        Array6D& operator=(const Expression<E>& expression) {
+            this->AssignExpression(expression);
+            return *this;
+        }
+
+        // Same array type with another memory layout.
+        template <typename OtherLayout>
+        using rebind_layout = Array6D<T, Allocator, OtherLayout>;
+
         virtual std::size_t  NumDimensions() const noexcept override {
             return 6;
         };
 
         void Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const std::size_t n6) {
-            std::vector<std::size_t> shape_new = {n1, n2, n3, n4, n5, n6};
+            ArrayShape shape_new = {n1, n2, n3, n4, n5, n6};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Resize(shape_new);
+                ArrayBase<T, Allocator, Layout>::Resize(shape_new);
             }
         }
 
         void Reshape(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const std::size_t n6) {
-            std::vector<std::size_t> shape_new = {n1, n2, n3, n4, n5, n6};
+            ArrayShape shape_new = {n1, n2, n3, n4, n5, n6};
             if (shape_new != this->shape_) {
-                ArrayBase<T>::Reshape(shape_new);
+                ArrayBase<T, Allocator, Layout>::Reshape(shape_new);
             }
         }
 
     private:
     };
+
+    template <typename T, typename Allocator = AlignedAllocator<T>>
+    using ColumnMajorArray6D = Array6D<T, Allocator, ColumnMajor>;
 }
 
 #endif /* ARRAY6D_HPP_ */
\ No newline at end of file
@@ -1,70 +1,99 @@
 #ifndef ARRAY_BASE_HPP_
 #define ARRAY_BASE_HPP_
 
-#include <vector>
 #include <algorithm>
+#include <atomic>
 #include <initializer_list>
 #include <limits>
 #include <cmath>
 #include <stdexcept>
-
+#include <string>
+#include <memory>
+
+#include "allocator.hpp"
+#include "layout.hpp"
+#include "parallel.hpp"
+#include "shape.hpp"
+#include "simd.hpp"
+#include "array_view.hpp"
 #include "array1d.hpp"
 
 
 namespace array {
-    template <typename T>
+    template <typename T, typename Allocator>
     class Array1D;
 
+    template <typename E>
+    class Expression;
+
     enum class ArrayStatus {
         Empty,
         Allocated
     };
 
-    template <typename T>
+    // Layout (RowMajor or ColumnMajor, see layout.hpp) fixes the order of the
+    // elements in Data(). Flat operations (Fill, Copy, compound assignment,
+    // expressions, FlatView and the reductions over it) run in storage order,
+    // which is the same for every array of one layout type.
+    //
+    // The rows along the innermost axis may be padded (see Padding in
+    // layout.hpp; Array2D and Array3D expose it): they then start Pitch()
+    // elements apart and the storage spans StorageSize() > Size() elements.
+    // Every operation of the class skips the padding; raw loops over
+    // Data()..End() must go row by row (RowView) unless IsContiguous().
+    template <typename T, typename Allocator = AlignedAllocator<T>, typename Layout = RowMajor>
     class ArrayBase {
     public:
         using value_type = T;
+        using allocator_type = Allocator;
+        using layout_type = Layout;
+
+        // Alignment in bytes guaranteed for Data() of every allocated array.
+        static constexpr std::size_t kAlignment = AllocatorAlignment<Allocator>::value;
 
         // #######################
         // Constructors
         // #######################
-        ArrayBase() noexcept : shape_({}), size_(0), ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) { }
+        ArrayBase() noexcept
+        : shape_(), size_(0), capacity_(0), padding_(), pitch_(0), ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) { }
+
+        ArrayBase(std::initializer_list<std::size_t> shape) : ArrayBase(shape, Padding::None()) { }
+
+        ArrayBase(std::initializer_list<std::size_t> shape, const T value) : ArrayBase(shape, Padding::None(), value) { }
 
-        ArrayBase(std::initializer_list<std::size_t> shape)
-        : shape_(shape), size_(ComputeSize(shape_)), ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) {
+        ArrayBase(std::initializer_list<std::size_t> shape, const Padding padding)
+        : shape_(shape), size_(ComputeSize(shape_)), capacity_(0), padding_(padding), pitch_(ComputePitch(shape_)),
+          ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) {
             AllocateArray();
         }
 
-        ArrayBase(std::initializer_list<std::size_t> shape, const T value)
-        : shape_(shape), size_(ComputeSize(shape_)), ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) {
-            AllocateArray();
+        ArrayBase(std::initializer_list<std::size_t> shape, const Padding padding, const T value) : ArrayBase(shape, padding) {
             Fill(value);
         }
 
         // Copy constructor
         ArrayBase(const ArrayBase& other) noexcept
-            : shape_(other.shape_), size_(other.size_), ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) {
+            : shape_(other.shape_), size_(other.size_), capacity_(0), padding_(other.padding_), pitch_(other.pitch_),
+              ptr_raw_data_(nullptr), status_(ArrayStatus::Empty) {
             AllocateArray();
             if (other.IsAllocated()) {
-                std::copy(other.Begin(), other.End(), ptr_raw_data_);
+                ParallelCopy(other.ptr_raw_data_, other.StorageSize(), ptr_raw_data_);
             }
         }
 
-        // Copy assignment
+        // Copy assignment (the padding of other included)
         ArrayBase& operator=(const ArrayBase& other) {
             if (this == &other) {
                 return *this;
             }
 
-            if (shape_ != other.shape_) {
-                DeleteArray();
-                shape_ = other.shape_;
-                size_ = other.size_;
-                AllocateArray();
+            if (shape_ != other.shape_ || padding_ != other.padding_) {
+                padding_ = other.padding_;
+                Resize(other.shape_);
             }
 
             if (other.IsAllocated()) {
-                std::copy(other.Begin(), other.End(), ptr_raw_data_);
+                ParallelCopy(other.ptr_raw_data_, other.StorageSize(), ptr_raw_data_);
             }
 
             return *this;
@@ -72,8 +101,12 @@ namespace array {
 
         // Move constructor
         ArrayBase(ArrayBase&& other) noexcept
-        : shape_(std::move(other.shape_)), size_(other.size_), ptr_raw_data_(other.ptr_raw_data_), status_(other.status_) {
+        : shape_(std::move(other.shape_)), size_(other.size_), capacity_(other.capacity_), padding_(other.padding_), pitch_(other.pitch_),
+          ptr_raw_data_(other.ptr_raw_data_), status_(other.status_), allocator_(std::move(other.allocator_)) {
+            other.shape_.clear();
             other.size_ = 0;
+            other.capacity_ = 0;
+            other.pitch_ = 0;
             other.ptr_raw_data_ = nullptr;
             other.status_ = ArrayStatus::Empty;
         }
@@ -87,10 +120,17 @@ namespace array {
             DeleteArray();
             shape_ = std::move(other.shape_);
             size_ = other.size_;
+            capacity_ = other.capacity_;
+            padding_ = other.padding_;
+            pitch_ = other.pitch_;
             ptr_raw_data_ = other.ptr_raw_data_;
             status_ = other.status_;
+            allocator_ = std::move(other.allocator_);
 
+            other.shape_.clear();
             other.size_ = 0;
+            other.capacity_ = 0;
+            other.pitch_ = 0;
             other.ptr_raw_data_ = nullptr;
             other.status_ = ArrayStatus::Empty;
 
@@ -101,17 +141,47 @@ namespace array {
             DeleteArray();
         }
 
-        inline const std::vector<std::size_t>& Shape() const noexcept { return shape_; }
+        inline const ArrayShape& Shape() const noexcept { return shape_; }
         inline std::size_t Size() const noexcept { return size_; }
 
+        // Number of elements the current allocation can hold without reallocating.
+        inline std::size_t Capacity() const noexcept { return capacity_; }
+
+        // Distance in elements between the starts of consecutive rows along
+        // the innermost axis (the last one, or the first for ColumnMajor):
+        // the row length unless the rows are padded.
+        inline std::size_t Pitch() const noexcept { return pitch_; }
+        inline const Padding& GetPadding() const noexcept { return padding_; }
+
+        // True when no padding separates the rows, i.e. the Size() elements
+        // are Data()[0, Size()).
+        inline bool IsContiguous() const noexcept { return pitch_ == RowLength(); }
+
+        // Elements spanned by the storage, padding included: Data()..End().
+        inline std::size_t StorageSize() const noexcept { return NumRows() * pitch_; }
+
+        // Rows along the innermost axis and their length.
+        inline std::size_t RowLength() const noexcept {
+            return shape_.empty() ? 0 : shape_[Layout::kIsColumnMajor ? 0 : shape_.size() - 1];
+        }
+
+        inline std::size_t NumRows() const noexcept {
+            const std::size_t length = RowLength();
+            return length == 0 ? 0 : size_ / length;
+        }
+
         inline T* Data() noexcept { return ptr_raw_data_; }
         inline const T* Data() const noexcept { return ptr_raw_data_; }
 
+        // Data() with the allocator alignment made visible to the optimizer.
+        inline T* AlignedData() noexcept { return AssumeAligned(ptr_raw_data_); }
+        inline const T* AlignedData() const noexcept { return AssumeAligned(ptr_raw_data_); }
+
         inline T* Begin() noexcept { return ptr_raw_data_; }
         inline const T* Begin() const noexcept { return ptr_raw_data_; }
 
-        inline T* End() noexcept { return ptr_raw_data_ + size_; }
-        inline const T* End() const noexcept { return ptr_raw_data_ + size_; }
+        inline T* End() noexcept { return ptr_raw_data_ + StorageSize(); }
+        inline const T* End() const noexcept { return ptr_raw_data_ + StorageSize(); }
 
         inline bool IsEmpty() const noexcept { return status_ == ArrayStatus::Empty; }
         inline bool IsAllocated() const noexcept { return status_ == ArrayStatus::Allocated; }
@@ -126,99 +196,539 @@ namespace array {
             Resize(other.shape_);
         }
 
+        // Same shape as an array of another allocator or layout, e.g. before a layout conversion.
+        template <typename OtherAllocator, typename OtherLayout>
+        void ResizeLike(const ArrayBase<T, OtherAllocator, OtherLayout>& other) {
+            Resize(other.Shape());
+        }
+
+        // Grows the allocation to hold at least n elements. Current contents are kept.
+        void Reserve(const std::size_t n) {
+            if (n > capacity_) {
+                Reallocate(n);
+            }
+        }
+
+        // Releases the capacity beyond StorageSize(). Current contents are kept.
+        void ShrinkToFit() {
+            if (capacity_ > StorageSize()) {
+                if (size_ == 0) {
+                    DeallocateStorage(ptr_raw_data_, capacity_);
+                    ptr_raw_data_ = nullptr;
+                    capacity_ = 0;
+                    status_ = ArrayStatus::Empty;
+                } else {
+                    Reallocate(StorageSize());
+                }
+            }
+        }
+
+        // Fill, Zero, Ones, Copy and copying construction/assignment split arrays of
+        // kParallelThreshold elements or more across ThreadPool::Global() with
+        // ParallelForStatic, i.e. with the same partition as FirstTouchAllocator.
+        // Fill, Zero and Ones also write the padding, which keeps them one
+        // contiguous pass.
         void Fill(const T& value) {
             if (IsAllocated()) {
-                std::fill(Begin(), End(), value);
+                ParallelFill(ptr_raw_data_, StorageSize(), value);
             }
         }
 
         void Zero() {
             if (IsAllocated()) {
-                std::fill(Begin(), End(), static_cast<T>(0));
+                ParallelFill(ptr_raw_data_, StorageSize(), static_cast<T>(0));
             }
         }
 
         void Ones() {
             if (IsAllocated()) {
-                std::fill(Begin(), End(), static_cast<T>(1));
+                ParallelFill(ptr_raw_data_, StorageSize(), static_cast<T>(1));
             }
         }
 
+        // Exchanges the storage, padding included, of two arrays of the same shape.
         void Swap(ArrayBase& other) {
             if (!HasSameShape(other)) {
                 throw std::invalid_argument("Swap: shape mismatch.");
             }
             std::swap(ptr_raw_data_, other.ptr_raw_data_);
+            std::swap(capacity_, other.capacity_);
+            std::swap(padding_, other.padding_);
+            std::swap(pitch_, other.pitch_);
+            std::swap(allocator_, other.allocator_);
         }
 
-        void Copy(const ArrayBase& other) {
-            if (!HasSameShape(other)) {
+        // Copies the elements of an array of the same shape, possibly of another
+        // allocator (e.g. a MappedArray into memory); each array keeps its own
+        // padding.
+        template <typename OtherAllocator>
+        void Copy(const ArrayBase<T, OtherAllocator, Layout>& other) {
+            if (shape_ != other.Shape()) {
                 throw std::invalid_argument("Copy: shape mismatch");
             }
-            std::copy(other.Begin(), other.End(), Begin());
+            if (pitch_ == other.Pitch()) {
+                ParallelCopy(other.Data(), StorageSize(), ptr_raw_data_);
+                return;
+            }
+            const std::size_t length = RowLength();
+            const T* src = other.Data();
+            T* dst = ptr_raw_data_;
+            const std::size_t src_pitch = other.Pitch();
+            const std::size_t dst_pitch = pitch_;
+            ParallelForStatic(size_, PageElements<T>(), [=](const std::size_t begin, const std::size_t end) {
+                for (std::size_t row = begin / length; row < (end + length - 1) / length; ++row) {
+                    const std::size_t j0 = row * length < begin ? begin - row * length : 0;
+                    const std::size_t j1 = std::min(length, end - row * length);
+                    std::copy(src + row * src_pitch + j0, src + row * src_pitch + j1, dst + row * dst_pitch + j0);
+                }
+            });
+        }
+
+        // #######################
+        // Compound assignment
+        // #######################
+        template <typename E>
+        ArrayBase& operator+=(const Expression<E>& expression) {
+            ApplyExpression(CheckExpressionShape(expression), [](T& x, const auto y) { x += y; });
+            return *this;
+        }
+
+        template <typename E>
+        ArrayBase& operator-=(const Expression<E>& expression) {
+            ApplyExpression(CheckExpressionShape(expression), [](T& x, const auto y) { x -= y; });
+            return *this;
+        }
+
+        template <typename E>
+        ArrayBase& operator*=(const Expression<E>& expression) {
+            ApplyExpression(CheckExpressionShape(expression), [](T& x, const auto y) { x *= y; });
+            return *this;
+        }
+
+        template <typename E>
+        ArrayBase& operator/=(const Expression<E>& expression) {
+            ApplyExpression(CheckExpressionShape(expression), [](T& x, const auto y) { x /= y; });
+            return *this;
+        }
+
+        ArrayBase& operator+=(const ArrayBase& other) {
+            ApplyArray(other, [](T& x, const T y) { x += y; });
+            return *this;
+        }
+
+        ArrayBase& operator+=(const T& value) {
+            ApplyScalar([value](T& x) { x += value; });
+            return *this;
+        }
+
+        ArrayBase& operator-=(const ArrayBase& other) {
+            ApplyArray(other, [](T& x, const T y) { x -= y; });
+            return *this;
+        }
+
+        ArrayBase& operator-=(const T& value) {
+            ApplyScalar([value](T& x) { x -= value; });
+            return *this;
+        }
+
+        ArrayBase& operator*=(const ArrayBase& other) {
+            ApplyArray(other, [](T& x, const T y) { x *= y; });
+            return *this;
+        }
+
+        ArrayBase& operator*=(const T& value) {
+            ApplyScalar([value](T& x) { x *= value; });
+            return *this;
         }
 
+        ArrayBase& operator/=(const ArrayBase& other) {
+            ApplyArray(other, [](T& x, const T y) { x /= y; });
+            return *this;
+        }
+
+        ArrayBase& operator/=(const T& value) {
+            ApplyScalar([value](T& x) { x /= value; });
+            return *this;
+        }
+
+        // Health checks. float/double data is tested on its bit pattern with SIMD
+        // in blocks, exiting at the first block that contains an offending value;
+        // arrays of kParallelThreshold elements or more are scanned by the
+        // ThreadPool::Global() threads.
         bool CheckNaN() const {
             static_assert(std::is_floating_point<T>::value, "CheckNaN requires floating point type");
-            if (IsEmpty()) return false;
-            for (std::size_t i = 0; i < size_; ++i) {
-                if (std::isnan(static_cast<double>(ptr_raw_data_[i]))) {
-                    return true;
-                }
-            }
-            return false;
+            return FindFirstInvalid<simd::CheckKind::NaN>() != StorageSize();
         }
 
         bool CheckFinite() const {
             static_assert(std::is_floating_point<T>::value, "CheckFinite requires floating point type");
-            if (IsEmpty()) return true;
-            for (std::size_t i = 0; i < size_; ++i) {
-                if (!std::isfinite(static_cast<double>(ptr_raw_data_[i]))) {
-                    return false;
+            return FindFirstInvalid<simd::CheckKind::NonFinite>() == StorageSize();
+        }
+
+        // Index of the first NaN in storage order. Returns false if there is none.
+        bool FindFirstNaN(ArrayIndex& index) const {
+            static_assert(std::is_floating_point<T>::value, "FindFirstNaN requires floating point type");
+            const std::size_t offset = FindFirstInvalid<simd::CheckKind::NaN>();
+            if (offset == StorageSize()) return false;
+            index = UnravelIndex(offset);
+            return true;
+        }
+
+        // Index of the first NaN or infinity in storage order. Returns false if there is none.
+        bool FindFirstNonFinite(ArrayIndex& index) const {
+            static_assert(std::is_floating_point<T>::value, "FindFirstNonFinite requires floating point type");
+            const std::size_t offset = FindFirstInvalid<simd::CheckKind::NonFinite>();
+            if (offset == StorageSize()) return false;
+            index = UnravelIndex(offset);
+            return true;
+        }
+
+        // Multi-dimensional index of the element at flat `offset` into Data().
+        ArrayIndex UnravelIndex(std::size_t offset) const {
+            ArrayIndex index(shape_);
+            if (shape_.empty()) return index;
+            const std::size_t inner = Layout::kIsColumnMajor ? 0 : shape_.size() - 1;
+            index[inner] = offset % pitch_;
+            offset /= pitch_;
+            if constexpr (Layout::kIsColumnMajor) {
+                for (std::size_t axis = 1; axis < shape_.size(); ++axis) {
+                    index[axis] = offset % shape_[axis];
+                    offset /= shape_[axis];
+                }
+            } else {
+                for (std::size_t axis = inner; axis-- > 0;) {
+                    index[axis] = offset % shape_[axis];
+                    offset /= shape_[axis];
                 }
             }
-            return true;
+            return index;
+        }
+
+        // Contiguous 1-D view of all elements in storage order that aliases this
+        // array's storage (no copy). The view is invalidated when the array is resized, moved
+        // from or destroyed. Padded arrays have none (std::logic_error); use RowView.
+        inline ArrayView<T, 1> FlatView() {
+            CheckContiguous("FlatView");
+            return ArrayView<T, 1>(ptr_raw_data_, {size_});
+        }
+
+        inline ArrayView<const T, 1> FlatView() const {
+            CheckContiguous("FlatView");
+            return ArrayView<const T, 1>(ptr_raw_data_, {size_});
+        }
+
+        // NumRows() x RowLength() view of the rows along the innermost axis in
+        // storage order, with row stride Pitch(); valid for padded arrays too.
+        inline ArrayView<T, 2> RowView() noexcept {
+            return ArrayView<T, 2>(ptr_raw_data_, {NumRows(), RowLength()}, {pitch_, 1});
         }
 
-        Array1D<T> Flatten() const {
-            Array1D<T> flat(size_);
+        inline ArrayView<const T, 2> RowView() const noexcept {
+            return ArrayView<const T, 2>(ptr_raw_data_, {NumRows(), RowLength()}, {pitch_, 1});
+        }
+
+        Array1D<T, Allocator> Flatten() const {
+            Array1D<T, Allocator> flat(size_);
             if (IsAllocated()) {
-                std::copy(Begin(), End(), flat.Begin());
+                CopyRowsTo(flat.Begin());
             }
             return flat;
         }
 
-        void FlattenInto(Array1D<T>& out_flat) const {
+        void FlattenInto(Array1D<T, Allocator>& out_flat) const {
             out_flat.Resize(size_);
             if (IsAllocated()) {
-                std::copy(Begin(), End(), out_flat.Begin());
+                CopyRowsTo(out_flat.Begin());
             }
         }
 
     protected:
-        std::vector<std::size_t> shape_;
+        ArrayShape shape_;
         std::size_t size_;
+        std::size_t capacity_;
+        Padding padding_;
+        std::size_t pitch_;
         T* ptr_raw_data_;
         ArrayStatus status_;
+        Allocator allocator_;
 
         void AllocateArray() {
             if (IsEmpty() && size_ > 0) {
-                ptr_raw_data_ = new T[size_];
+                capacity_ = StorageSize();
+                ptr_raw_data_ = AllocateStorage(capacity_);
                 status_ = ArrayStatus::Allocated;
+                ClearPadding();
             }
         }
 
         void DeleteArray() {
             if (IsAllocated()) {
-                delete[] ptr_raw_data_;
+                DeallocateStorage(ptr_raw_data_, capacity_);
                 ptr_raw_data_ = nullptr;
                 std::fill(shape_.begin(), shape_.end(), 0);
                 size_ = 0;
+                capacity_ = 0;
+                pitch_ = 0;
                 status_ = ArrayStatus::Empty;
             }
         }
 
-        std::size_t ComputeSize(const std::vector<std::size_t>& shape) const {
+        T* AllocateStorage(const std::size_t n) {
+            T* ptr = std::allocator_traits<Allocator>::allocate(allocator_, n);
+            try {
+                std::uninitialized_default_construct_n(ptr, n);
+            } catch (...) {
+                std::allocator_traits<Allocator>::deallocate(allocator_, ptr, n);
+                throw;
+            }
+            return ptr;
+        }
+
+        void DeallocateStorage(T* ptr, const std::size_t n) noexcept {
+            std::destroy_n(ptr, n);
+            std::allocator_traits<Allocator>::deallocate(allocator_, ptr, n);
+        }
+
+        // Moves the first StorageSize() elements into a new allocation of n elements.
+        void Reallocate(const std::size_t n) {
+            T* ptr = AllocateStorage(n);
+            if (IsAllocated()) {
+                std::move(ptr_raw_data_, ptr_raw_data_ + StorageSize(), ptr);
+                DeallocateStorage(ptr_raw_data_, capacity_);
+            }
+            ptr_raw_data_ = ptr;
+            capacity_ = n;
+            status_ = ArrayStatus::Allocated;
+        }
+
+        // Evaluates `expression` into this array in a single pass. An empty array
+        // or one of a different shape but the same rank is resized first.
+        template <typename E>
+        void AssignExpression(const Expression<E>& expression) {
+            static_assert(IsLayoutCompatible<typename E::layout_type>::value, "Assign: expression has a different memory layout");
+            const E& expr = expression.Self();
+            if (expr.Shape().size() != NumDimensions()) {
+                throw std::invalid_argument("Assign: dimension mismatch");
+            }
+            if (shape_ != expr.Shape()) {
+                Resize(expr.Shape());
+            }
+            ApplyExpression(expr, [](T& x, const auto y) { x = static_cast<T>(y); });
+        }
+
+        // op(element, value) over all elements and the matching values of
+        // expr: a single flat loop when neither side is padded, row by row
+        // (expr(row, j)) otherwise.
+        template <typename E, typename Op>
+        void ApplyExpression(const E& expr, Op op) {
+            T* ptr = ptr_raw_data_;
+            if (IsContiguous() && expr.IsContiguous()) {
+                for (std::size_t i = 0; i < size_; ++i) {
+                    op(ptr[i], expr[i]);
+                }
+                return;
+            }
+            const std::size_t length = RowLength();
+            const std::size_t rows = NumRows();
+            for (std::size_t row = 0; row < rows; ++row) {
+                T* dst = ptr + row * pitch_;
+                for (std::size_t j = 0; j < length; ++j) {
+                    op(dst[j], expr(row, j));
+                }
+            }
+        }
+
+        template <typename Op>
+        void ApplyArray(const ArrayBase& other, Op op) {
+            if (!HasSameShape(other)) {
+                throw std::invalid_argument("Compound assignment: shape mismatch");
+            }
+            T* ptr = ptr_raw_data_;
+            const T* src = other.ptr_raw_data_;
+            if (IsContiguous() && other.IsContiguous()) {
+                for (std::size_t i = 0; i < size_; ++i) {
+                    op(ptr[i], src[i]);
+                }
+                return;
+            }
+            const std::size_t length = RowLength();
+            const std::size_t rows = NumRows();
+            for (std::size_t row = 0; row < rows; ++row) {
+                T* dst = ptr + row * pitch_;
+                const T* in = src + row * other.pitch_;
+                for (std::size_t j = 0; j < length; ++j) {
+                    op(dst[j], in[j]);
+                }
+            }
+        }
+
+        template <typename Op>
+        void ApplyScalar(Op op) {
+            T* ptr = ptr_raw_data_;
+            if (IsContiguous()) {
+                for (std::size_t i = 0; i < size_; ++i) {
+                    op(ptr[i]);
+                }
+                return;
+            }
+            const std::size_t length = RowLength();
+            const std::size_t rows = NumRows();
+            for (std::size_t row = 0; row < rows; ++row) {
+                T* dst = ptr + row * pitch_;
+                for (std::size_t j = 0; j < length; ++j) {
+                    op(dst[j]);
+                }
+            }
+        }
+
+        // Copies the elements in storage order, without padding, to out.
+        void CopyRowsTo(T* out) const {
+            if (IsContiguous()) {
+                std::copy(ptr_raw_data_, ptr_raw_data_ + size_, out);
+                return;
+            }
+            const std::size_t length = RowLength();
+            for (std::size_t row = 0; row < NumRows(); ++row) {
+                const T* src = ptr_raw_data_ + row * pitch_;
+                std::copy(src, src + length, out + row * length);
+            }
+        }
+
+        void CheckContiguous(const char* operation) const {
+            if (!IsContiguous()) {
+                throw std::logic_error(std::string(operation) + ": array has padded rows");
+            }
+        }
+
+        // Pitch of an array of `shape` under padding_; arrays of rank 1 are one row.
+        std::size_t ComputePitch(const ArrayShape& shape) const noexcept {
+            if (shape.empty()) return 0;
+            const std::size_t length = shape[Layout::kIsColumnMajor ? 0 : shape.size() - 1];
+            return shape.size() < 2 ? length : padding_.template PitchFor<T>(length);
+        }
+
+        // Zeroes the padding at the end of every row, so that it never holds
+        // uninitialized values.
+        void ClearPadding() {
+            if (IsAllocated() && !IsContiguous()) {
+                const std::size_t length = RowLength();
+                for (std::size_t row = 0; row < NumRows(); ++row) {
+                    std::fill(ptr_raw_data_ + row * pitch_ + length, ptr_raw_data_ + (row + 1) * pitch_, T());
+                }
+            }
+        }
+
+        // Changes the padding policy, moving the elements to the new pitch if it
+        // differs. Exposed by the array types whose indexing honours Pitch().
+        void SetPadding(const Padding padding) {
+            padding_ = padding;
+            const std::size_t pitch = ComputePitch(shape_);
+            if (pitch == pitch_) return;
+            if (!IsAllocated()) {
+                pitch_ = pitch;
+                return;
+            }
+            const std::size_t length = RowLength();
+            const std::size_t rows = NumRows();
+            T* ptr = AllocateStorage(rows * pitch);
+            for (std::size_t row = 0; row < rows; ++row) {
+                std::move(ptr_raw_data_ + row * pitch_, ptr_raw_data_ + row * pitch_ + length, ptr + row * pitch);
+            }
+            DeallocateStorage(ptr_raw_data_, capacity_);
+            ptr_raw_data_ = ptr;
+            capacity_ = rows * pitch;
+            pitch_ = pitch;
+            ClearPadding();
+        }
+
+        template <typename E>
+        const E& CheckExpressionShape(const Expression<E>& expression) const {
+            static_assert(IsLayoutCompatible<typename E::layout_type>::value, "Compound assignment: expression has a different memory layout");
+            const E& expr = expression.Self();
+            if (shape_ != expr.Shape()) {
+                throw std::invalid_argument("Compound assignment: shape mismatch");
+            }
+            return expr;
+        }
+
+        // Expressions of arrays carry their layout; scalar-only expressions have none (void).
+        template <typename L>
+        struct IsLayoutCompatible : std::integral_constant<bool, std::is_void<L>::value || std::is_same<L, Layout>::value> { };
+
+        static inline T* AssumeAligned(T* ptr) noexcept {
+        #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<T*>(__builtin_assume_aligned(ptr, kAlignment));
+        #else
+            return ptr;
+        #endif
+        }
+
+        static inline const T* AssumeAligned(const T* ptr) noexcept {
+        #if defined(__GNUC__) || defined(__clang__)
+            return static_cast<const T*>(__builtin_assume_aligned(ptr, kAlignment));
+        #else
+            return ptr;
+        #endif
+        }
+
+        // Flat offset of the first offending element, or StorageSize() if there
+        // is none. Padded arrays are scanned row by row on the calling thread.
+        template <simd::CheckKind Kind>
+        std::size_t FindFirstInvalid() const {
+            if (IsEmpty()) return StorageSize();
+            const T* ptr = ptr_raw_data_;
+            if (!IsContiguous()) {
+                const std::size_t length = RowLength();
+                for (std::size_t row = 0; row < NumRows(); ++row) {
+                    const T* src = ptr + row * pitch_;
+                    std::size_t hit = length;
+                    if constexpr (simd::IsSimdFloat<T>::value) {
+                        hit = simd::FindFirstNonFinite<Kind>(src, length);
+                    } else {
+                        for (std::size_t j = 0; j < length && hit == length; ++j) {
+                            if (Kind == simd::CheckKind::NaN ? std::isnan(src[j]) : !std::isfinite(src[j])) hit = j;
+                        }
+                    }
+                    if (hit != length) return row * pitch_ + hit;
+                }
+                return StorageSize();
+            }
+            if constexpr (!simd::IsSimdFloat<T>::value) {
+                for (std::size_t i = 0; i < size_; ++i) {
+                    if (Kind == simd::CheckKind::NaN ? std::isnan(ptr[i]) : !std::isfinite(ptr[i])) return i;
+                }
+                return size_;
+            } else {
+                ThreadPool& pool = ThreadPool::Global();
+                if (size_ < kParallelThreshold || pool.NumThreads() == 1) {
+                    return simd::FindFirstNonFinite<Kind>(ptr, size_);
+                }
+                // Blocks are handed out in increasing order, so a thread can stop
+                // as soon as its next block starts past the best hit found so far.
+                constexpr std::size_t kBlock = std::size_t(1) << 16;
+                const std::size_t num_blocks = (size_ + kBlock - 1) / kBlock;
+                const std::size_t size = size_;
+                std::atomic<std::size_t> next_block(0);
+                std::atomic<std::size_t> first(size);
+                pool.Run([&](std::size_t, std::size_t) {
+                    for (;;) {
+                        const std::size_t block = next_block.fetch_add(1, std::memory_order_relaxed);
+                        const std::size_t begin = block * kBlock;
+                        if (block >= num_blocks || begin >= first.load(std::memory_order_relaxed)) return;
+                        const std::size_t n = std::min(kBlock, size - begin);
+                        const std::size_t hit = simd::FindFirstNonFinite<Kind>(ptr + begin, n);
+                        if (hit != n) {
+                            std::size_t current = first.load(std::memory_order_relaxed);
+                            while (begin + hit < current && !first.compare_exchange_weak(current, begin + hit, std::memory_order_relaxed)) { }
+                            return;
+                        }
+                    }
+                });
+                return first.load();
+            }
+        }
+
+        std::size_t ComputeSize(const ArrayShape& shape) const {
             if (shape.empty()) return 0;
             std::size_t size = 1;
             for (std::size_t dim : shape) {
@@ -227,30 +737,54 @@ namespace array {
             return size;
         }
 
-        void Resize(const std::vector<std::size_t>& shape) {
+        // Changes the shape, keeping the padding policy. The existing allocation is
+        // reused whenever it is large enough; element values are unspecified
+        // after a shape change.
+        void Resize(const ArrayShape& shape) {
+            const std::size_t size = ComputeSize(shape);
+            const std::size_t pitch = ComputePitch(shape);
             if (IsEmpty()) {
                 shape_ = shape;
-                size_ = ComputeSize(shape_);
-                AllocateArray();
-            } else if (shape_ != shape) {
-                DeleteArray();
-                shape_ = shape;
-                size_ = ComputeSize(shape_);
+                size_ = size;
+                pitch_ = pitch;
                 AllocateArray();
+            } else if (shape_ != shape || pitch_ != pitch) {
+                const std::size_t length = shape.empty() ? 0 : shape[Layout::kIsColumnMajor ? 0 : shape.size() - 1];
+                const std::size_t storage = length == 0 ? 0 : size / length * pitch;
+                if (storage > capacity_) {
+                    DeleteArray();
+                    shape_ = shape;
+                    size_ = size;
+                    pitch_ = pitch;
+                    AllocateArray();
+                } else {
+                    shape_ = shape;
+                    size_ = size;
+                    pitch_ = pitch;
+                    ClearPadding();
+                }
             }
         }
 
-        void Reshape(const std::vector<std::size_t> &shape) {
+        // Padded arrays can only be reshaped without changing their rows.
+        void Reshape(const ArrayShape& shape) {
             if (IsEmpty()) {
                 shape_ = shape;
                 size_ = ComputeSize(shape_);
+                pitch_ = ComputePitch(shape_);
                 AllocateArray();
             } else {
                 std::size_t size = ComputeSize(shape);
                 if (size != size_) {
                     throw std::runtime_error("Reshape size mismatch");
                 }
+                const std::size_t pitch = ComputePitch(shape);
+                const std::size_t length = shape.empty() ? 0 : shape[Layout::kIsColumnMajor ? 0 : shape.size() - 1];
+                if ((!IsContiguous() || pitch != length) && (pitch != pitch_ || length != RowLength())) {
+                    throw std::runtime_error("Reshape: rows of a padded array cannot change length");
+                }
                 shape_ = shape;
+                pitch_ = pitch;
             }
         }
     };
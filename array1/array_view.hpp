@@ -0,0 +1,226 @@
+#ifndef ARRAY_VIEW_HPP_
+#define ARRAY_VIEW_HPP_
+
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "layout.hpp"
+
+namespace array {
+
+    // #######################
+    // ArrayView
+    // #######################
+    // Non-owning view of `Rank`-dimensional data with a per-dimension stride (in
+    // elements). Views never allocate; the viewed storage must outlive the view.
+    template <typename T, std::size_t Rank>
+    class ArrayView {
+        static_assert(Rank >= 1, "ArrayView: rank must be at least 1");
+
+    public:
+        using value_type = std::remove_const_t<T>;
+        using element_type = T;
+        using index_array = std::array<std::size_t, Rank>;
+
+        // #######################
+        // Constructors
+        // #######################
+        ArrayView() noexcept : ptr_data_(nullptr), shape_{}, strides_{} { }
+
+        // Contiguous row-major data.
+        ArrayView(T* data, const index_array& shape) noexcept
+        : ptr_data_(data), shape_(shape), strides_{} {
+            std::size_t stride = 1;
+            for (std::size_t axis = Rank; axis-- > 0;) {
+                strides_[axis] = stride;
+                stride *= shape_[axis];
+            }
+        }
+
+        ArrayView(T* data, const index_array& shape, const index_array& strides) noexcept
+        : ptr_data_(data), shape_(shape), strides_(strides) { }
+
+        // View of mutable data -> view of const data
+        template <typename U, std::enable_if_t<std::is_same<const U, T>::value && !std::is_same<U, T>::value, int> = 0>
+        ArrayView(const ArrayView<U, Rank>& other) noexcept
+        : ptr_data_(other.Data()), shape_(other.Shape()), strides_(other.Strides()) { }
+
+        static constexpr std::size_t NumDimensions() noexcept { return Rank; }
+
+        inline T* Data() const noexcept { return ptr_data_; }
+        inline const index_array& Shape() const noexcept { return shape_; }
+        inline const index_array& Strides() const noexcept { return strides_; }
+        inline std::size_t Dim(const std::size_t axis) const noexcept { return shape_[axis]; }
+        inline std::size_t Stride(const std::size_t axis) const noexcept { return strides_[axis]; }
+
+        inline std::size_t Size() const noexcept {
+            std::size_t size = 1;
+            for (std::size_t dim : shape_) {
+                size *= dim;
+            }
+            return size;
+        }
+
+        inline bool IsEmpty() const noexcept { return ptr_data_ == nullptr || Size() == 0; }
+
+        // True when the elements are laid out back to back in row-major order.
+        bool IsContiguous() const noexcept {
+            std::size_t stride = 1;
+            for (std::size_t axis = Rank; axis-- > 0;) {
+                if (shape_[axis] != 1 && strides_[axis] != stride) {
+                    return false;
+                }
+                stride *= shape_[axis];
+            }
+            return true;
+        }
+
+        template <typename... Indices>
+        inline T& operator()(const Indices... indices) const {
+            static_assert(sizeof...(Indices) == Rank, "ArrayView: wrong number of indices");
+            std::size_t axis = 0;
+            std::size_t offset = 0;
+            ((offset += static_cast<std::size_t>(indices) * strides_[axis++]), ...);
+            return ptr_data_[offset];
+        }
+
+        // #######################
+        // Sub-views
+        // #######################
+
+        // Elements [begin, end) of `axis`, taking every `step`-th one.
+        ArrayView Slice(const std::size_t axis, const std::size_t begin, const std::size_t end, const std::size_t step = 1) const {
+            if (axis >= Rank || begin > end || end > shape_[axis] || step == 0) {
+                throw std::out_of_range("ArrayView::Slice: invalid range");
+            }
+            ArrayView view(*this);
+            view.ptr_data_ = ptr_data_ + begin * strides_[axis];
+            view.shape_[axis] = (end - begin + step - 1) / step;
+            view.strides_[axis] = strides_[axis] * step;
+            return view;
+        }
+
+        // Box [begin, end) in every dimension.
+        ArrayView SubView(const index_array& begin, const index_array& end) const {
+            ArrayView view(*this);
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                view = view.Slice(axis, begin[axis], end[axis]);
+            }
+            return view;
+        }
+
+        // Same elements with the axes reordered (no copy): axis k of the result is
+        // axis axes[k] of this view, e.g. Permute({1, 0}) is the transpose.
+        ArrayView Permute(const index_array& axes) const {
+            ArrayView view(*this);
+            std::array<bool, Rank> used{};
+            for (std::size_t k = 0; k < Rank; ++k) {
+                if (axes[k] >= Rank || used[axes[k]]) {
+                    throw std::invalid_argument("ArrayView::Permute: axes must be a permutation");
+                }
+                used[axes[k]] = true;
+                view.shape_[k] = shape_[axes[k]];
+                view.strides_[k] = strides_[axes[k]];
+            }
+            return view;
+        }
+
+        // Hyperplane `index` of `axis` (e.g. a single k-plane of a 3-D array).
+        template <std::size_t R = Rank, std::enable_if_t<(R > 1), int> = 0>
+        ArrayView<T, Rank - 1> Plane(const std::size_t axis, const std::size_t index) const {
+            if (axis >= Rank || index >= shape_[axis]) {
+                throw std::out_of_range("ArrayView::Plane: invalid index");
+            }
+            std::array<std::size_t, Rank - 1> shape;
+            std::array<std::size_t, Rank - 1> strides;
+            for (std::size_t a = 0, b = 0; a < Rank; ++a) {
+                if (a == axis) continue;
+                shape[b] = shape_[a];
+                strides[b] = strides_[a];
+                ++b;
+            }
+            return ArrayView<T, Rank - 1>(ptr_data_ + index * strides_[axis], shape, strides);
+        }
+
+        // #######################
+        // Bulk operations
+        // #######################
+
+        // Calls f(row, n, stride) for every innermost row of the view.
+        template <typename F>
+        void ForEachRow(F&& f) const {
+            if (IsEmpty()) return;
+            ForEachRowImpl<0>(ptr_data_, f);
+        }
+
+        void Fill(const value_type& value) const {
+            ForEachRow([&value](T* row, const std::size_t n, const std::size_t stride) {
+                if (stride == 1) {
+                    std::fill(row, row + n, value);
+                } else {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        row[i * stride] = value;
+                    }
+                }
+            });
+        }
+
+        void CopyFrom(const ArrayView<const value_type, Rank>& other) const {
+            if (shape_ != other.Shape()) {
+                throw std::invalid_argument("ArrayView::CopyFrom: shape mismatch");
+            }
+            if (IsEmpty()) return;
+            CopyImpl<0>(ptr_data_, other.Data(), other.Strides());
+        }
+
+    private:
+        T* ptr_data_;
+        index_array shape_;
+        index_array strides_;
+
+        template <std::size_t Axis, typename F>
+        void ForEachRowImpl(T* ptr, F& f) const {
+            if constexpr (Axis + 1 == Rank) {
+                f(ptr, shape_[Axis], strides_[Axis]);
+            } else {
+                for (std::size_t i = 0; i < shape_[Axis]; ++i) {
+                    ForEachRowImpl<Axis + 1>(ptr + i * strides_[Axis], f);
+                }
+            }
+        }
+
+        template <std::size_t Axis>
+        void CopyImpl(T* dst, const value_type* src, const index_array& src_strides) const {
+            if constexpr (Axis + 1 == Rank) {
+                const std::size_t n = shape_[Axis];
+                const std::size_t ds = strides_[Axis];
+                const std::size_t ss = src_strides[Axis];
+                if (ds == 1 && ss == 1) {
+                    std::copy(src, src + n, dst);
+                } else {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        dst[i * ds] = src[i * ss];
+                    }
+                }
+            } else {
+                for (std::size_t i = 0; i < shape_[Axis]; ++i) {
+                    CopyImpl<Axis + 1>(dst + i * strides_[Axis], src + i * src_strides[Axis], src_strides);
+                }
+            }
+        }
+    };
+
+    // View of dense data stored in `Layout` order, e.g. a column-major buffer
+    // owned by Fortran code: MakeArrayView<ColumnMajor>(a, {m, n}).
+    template <typename Layout, typename T, std::size_t Rank>
+    inline ArrayView<T, Rank> MakeArrayView(T* data, const std::size_t (&shape)[Rank]) noexcept {
+        std::array<std::size_t, Rank> extents;
+        std::copy(shape, shape + Rank, extents.begin());
+        return ArrayView<T, Rank>(data, extents, LayoutStrides<Layout, Rank>(extents));
+    }
+}
+
+#endif /* ARRAY_VIEW_HPP_ */
@@ -0,0 +1,340 @@
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "allocator.hpp"
+#include "array_base.hpp"
+#include "chunked.hpp"
+#include "io.hpp"
+#include "npy.hpp"
+#include "parallel.hpp"
+#include "shape.hpp"
+
+namespace array {
+
+    namespace detail {
+
+        // Page-aligned buffers reused from one snapshot to the next, at most
+        // `limit` bytes in all. Acquire() blocks while the limit is reached
+        // until a buffer is released; a single request larger than the limit
+        // is served once no other buffer is in use.
+        class StagingPool {
+        public:
+            explicit StagingPool(const std::size_t limit) noexcept : limit_(limit), total_(0) { }
+
+            ~StagingPool() {
+                for (const Buffer& buffer : free_) Free(buffer);
+            }
+
+            StagingPool(const StagingPool&) = delete;
+            StagingPool& operator=(const StagingPool&) = delete;
+
+            inline std::size_t Limit() const noexcept { return limit_; }
+
+            void* Acquire(const std::size_t bytes) {
+                std::unique_lock<std::mutex> lock(mutex_);
+                for (;;) {
+                    // Smallest free buffer that fits.
+                    auto best = free_.end();
+                    for (auto it = free_.begin(); it != free_.end(); ++it) {
+                        if (it->bytes >= bytes && (best == free_.end() || it->bytes < best->bytes)) best = it;
+                    }
+                    if (best != free_.end()) {
+                        used_.push_back(*best);
+                        free_.erase(best);
+                        return used_.back().data;
+                    }
+                    // The free buffers are all too small: drop them to make room.
+                    while (!free_.empty() && total_ + bytes > limit_) {
+                        total_ -= free_.back().bytes;
+                        Free(free_.back());
+                        free_.pop_back();
+                    }
+                    if (total_ + bytes <= limit_ || used_.empty()) {
+                        const Buffer buffer = {::operator new(std::max<std::size_t>(bytes, 1), std::align_val_t(kPageSize)), bytes};
+                        total_ += bytes;
+                        used_.push_back(buffer);
+                        return buffer.data;
+                    }
+                    released_.wait(lock);
+                }
+            }
+
+            void Release(void* data) noexcept {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    const auto it = std::find_if(used_.begin(), used_.end(), [data](const Buffer& buffer) { return buffer.data == data; });
+                    free_.push_back(*it);
+                    used_.erase(it);
+                }
+                released_.notify_all();
+            }
+
+        private:
+            struct Buffer {
+                void* data;
+                std::size_t bytes;
+            };
+
+            const std::size_t limit_;
+            std::size_t total_;
+            std::vector<Buffer> free_;
+            std::vector<Buffer> used_;
+            std::mutex mutex_;
+            std::condition_variable released_;
+
+            static void Free(const Buffer& buffer) noexcept {
+                ::operator delete(buffer.data, std::align_val_t(kPageSize));
+            }
+        };
+    }
+
+    // #######################
+    // StagingAllocator
+    // #######################
+    // Allocator taking page-aligned buffers from a staging pool (see
+    // CheckpointWriter) and giving them back on deallocation. A
+    // default-constructed StagingAllocator, e.g. the one of a copy, is not
+    // bound to a pool and allocates like AlignedAllocator<T, kPageSize>.
+    template <typename T>
+    class StagingAllocator {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        template <typename U>
+        struct rebind {
+            using other = StagingAllocator<U>;
+        };
+
+        StagingAllocator() noexcept = default;
+
+        explicit StagingAllocator(std::shared_ptr<detail::StagingPool> pool) noexcept : pool_(std::move(pool)) { }
+
+        template <typename U>
+        StagingAllocator(const StagingAllocator<U>& other) noexcept : pool_(other.Pool()) { }
+
+        T* allocate(const std::size_t n) {
+            if (!pool_) {
+                return AlignedAllocator<T, kPageSize>().allocate(n);
+            }
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(pool_->Acquire(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, const std::size_t n) noexcept {
+            if (!pool_) {
+                AlignedAllocator<T, kPageSize>().deallocate(p, n);
+            } else {
+                pool_->Release(p);
+            }
+        }
+
+        inline const std::shared_ptr<detail::StagingPool>& Pool() const noexcept { return pool_; }
+
+    private:
+        std::shared_ptr<detail::StagingPool> pool_;
+    };
+
+    template <typename T, typename U>
+    inline bool operator==(const StagingAllocator<T>& lhs, const StagingAllocator<U>& rhs) noexcept {
+        return lhs.Pool() == rhs.Pool();
+    }
+
+    template <typename T, typename U>
+    inline bool operator!=(const StagingAllocator<T>& lhs, const StagingAllocator<U>& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    template <typename T>
+    struct AllocatorAlignment<StagingAllocator<T>> {
+        static constexpr std::size_t value = kPageSize;
+    };
+
+    namespace detail {
+
+        // Dense copy of an array in a staging buffer.
+        template <typename T, typename Layout>
+        class Snapshot final : public ArrayBase<T, StagingAllocator<T>, Layout> {
+            using Base = ArrayBase<T, StagingAllocator<T>, Layout>;
+
+        public:
+            template <typename Allocator>
+            Snapshot(std::shared_ptr<StagingPool> pool, const ArrayBase<T, Allocator, Layout>& a) {
+                this->allocator_ = StagingAllocator<T>(std::move(pool));
+                Base::Resize(a.Shape());
+                this->Copy(a);
+            }
+
+            std::size_t NumDimensions() const noexcept override { return this->shape_.size(); }
+        };
+
+        // Runs write(temporary path), then renames the temporary file to
+        // `path`, so that `path` always holds a complete file.
+        template <typename F>
+        void ReplaceFile(const std::string& path, F&& write) {
+            const std::string part = path + ".part";
+            try {
+                write(part);
+            } catch (...) {
+                std::remove(part.c_str());
+                throw;
+            }
+            if (std::rename(part.c_str(), path.c_str()) != 0) {
+                throw std::system_error(errno, std::generic_category(), "CheckpointWriter: cannot rename " + part + " to " + path);
+            }
+        }
+    }
+
+    // #######################
+    // CheckpointWriter
+    // #######################
+    // Writes arrays in the background: Save() copies the array into a staging
+    // buffer (a parallel memcpy on the calling thread), queues the write and
+    // returns at once with a future that becomes ready when the file is
+    // complete, or holds the exception the write threw.
+    //     CheckpointWriter writer(2 * u.Size() * sizeof(double));  // double buffering
+    //     for (int step = 0; ; ++step) {
+    //         Advance(u);
+    //         if (step % 100 == 0) writer.Save("u" + std::to_string(step) + ".bin", u);
+    //     }
+    //     writer.Wait();
+    // Writes run one at a time, in submission order, on a dedicated thread
+    // that does not use the thread pool (its transfers and compression run
+    // serially there), so the time loop keeps all the pool threads. Staging
+    // memory is bounded by `staging_bytes`: with room for two snapshots one
+    // is written while the next is taken, and a third Save() waits for the
+    // first write to finish. The buffers are kept and reused. Each file is
+    // written as <path>.part and renamed when complete.
+    // The destructor finishes the queued writes.
+    class CheckpointWriter {
+    public:
+        static constexpr std::size_t kDefaultStagingBytes = std::size_t(1) << 30;
+
+        explicit CheckpointWriter(const std::size_t staging_bytes = kDefaultStagingBytes)
+        : pool_(std::make_shared<detail::StagingPool>(staging_bytes)), busy_(false), stop_(false), thread_(&CheckpointWriter::Loop, this) { }
+
+        ~CheckpointWriter() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            queued_.notify_all();
+            thread_.join();
+        }
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        // Snapshots `a` and queues write(snapshot), the snapshot being a dense
+        // ArrayBase<T, StagingAllocator<T>, Layout> with the shape and
+        // elements of `a`. Blocks while the staging memory is exhausted.
+        template <typename T, typename Allocator, typename Layout, typename F>
+        std::future<void> Submit(const ArrayBase<T, Allocator, Layout>& a, F write) {
+            auto snapshot = std::make_unique<detail::Snapshot<T, Layout>>(pool_, a);
+            std::packaged_task<void()> task([snapshot = std::move(snapshot), write = std::move(write)]() mutable {
+                write(static_cast<const ArrayBase<T, StagingAllocator<T>, Layout>&>(*snapshot));
+                snapshot.reset();
+            });
+            std::future<void> done = task.get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queue_.push_back(std::move(task));
+            }
+            queued_.notify_all();
+            return done;
+        }
+
+        // array::Save in the background.
+        template <typename T, typename Allocator, typename Layout>
+        std::future<void> Save(const std::string& path, const ArrayBase<T, Allocator, Layout>& a, const IoMode mode = IoMode::Buffered) {
+            return Submit(a, [path, mode](const auto& snapshot) {
+                detail::ReplaceFile(path, [&](const std::string& part) { array::Save(part, snapshot, mode); });
+            });
+        }
+
+        // array::SaveNpy in the background.
+        template <typename T, typename Allocator, typename Layout>
+        std::future<void> SaveNpy(const std::string& path, const ArrayBase<T, Allocator, Layout>& a) {
+            return Submit(a, [path](const auto& snapshot) {
+                detail::ReplaceFile(path, [&](const std::string& part) { array::SaveNpy(part, snapshot); });
+            });
+        }
+
+        // array::SaveChunked in the background.
+        template <typename T, typename Allocator, typename Layout>
+        std::future<void> SaveChunked(const std::string& path, const ArrayBase<T, Allocator, Layout>& a, const ArrayShape& chunk,
+                                      const ChunkCodec codec = ChunkCodec::ShuffleLz) {
+            return Submit(a, [path, chunk, codec](const auto& snapshot) {
+                detail::ReplaceFile(path, [&](const std::string& part) { array::SaveChunked(part, snapshot, chunk, codec); });
+            });
+        }
+
+        // Blocks until every queued write has finished.
+        void Wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return queue_.empty() && !busy_; });
+        }
+
+        // Writes queued or in progress.
+        std::size_t Pending() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queue_.size() + (busy_ ? 1 : 0);
+        }
+
+        inline std::size_t StagingBytes() const noexcept { return pool_->Limit(); }
+
+    private:
+        std::shared_ptr<detail::StagingPool> pool_;
+        std::deque<std::packaged_task<void()>> queue_;
+        mutable std::mutex mutex_;
+        std::condition_variable queued_;
+        std::condition_variable idle_;
+        bool busy_;
+        bool stop_;
+        std::thread thread_;
+
+        void Loop() {
+            ThreadPool::SerialScope serial;
+            for (;;) {
+                std::packaged_task<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    queued_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                    if (queue_.empty()) return;
+                    task = std::move(queue_.front());
+                    queue_.pop_front();
+                    busy_ = true;
+                }
+                task();
+                task = std::packaged_task<void()>();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    busy_ = false;
+                }
+                idle_.notify_all();
+            }
+        }
+    };
+}
+
+#endif /* CHECKPOINT_HPP_ */
@@ -0,0 +1,482 @@
+#ifndef CHUNKED_HPP_
+#define CHUNKED_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "array_base.hpp"
+#include "codec.hpp"
+#include "io.hpp"
+#include "layout.hpp"
+#include "parallel.hpp"
+#include "shape.hpp"
+
+namespace array {
+
+    // #######################
+    // Chunked array files
+    // #######################
+    // The array is cut into a grid of fixed-shape chunks (smaller at the
+    // upper edges), each compressed on its own, so that a sub-region is read
+    // by fetching and decompressing only the chunks it intersects.
+    //     SaveChunked("t0100.chk", u, {64, 64, 64});
+    //     auto slab = ChunkedReader("t0100.chk").LoadRegion<Array3D<double>>({0, 0, 200}, {512, 512, 1});
+    // Layout (integers little endian):
+    //     0    "ARRAYCHK"
+    //     8    format version (uint16)
+    //     10   element kind, item size, byte order, layout, rank (as in Save)
+    //     15   codec (ChunkCodec)
+    //     16   extents, 6 x uint64
+    //     64   chunk extents, 6 x uint64
+    //     112  offset of the chunk index (uint64)
+    //     120  number of chunks (uint64)
+    //     128  compressed chunks, in completion order
+    // The index holds, for each chunk in the storage order of the layout, its
+    // file offset (uint64), its size (uint32) and the codec it was stored
+    // with (uint8, then 3 zero bytes); chunks that do not shrink are stored
+    // as is. Within a chunk the elements are in the storage order of the
+    // layout, without padding. Chunks are compressed and written by the
+    // thread pool threads and read back the same way.
+
+    enum class ChunkCodec : std::uint8_t {
+        None = 0,       // stored as is
+        Lz = 1,         // LzCompress
+        ShuffleLz = 2,  // ShuffleBytes, then LzCompress (the default)
+    };
+
+    struct ChunkedFileHeader {
+        ArrayFileHeader array;  // data_offset is unused
+        ArrayShape chunk;
+        ChunkCodec codec;
+        std::size_t num_chunks;
+    };
+
+    namespace detail {
+
+        constexpr char kChunkedMagic[8] = {'A', 'R', 'R', 'A', 'Y', 'C', 'H', 'K'};
+        constexpr std::uint16_t kChunkedVersion = 1;
+        constexpr std::size_t kChunkedHeaderBytes = 128;
+        constexpr std::size_t kChunkIndexEntryBytes = 16;
+
+        using Strides = std::array<std::size_t, ArrayShape::kMaxRank>;
+
+        struct ChunkEntry {
+            std::uint64_t offset;
+            std::uint32_t size;
+            ChunkCodec codec;
+        };
+
+        // Element strides of storage with the given extents whose rows (along
+        // the innermost axis of Layout) start `pitch` elements apart.
+        template <typename Layout>
+        Strides StorageStrides(const std::size_t* extents, const std::size_t rank, const std::size_t pitch) noexcept {
+            Strides strides{};
+            std::size_t stride = 1;
+            for (std::size_t k = 0; k < rank; ++k) {
+                const std::size_t axis = Layout::kIsColumnMajor ? k : rank - 1 - k;
+                strides[axis] = stride;
+                stride = k == 0 ? pitch : stride * extents[axis];
+            }
+            return strides;
+        }
+
+        // Copies the box of `extents` between two strided storages whose
+        // innermost axis `inner` has stride 1, one row at a time.
+        template <typename T>
+        void CopyBox(const T* src, const Strides& src_strides, T* dst, const Strides& dst_strides,
+                     const std::size_t* extents, const std::size_t rank, const std::size_t inner) {
+            std::array<std::size_t, ArrayShape::kMaxRank> index{};
+            for (std::size_t axis = 0; axis < rank; ++axis) {
+                if (extents[axis] == 0) return;
+            }
+            for (;;) {
+                std::size_t from = 0, to = 0;
+                for (std::size_t axis = 0; axis < rank; ++axis) {
+                    from += index[axis] * src_strides[axis];
+                    to += index[axis] * dst_strides[axis];
+                }
+                std::memcpy(dst + to, src + from, extents[inner] * sizeof(T));
+                std::size_t axis = 0;
+                for (; axis < rank; ++axis) {
+                    if (axis == inner) continue;
+                    if (++index[axis] < extents[axis]) break;
+                    index[axis] = 0;
+                }
+                if (axis == rank) return;
+            }
+        }
+
+        // Chunk grid of `shape` with chunks of `chunk` (0 meaning the whole
+        // extent): per axis chunk extent and number of chunks.
+        inline std::size_t ChunkGrid(const ArrayShape& shape, const ArrayShape& chunk, std::size_t* extents, std::size_t* counts) {
+            if (chunk.size() != shape.size()) {
+                throw std::invalid_argument("SaveChunked: chunk rank does not match the array");
+            }
+            std::size_t num_chunks = 1;
+            for (std::size_t axis = 0; axis < shape.size(); ++axis) {
+                extents[axis] = chunk[axis] == 0 || chunk[axis] > shape[axis] ? std::max<std::size_t>(shape[axis], 1) : chunk[axis];
+                counts[axis] = (shape[axis] + extents[axis] - 1) / extents[axis];
+                num_chunks *= counts[axis];
+            }
+            return num_chunks;
+        }
+
+        // Origin and extents of chunk number `index` (in the storage order of Layout).
+        template <typename Layout>
+        std::size_t ChunkBox(const ArrayShape& shape, const std::size_t* extents, const std::size_t* counts, std::size_t index,
+                             std::size_t* origin, std::size_t* box) {
+            const std::size_t rank = shape.size();
+            std::size_t size = 1;
+            for (std::size_t k = 0; k < rank; ++k) {
+                const std::size_t axis = Layout::kIsColumnMajor ? k : rank - 1 - k;
+                origin[axis] = index % counts[axis] * extents[axis];
+                index /= counts[axis];
+                box[axis] = std::min(extents[axis], shape[axis] - origin[axis]);
+                size *= box[axis];
+            }
+            return size;
+        }
+
+        // Runs f(next) on every pool thread (on the calling thread alone for
+        // arrays of less than kParallelThreshold elements); next() hands out
+        // the chunk numbers [0, n) one at a time, then returns n.
+        template <typename F>
+        void ForEachChunk(const std::size_t n, const std::size_t elements, F&& f) {
+            std::atomic<std::size_t> counter(0);
+            auto next = [&] { return std::min(counter.fetch_add(1, std::memory_order_relaxed), n); };
+            ThreadPool& pool = ThreadPool::Global();
+            if (n <= 1 || elements < kParallelThreshold || pool.NumThreads() == 1) {
+                f(next);
+                return;
+            }
+            pool.Run([&](std::size_t, std::size_t) { f(next); });
+        }
+
+        inline ChunkedFileHeader ReadChunkedHeader(const FileHandle& file, std::vector<ChunkEntry>& index) {
+            unsigned char bytes[kChunkedHeaderBytes];
+            iovec iov = {bytes, sizeof(bytes)};
+            file.Transfer(&iov, 1, 0, false);
+            if (std::memcmp(bytes, kChunkedMagic, sizeof(kChunkedMagic)) != 0) {
+                throw std::runtime_error("ChunkedReader: " + file.Path() + " is not a chunked array file");
+            }
+            if (GetLE(bytes + 8, 2) != kChunkedVersion) {
+                throw std::runtime_error("ChunkedReader: unsupported chunked file version in " + file.Path());
+            }
+            ChunkedFileHeader header;
+            header.array.kind = static_cast<char>(bytes[10]);
+            header.array.item_size = bytes[11];
+            header.array.little_endian = bytes[12] == '<';
+            header.array.column_major = bytes[13] == 'F';
+            header.array.data_offset = 0;
+            const std::size_t rank = bytes[14];
+            header.codec = static_cast<ChunkCodec>(bytes[15]);
+            if (rank == 0 || rank > ArrayShape::kMaxRank || bytes[15] > static_cast<unsigned char>(ChunkCodec::ShuffleLz)) {
+                throw std::runtime_error("ChunkedReader: invalid header in " + file.Path());
+            }
+            std::size_t dims[ArrayShape::kMaxRank], chunk[ArrayShape::kMaxRank];
+            for (std::size_t axis = 0; axis < rank; ++axis) {
+                dims[axis] = static_cast<std::size_t>(GetLE(bytes + 16 + 8 * axis, 8));
+                chunk[axis] = static_cast<std::size_t>(GetLE(bytes + 64 + 8 * axis, 8));
+            }
+            header.array.shape = ArrayShape(dims, dims + rank);
+            header.chunk = ArrayShape(chunk, chunk + rank);
+            header.num_chunks = static_cast<std::size_t>(GetLE(bytes + 120, 8));
+
+            std::size_t extents[ArrayShape::kMaxRank], counts[ArrayShape::kMaxRank];
+            if (ChunkGrid(header.array.shape, header.chunk, extents, counts) != header.num_chunks) {
+                throw std::runtime_error("ChunkedReader: invalid header in " + file.Path());
+            }
+
+            struct stat st;
+            if (::fstat(file.Descriptor(), &st) != 0) file.Fail("ChunkedReader: cannot stat");
+            const std::uint64_t file_size = static_cast<std::uint64_t>(st.st_size);
+            const std::uint64_t index_offset = GetLE(bytes + 112, 8);
+            if (index_offset > file_size || (file_size - index_offset) / kChunkIndexEntryBytes < header.num_chunks) {
+                throw std::runtime_error("ChunkedReader: " + file.Path() + " is truncated");
+            }
+            std::vector<unsigned char> entries(header.num_chunks * kChunkIndexEntryBytes);
+            iov = {entries.data(), entries.size()};
+            if (!entries.empty()) file.Transfer(&iov, 1, static_cast<off_t>(index_offset), false);
+            index.resize(header.num_chunks);
+            for (std::size_t c = 0; c < header.num_chunks; ++c) {
+                const unsigned char* entry = &entries[c * kChunkIndexEntryBytes];
+                ChunkEntry& e = index[c];
+                e.offset = GetLE(entry, 8);
+                e.size = static_cast<std::uint32_t>(GetLE(entry + 8, 4));
+                e.codec = static_cast<ChunkCodec>(entry[12]);
+                if (e.offset > file_size || e.size > file_size - e.offset || entry[12] > static_cast<unsigned char>(ChunkCodec::ShuffleLz)) {
+                    throw std::runtime_error("ChunkedReader: corrupt chunk index in " + file.Path());
+                }
+            }
+            return header;
+        }
+    }
+
+    // Writes `a` to `path` (replaced if it exists) as a chunked file with
+    // chunks of `chunk` elements per axis (0 for the whole extent). Chunks of
+    // a few hundred KiB to a few MiB balance the compression ratio, the
+    // parallelism and the granularity of sub-region reads, e.g. 64^3 doubles
+    // (2 MiB) for an Array3D<double>.
+    template <typename T, typename Allocator, typename Layout>
+    void SaveChunked(const std::string& path, const ArrayBase<T, Allocator, Layout>& a, const ArrayShape& chunk,
+                     const ChunkCodec codec = ChunkCodec::ShuffleLz) {
+        using namespace detail;
+        const ArrayShape shape = a.Shape();
+        const std::size_t rank = shape.size();
+        std::size_t extents[ArrayShape::kMaxRank], counts[ArrayShape::kMaxRank];
+        const std::size_t num_chunks = ChunkGrid(shape, chunk, extents, counts);
+        std::size_t chunk_size = 1;
+        for (std::size_t axis = 0; axis < rank; ++axis) chunk_size *= extents[axis];
+        if (num_chunks != 0 && std::max(chunk_size * sizeof(T), LzCompressBound(chunk_size * sizeof(T))) > std::numeric_limits<std::uint32_t>::max()) {
+            throw std::invalid_argument("SaveChunked: chunks must be smaller than 4 GiB");
+        }
+
+        const FileHandle file(path, O_WRONLY | O_CREAT | O_TRUNC);
+        if (!file.IsOpen()) file.Fail("SaveChunked: cannot open");
+        const std::size_t inner = Layout::kIsColumnMajor ? 0 : rank - 1;
+        const Strides array_strides = StorageStrides<Layout>(shape.data(), rank, a.Pitch());
+        std::vector<ChunkEntry> index(num_chunks);
+        std::atomic<std::uint64_t> end(kChunkedHeaderBytes);
+
+        ForEachChunk(num_chunks, a.Size(), [&](auto& next) {
+            std::vector<T> raw(chunk_size);
+            std::vector<unsigned char> shuffled(codec == ChunkCodec::ShuffleLz ? chunk_size * sizeof(T) : 0);
+            std::vector<unsigned char> packed(codec == ChunkCodec::None ? 0 : LzCompressBound(chunk_size * sizeof(T)));
+            std::size_t origin[ArrayShape::kMaxRank], box[ArrayShape::kMaxRank];
+            for (std::size_t c; (c = next()) < num_chunks;) {
+                const std::size_t size = ChunkBox<Layout>(shape, extents, counts, c, origin, box);
+                std::size_t from = 0;
+                for (std::size_t axis = 0; axis < rank; ++axis) from += origin[axis] * array_strides[axis];
+                CopyBox(a.Data() + from, array_strides, raw.data(), StorageStrides<Layout>(box, rank, box[inner]), box, rank, inner);
+
+                const std::size_t bytes = size * sizeof(T);
+                const unsigned char* data = reinterpret_cast<const unsigned char*>(raw.data());
+                ChunkEntry& entry = index[c];
+                entry.codec = ChunkCodec::None;
+                entry.size = static_cast<std::uint32_t>(bytes);
+                if (codec != ChunkCodec::None) {
+                    if (codec == ChunkCodec::ShuffleLz) {
+                        ShuffleBytes(data, size, sizeof(T), shuffled.data());
+                    }
+                    const std::size_t packed_size = LzCompress(codec == ChunkCodec::ShuffleLz ? shuffled.data() : data, bytes, packed.data());
+                    if (packed_size < bytes) {
+                        entry.codec = codec;
+                        entry.size = static_cast<std::uint32_t>(packed_size);
+                        data = packed.data();
+                    }
+                }
+                entry.offset = end.fetch_add(entry.size, std::memory_order_relaxed);
+                iovec iov = {const_cast<unsigned char*>(data), entry.size};
+                file.Transfer(&iov, 1, static_cast<off_t>(entry.offset), true);
+            }
+        });
+
+        const std::uint64_t index_offset = end.load();
+        std::vector<unsigned char> entries(num_chunks * kChunkIndexEntryBytes, 0);
+        for (std::size_t c = 0; c < num_chunks; ++c) {
+            unsigned char* entry = &entries[c * kChunkIndexEntryBytes];
+            PutLE(entry, index[c].offset, 8);
+            PutLE(entry + 8, index[c].size, 4);
+            entry[12] = static_cast<unsigned char>(index[c].codec);
+        }
+        iovec iov = {entries.data(), entries.size()};
+        if (!entries.empty()) file.Transfer(&iov, 1, static_cast<off_t>(index_offset), true);
+
+        unsigned char header[kChunkedHeaderBytes] = {};
+        std::memcpy(header, kChunkedMagic, sizeof(kChunkedMagic));
+        PutLE(header + 8, kChunkedVersion, 2);
+        header[10] = static_cast<unsigned char>(DType<T>::kind);
+        header[11] = static_cast<unsigned char>(sizeof(T));
+        header[12] = NativeLittleEndian() ? '<' : '>';
+        header[13] = Layout::kIsColumnMajor ? 'F' : 'C';
+        header[14] = static_cast<unsigned char>(rank);
+        header[15] = static_cast<unsigned char>(codec);
+        for (std::size_t axis = 0; axis < rank; ++axis) {
+            PutLE(header + 16 + 8 * axis, shape[axis], 8);
+            PutLE(header + 64 + 8 * axis, extents[axis], 8);
+        }
+        PutLE(header + 112, index_offset, 8);
+        PutLE(header + 120, num_chunks, 8);
+        iov = {header, sizeof(header)};
+        file.Transfer(&iov, 1, 0, true);
+    }
+
+    // #######################
+    // ChunkedReader
+    // #######################
+    // Opens a chunked file and reads all of it or any box of it; only the
+    // chunks that intersect the box are read, decompressed in parallel.
+    //     ChunkedReader file("t0100.chk");
+    //     Array3D<double> plane;
+    //     file.LoadRegion({0, 0, 200}, {512, 512, 1}, plane);  // one layer of chunks
+    class ChunkedReader {
+    public:
+        explicit ChunkedReader(const std::string& path) : file_(std::make_unique<detail::FileHandle>(path, O_RDONLY)) {
+            if (!file_->IsOpen()) file_->Fail("ChunkedReader: cannot open");
+            header_ = detail::ReadChunkedHeader(*file_, index_);
+        }
+
+        inline const std::string& Path() const noexcept { return file_->Path(); }
+        inline const ChunkedFileHeader& Header() const noexcept { return header_; }
+        inline const ArrayShape& Shape() const noexcept { return header_.array.shape; }
+
+        // Total size of the compressed chunks, in bytes.
+        std::uint64_t StoredBytes() const noexcept {
+            std::uint64_t bytes = 0;
+            for (const detail::ChunkEntry& entry : index_) bytes += entry.size;
+            return bytes;
+        }
+
+        template <typename A>
+        void Load(A& a) const {
+            ArrayShape first = Shape();
+            std::fill(first.begin(), first.end(), 0);
+            LoadRegion(first, Shape(), a);
+        }
+
+        template <typename A>
+        A Load() const {
+            A a;
+            Load(a);
+            return a;
+        }
+
+        // Reads the box of `count` elements per axis starting at `first` into
+        // `a`, resized to `count` if needed. The element type, rank and
+        // layout of A must match the file.
+        template <typename A>
+        void LoadRegion(const ArrayShape& first, const ArrayShape& count, A& a) const {
+            using T = typename A::value_type;
+            using Layout = typename A::layout_type;
+            using namespace detail;
+            const ArrayShape& shape = Shape();
+            const std::size_t rank = shape.size();
+            CheckHeader(Path(), header_.array, a);
+            if (first.size() != rank || count.size() != rank) {
+                throw std::invalid_argument("ChunkedReader::LoadRegion: region rank does not match the file");
+            }
+            for (std::size_t axis = 0; axis < rank; ++axis) {
+                if (first[axis] > shape[axis] || count[axis] > shape[axis] - first[axis]) {
+                    throw std::invalid_argument("ChunkedReader::LoadRegion: region out of bounds");
+                }
+            }
+            if (a.Shape() != count) {
+                ResizeTo(a, count);
+            }
+            if (a.Size() == 0) return;
+
+            // Intersecting chunks: a sub-grid of the chunk grid.
+            std::size_t extents[ArrayShape::kMaxRank], counts[ArrayShape::kMaxRank];
+            std::size_t low[ArrayShape::kMaxRank], span[ArrayShape::kMaxRank];
+            ChunkGrid(shape, header_.chunk, extents, counts);
+            std::size_t num_chunks = 1;
+            for (std::size_t axis = 0; axis < rank; ++axis) {
+                low[axis] = first[axis] / extents[axis];
+                span[axis] = (first[axis] + count[axis] - 1) / extents[axis] + 1 - low[axis];
+                num_chunks *= span[axis];
+            }
+
+            const std::size_t inner = Layout::kIsColumnMajor ? 0 : rank - 1;
+            const Strides array_strides = StorageStrides<Layout>(count.data(), rank, a.Pitch());
+            std::size_t chunk_size = 1;
+            for (std::size_t axis = 0; axis < rank; ++axis) chunk_size *= extents[axis];
+
+            ForEachChunk(num_chunks, a.Size(), [&](auto& next) {
+                std::vector<T> raw(chunk_size);
+                std::vector<unsigned char> packed, shuffled;
+                std::size_t origin[ArrayShape::kMaxRank], box[ArrayShape::kMaxRank], at[ArrayShape::kMaxRank];
+                for (std::size_t s; (s = next()) < num_chunks;) {
+                    // Chunk number in the whole grid.
+                    std::size_t c = 0;
+                    for (std::size_t k = 0, rest = s; k < rank; ++k) {
+                        const std::size_t axis = Layout::kIsColumnMajor ? k : rank - 1 - k;
+                        at[axis] = low[axis] + rest % span[axis];
+                        rest /= span[axis];
+                    }
+                    for (std::size_t k = 0; k < rank; ++k) {
+                        const std::size_t axis = Layout::kIsColumnMajor ? rank - 1 - k : k;
+                        c = c * counts[axis] + at[axis];
+                    }
+                    const std::size_t size = ChunkBox<Layout>(shape, extents, counts, c, origin, box);
+                    ReadChunk(index_[c], reinterpret_cast<unsigned char*>(raw.data()), size * sizeof(T), sizeof(T), packed, shuffled);
+                    if (header_.array.little_endian != NativeLittleEndian()) {
+                        SwapBytes(raw.data(), size, DType<T>::component);
+                    }
+
+                    // Intersection of the chunk with the region.
+                    std::size_t from = 0, to = 0, extent[ArrayShape::kMaxRank];
+                    const Strides chunk_strides = StorageStrides<Layout>(box, rank, box[inner]);
+                    for (std::size_t axis = 0; axis < rank; ++axis) {
+                        const std::size_t begin = std::max(origin[axis], first[axis]);
+                        const std::size_t end = std::min(origin[axis] + box[axis], first[axis] + count[axis]);
+                        extent[axis] = end - begin;
+                        from += (begin - origin[axis]) * chunk_strides[axis];
+                        to += (begin - first[axis]) * array_strides[axis];
+                    }
+                    CopyBox(static_cast<const T*>(raw.data()) + from, chunk_strides, a.Data() + to, array_strides, extent, rank, inner);
+                }
+            });
+        }
+
+        template <typename A>
+        A LoadRegion(const ArrayShape& first, const ArrayShape& count) const {
+            A a;
+            LoadRegion(first, count, a);
+            return a;
+        }
+
+    private:
+        std::unique_ptr<detail::FileHandle> file_;
+        ChunkedFileHeader header_;
+        std::vector<detail::ChunkEntry> index_;
+
+        // Reads and decodes one chunk of `bytes` bytes into `out`.
+        void ReadChunk(const detail::ChunkEntry& entry, unsigned char* out, const std::size_t bytes, const std::size_t item_size,
+                       std::vector<unsigned char>& packed, std::vector<unsigned char>& shuffled) const {
+            if (entry.codec == ChunkCodec::None) {
+                if (entry.size != bytes) {
+                    throw std::runtime_error("ChunkedReader: corrupt chunk in " + Path());
+                }
+                iovec iov = {out, bytes};
+                file_->Transfer(&iov, 1, static_cast<off_t>(entry.offset), false);
+                return;
+            }
+            packed.resize(entry.size);
+            iovec iov = {packed.data(), packed.size()};
+            file_->Transfer(&iov, 1, static_cast<off_t>(entry.offset), false);
+            if (entry.codec == ChunkCodec::Lz) {
+                LzDecompress(packed.data(), packed.size(), out, bytes);
+            } else {
+                shuffled.resize(bytes);
+                LzDecompress(packed.data(), packed.size(), shuffled.data(), bytes);
+                UnshuffleBytes(shuffled.data(), bytes / item_size, item_size, out);
+            }
+        }
+    };
+
+    template <typename A>
+    void LoadChunked(const std::string& path, A& a) {
+        ChunkedReader(path).Load(a);
+    }
+
+    template <typename A>
+    A LoadChunked(const std::string& path) {
+        return ChunkedReader(path).Load<A>();
+    }
+}
+
+#endif /* CHUNKED_HPP_ */
@@ -0,0 +1,262 @@
+#ifndef CODEC_HPP_
+#define CODEC_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace array {
+
+    // #######################
+    // LZ block codec
+    // #######################
+    // A byte-oriented LZ77 codec in the LZ4 block format: sequences of a token
+    // byte (literal count, match length - 4), literals and a 16-bit match
+    // offset, with a greedy single-probe hash search. It favours speed (on
+    // the order of GB/s in both directions) over ratio; paired with
+    // ShuffleBytes it compresses smooth floating-point fields whose high
+    // bytes (sign, exponent, leading mantissa) repeat from one element to the
+    // next.
+
+    constexpr std::size_t kLzMinMatch = 4;
+    // The last kLzLastLiterals bytes are always literals and the last match
+    // starts at least kLzMatchLimit bytes before the end (LZ4 block rules).
+    constexpr std::size_t kLzLastLiterals = 5;
+    constexpr std::size_t kLzMatchLimit = 12;
+    constexpr std::size_t kLzMaxOffset = 65535;
+    constexpr unsigned kLzHashLog = 14;
+    // LzDecompress copies literals and matches in blocks of up to this many
+    // bytes, past their end while that stays inside the output.
+    constexpr std::size_t kLzWildCopy = 16;
+
+    // Largest compressed size of n bytes.
+    constexpr std::size_t LzCompressBound(const std::size_t n) noexcept {
+        return n + n / 255 + 16;
+    }
+
+    namespace detail {
+
+        inline std::uint32_t Load32(const unsigned char* p) noexcept {
+            std::uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline std::uint64_t Load64(const unsigned char* p) noexcept {
+            std::uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline std::uint32_t LzHash(const std::uint32_t v) noexcept {
+            return (v * 2654435761u) >> (32 - kLzHashLog);
+        }
+
+        // Length of the common prefix of a and b, at most `limit` bytes.
+        inline std::size_t LzMatchLength(const unsigned char* a, const unsigned char* b, const std::size_t limit) noexcept {
+            std::size_t n = 0;
+            for (; n + 8 <= limit; n += 8) {
+                const std::uint64_t diff = Load64(a + n) ^ Load64(b + n);
+                if (diff != 0) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+                    return n + static_cast<std::size_t>(__builtin_ctzll(diff)) / 8;
+#else
+                    return n + static_cast<std::size_t>(__builtin_clzll(diff)) / 8;
+#endif
+                }
+            }
+            while (n < limit && a[n] == b[n]) ++n;
+            return n;
+        }
+
+        inline unsigned char* LzPutLength(unsigned char* op, std::size_t n) noexcept {
+            for (; n >= 255; n -= 255) *op++ = 255;
+            *op++ = static_cast<unsigned char>(n);
+            return op;
+        }
+
+        inline unsigned char* LzPutSequence(unsigned char* op, const unsigned char* literals, const std::size_t num_literals,
+                                            const std::size_t offset, const std::size_t match_length) noexcept {
+            unsigned char* token = op++;
+            *token = static_cast<unsigned char>((num_literals < 15 ? num_literals : 15) << 4);
+            if (num_literals >= 15) op = LzPutLength(op, num_literals - 15);
+            if (num_literals > 0) std::memcpy(op, literals, num_literals);
+            op += num_literals;
+            if (match_length == 0) return op;
+            *op++ = static_cast<unsigned char>(offset & 0xFF);
+            *op++ = static_cast<unsigned char>(offset >> 8);
+            const std::size_t m = match_length - kLzMinMatch;
+            *token |= static_cast<unsigned char>(m < 15 ? m : 15);
+            if (m >= 15) op = LzPutLength(op, m - 15);
+            return op;
+        }
+
+        // Reads a length extension (after a nibble of 15) from [ip, end).
+        inline std::size_t LzGetLength(const unsigned char*& ip, const unsigned char* end) {
+            std::size_t n = 0;
+            unsigned char b;
+            do {
+                if (ip == end) throw std::runtime_error("LzDecompress: corrupt input");
+                b = *ip++;
+                n += b;
+            } while (b == 255);
+            return n;
+        }
+    }
+
+    // Compresses the n bytes at src into dst (LzCompressBound(n) bytes) and
+    // returns the compressed size. n must be below 4 GiB.
+    inline std::size_t LzCompress(const unsigned char* src, const std::size_t n, unsigned char* dst) {
+        unsigned char* op = dst;
+        std::size_t anchor = 0;
+        if (n > kLzMatchLimit) {
+            std::vector<std::uint32_t> table(std::size_t(1) << kLzHashLog, 0);
+            const std::size_t limit = n - kLzMatchLimit;
+            const std::size_t match_end = n - kLzLastLiterals;
+            // The step grows by one every 64 failed probes, so incompressible
+            // data is skipped quickly.
+            std::size_t misses = 1 << 6;
+            for (std::size_t ip = 1; ip < limit;) {
+                const std::uint32_t h = detail::LzHash(detail::Load32(src + ip));
+                std::size_t ref = table[h];
+                table[h] = static_cast<std::uint32_t>(ip);
+                if (ip - ref > kLzMaxOffset || detail::Load32(src + ref) != detail::Load32(src + ip)) {
+                    ip += misses++ >> 6;
+                    continue;
+                }
+                std::size_t start = ip;
+                while (start > anchor && ref > 0 && src[start - 1] == src[ref - 1]) {
+                    --start;
+                    --ref;
+                }
+                const std::size_t length = kLzMinMatch + detail::LzMatchLength(src + start + kLzMinMatch, src + ref + kLzMinMatch,
+                                                                               match_end - start - kLzMinMatch);
+                op = detail::LzPutSequence(op, src + anchor, start - anchor, start - ref, length);
+                ip = anchor = start + length;
+                misses = 1 << 6;
+                if (ip - 2 < limit) table[detail::LzHash(detail::Load32(src + ip - 2))] = static_cast<std::uint32_t>(ip - 2);
+            }
+        }
+        return static_cast<std::size_t>(detail::LzPutSequence(op, src + anchor, n - anchor, 0, 0) - dst);
+    }
+
+    // Decompresses the n bytes at src into exactly `size` bytes at dst;
+    // throws std::runtime_error if the input is corrupt or of another size.
+    inline void LzDecompress(const unsigned char* src, const std::size_t n, unsigned char* dst, const std::size_t size) {
+        const unsigned char* ip = src;
+        const unsigned char* const end = src + n;
+        std::size_t op = 0;
+        for (;;) {
+            if (ip == end) throw std::runtime_error("LzDecompress: corrupt input");
+            const unsigned token = *ip++;
+            std::size_t literals = token >> 4;
+            if (literals == 15) literals += detail::LzGetLength(ip, end);
+            if (literals > static_cast<std::size_t>(end - ip) || literals > size - op) {
+                throw std::runtime_error("LzDecompress: corrupt input");
+            }
+            if (literals <= kLzWildCopy && static_cast<std::size_t>(end - ip) >= kLzWildCopy && size - op >= kLzWildCopy) {
+                std::memcpy(dst + op, ip, kLzWildCopy);
+            } else if (literals > 0) {
+                std::memcpy(dst + op, ip, literals);
+            }
+            ip += literals;
+            op += literals;
+            if (ip == end) break;
+
+            if (end - ip < 2) throw std::runtime_error("LzDecompress: corrupt input");
+            const std::size_t offset = ip[0] | (std::size_t(ip[1]) << 8);
+            ip += 2;
+            std::size_t length = token & 15;
+            if (length == 15) length += detail::LzGetLength(ip, end);
+            length += kLzMinMatch;
+            if (offset == 0 || offset > op || length > size - op) {
+                throw std::runtime_error("LzDecompress: corrupt input");
+            }
+            unsigned char* out = dst + op;
+            if (size - op >= length + kLzWildCopy) {
+                // A match repeats with period `offset`, hence also with any
+                // multiple of it: the first `period` bytes go one at a time
+                // when the copy would otherwise overlap, the rest in blocks.
+                std::size_t period = offset, i = 0;
+                while (period < 8) period += offset;
+                if (period != offset) {
+                    for (; i < period && i < length; ++i) out[i] = out[i - offset];
+                }
+                if (period >= kLzWildCopy) {
+                    for (; i < length; i += kLzWildCopy) std::memcpy(out + i, out + i - period, kLzWildCopy);
+                } else {
+                    for (; i < length; i += 8) std::memcpy(out + i, out + i - period, 8);
+                }
+            } else {
+                for (std::size_t i = 0; i < length; ++i) out[i] = out[i - offset];
+            }
+            op += length;
+        }
+        if (op != size) throw std::runtime_error("LzDecompress: corrupt input");
+    }
+
+    // #######################
+    // Byte shuffle
+    // #######################
+    // Groups byte b of every item together (all first bytes, then all second
+    // bytes, ...), turning the slowly varying high bytes of numeric data into
+    // long runs for LzCompress.
+
+    namespace detail {
+
+        // Item sizes known at compile time let the loops below be unrolled
+        // and vectorized; blocks of kShuffleBlock items keep both sides in L1.
+        constexpr std::size_t kShuffleBlock = 256;
+
+        template <std::size_t S>
+        void Shuffle(const unsigned char* src, const std::size_t count, unsigned char* dst) noexcept {
+            for (std::size_t i0 = 0; i0 < count; i0 += kShuffleBlock) {
+                const std::size_t n = std::min(kShuffleBlock, count - i0);
+                for (std::size_t b = 0; b < S; ++b) {
+                    for (std::size_t i = 0; i < n; ++i) dst[b * count + i0 + i] = src[(i0 + i) * S + b];
+                }
+            }
+        }
+
+        template <std::size_t S>
+        void Unshuffle(const unsigned char* src, const std::size_t count, unsigned char* dst) noexcept {
+            for (std::size_t i0 = 0; i0 < count; i0 += kShuffleBlock) {
+                const std::size_t n = std::min(kShuffleBlock, count - i0);
+                for (std::size_t i = 0; i < n; ++i) {
+                    for (std::size_t b = 0; b < S; ++b) dst[(i0 + i) * S + b] = src[b * count + i0 + i];
+                }
+            }
+        }
+    }
+
+    inline void ShuffleBytes(const unsigned char* src, const std::size_t count, const std::size_t item_size, unsigned char* dst) noexcept {
+        switch (item_size) {
+            case 2: detail::Shuffle<2>(src, count, dst); return;
+            case 4: detail::Shuffle<4>(src, count, dst); return;
+            case 8: detail::Shuffle<8>(src, count, dst); return;
+            case 16: detail::Shuffle<16>(src, count, dst); return;
+        }
+        for (std::size_t b = 0; b < item_size; ++b) {
+            unsigned char* out = dst + b * count;
+            for (std::size_t i = 0; i < count; ++i) out[i] = src[i * item_size + b];
+        }
+    }
+
+    inline void UnshuffleBytes(const unsigned char* src, const std::size_t count, const std::size_t item_size, unsigned char* dst) noexcept {
+        switch (item_size) {
+            case 2: detail::Unshuffle<2>(src, count, dst); return;
+            case 4: detail::Unshuffle<4>(src, count, dst); return;
+            case 8: detail::Unshuffle<8>(src, count, dst); return;
+            case 16: detail::Unshuffle<16>(src, count, dst); return;
+        }
+        for (std::size_t b = 0; b < item_size; ++b) {
+            const unsigned char* in = src + b * count;
+            for (std::size_t i = 0; i < count; ++i) dst[i * item_size + b] = in[i];
+        }
+    }
+}
+
+#endif /* CODEC_HPP_ */
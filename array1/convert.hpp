@@ -0,0 +1,53 @@
+#ifndef CONVERT_HPP_
+#define CONVERT_HPP_
+
+#include <type_traits>
+
+#include "layout.hpp"
+#include "parallel.hpp"
+#include "transpose.hpp"
+
+namespace array {
+
+    // #######################
+    // Layout conversion
+    // #######################
+    // Copies `src` into `dst` of the same rank and element type, whose layout
+    // may differ, e.g. a RowMajor Array2D into a ColumnMajorArray2D for a
+    // LAPACK call. dst is resized to the shape of src and keeps its own
+    // padding. Different layouts are a blocked transposing copy (see
+    // CopyStrided in transpose.hpp); equal layouts without padding are a
+    // plain ParallelCopy.
+    template <typename Src, typename Dst>
+    void ConvertLayout(const Src& src, Dst& dst) {
+        dst.ResizeLike(src);
+        if (src.Size() == 0) return;
+        if constexpr (std::is_same<typename LayoutOf<Src>::type, typename LayoutOf<Dst>::type>::value) {
+            if (src.IsContiguous() && dst.IsContiguous()) {
+                ParallelCopy(src.Data(), src.Size(), dst.Data());
+            } else {
+                detail::CopyStrided(src.View(), dst.View());
+            }
+        } else {
+            detail::CopyStrided(src.View(), dst.View());
+        }
+    }
+
+    // Copy of `a` in column-major (Fortran) order.
+    template <typename A>
+    typename A::template rebind_layout<ColumnMajor> ToColumnMajor(const A& a) {
+        typename A::template rebind_layout<ColumnMajor> result;
+        ConvertLayout(a, result);
+        return result;
+    }
+
+    // Copy of `a` in row-major (C) order.
+    template <typename A>
+    typename A::template rebind_layout<RowMajor> ToRowMajor(const A& a) {
+        typename A::template rebind_layout<RowMajor> result;
+        ConvertLayout(a, result);
+        return result;
+    }
+}
+
+#endif /* CONVERT_HPP_ */
@@ -0,0 +1,342 @@
+#ifndef EXPRESSION_HPP_
+#define EXPRESSION_HPP_
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <stdexcept>
+
+#include "array_base.hpp"
+#include "shape.hpp"
+
+namespace array {
+
+    // #######################
+    // Traits
+    // #######################
+
+    template <typename A, typename = void>
+    struct IsArray : std::false_type { };
+
+    template <typename A>
+    struct IsArray<A, std::void_t<typename A::value_type, typename A::allocator_type, typename A::layout_type>>
+        : std::is_base_of<ArrayBase<typename A::value_type, typename A::allocator_type, typename A::layout_type>, A> { };
+
+    template <typename E>
+    struct IsExpression : std::is_base_of<Expression<E>, E> { };
+
+    template <typename S>
+    struct IsScalar : std::is_arithmetic<S> { };
+
+    // Layout of a node combining operands of layouts L and R (void: scalar).
+    // Elements are combined by flat index, so arrays of different layouts
+    // cannot be mixed; convert one of them first (see convert.hpp).
+    template <typename L, typename R>
+    struct CommonLayout {
+        static_assert(std::is_same<L, R>::value, "Expression: operands have different memory layouts");
+        using type = L;
+    };
+
+    template <typename R>
+    struct CommonLayout<void, R> { using type = R; };
+
+    template <typename L>
+    struct CommonLayout<L, void> { using type = L; };
+
+    template <>
+    struct CommonLayout<void, void> { using type = void; };
+
+    // #######################
+    // Expression (CRTP base)
+    // #######################
+    // Expressions are evaluated lazily: nothing is computed until the expression
+    // is assigned to an array, which then runs a single fused loop over all elements.
+    // Nodes are read by flat index, expr[i], when no array involved has padded
+    // rows (IsContiguous()), and by (row, j) along the innermost axis otherwise
+    // (see ArrayBase::RowView).
+    template <typename E>
+    class Expression {
+    public:
+        inline const E& Self() const noexcept { return static_cast<const E&>(*this); }
+    };
+
+    // #######################
+    // Leaves
+    // #######################
+
+    template <typename A>
+    class ArrayOperand : public Expression<ArrayOperand<A>> {
+    public:
+        using value_type = typename A::value_type;
+        using layout_type = typename A::layout_type;
+        static constexpr bool kIsScalar = false;
+
+        explicit ArrayOperand(const A& array) noexcept
+        : ptr_data_(array.Data()), shape_(&array.Shape()), size_(array.Size()), pitch_(array.Pitch()), contiguous_(array.IsContiguous()) { }
+
+        inline value_type operator[](const std::size_t i) const { return ptr_data_[i]; }
+        inline value_type operator()(const std::size_t row, const std::size_t j) const { return ptr_data_[row * pitch_ + j]; }
+        inline const ArrayShape& Shape() const noexcept { return *shape_; }
+        inline std::size_t Size() const noexcept { return size_; }
+        inline bool IsContiguous() const noexcept { return contiguous_; }
+
+    private:
+        const value_type* ptr_data_;
+        const ArrayShape* shape_;
+        std::size_t size_;
+        std::size_t pitch_;
+        bool contiguous_;
+    };
+
+    template <typename S>
+    class ScalarOperand : public Expression<ScalarOperand<S>> {
+    public:
+        using value_type = S;
+        using layout_type = void;
+        static constexpr bool kIsScalar = true;
+
+        explicit ScalarOperand(const S value) noexcept : value_(value) { }
+
+        inline value_type operator[](const std::size_t) const { return value_; }
+        inline value_type operator()(std::size_t, std::size_t) const { return value_; }
+        inline bool IsContiguous() const noexcept { return true; }
+
+    private:
+        S value_;
+    };
+
+    // #######################
+    // Operators
+    // #######################
+
+    struct AddOp {
+        template <typename L, typename R>
+        static inline auto Apply(const L& l, const R& r) { return l + r; }
+    };
+
+    struct SubOp {
+        template <typename L, typename R>
+        static inline auto Apply(const L& l, const R& r) { return l - r; }
+    };
+
+    struct MulOp {
+        template <typename L, typename R>
+        static inline auto Apply(const L& l, const R& r) { return l * r; }
+    };
+
+    struct DivOp {
+        template <typename L, typename R>
+        static inline auto Apply(const L& l, const R& r) { return l / r; }
+    };
+
+    struct NegOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { return -v; }
+    };
+
+    struct AbsOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::abs; return abs(v); }
+    };
+
+    struct SqrtOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::sqrt; return sqrt(v); }
+    };
+
+    struct ExpOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::exp; return exp(v); }
+    };
+
+    struct LogOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::log; return log(v); }
+    };
+
+    struct SinOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::sin; return sin(v); }
+    };
+
+    struct CosOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::cos; return cos(v); }
+    };
+
+    struct TanOp {
+        template <typename V>
+        static inline auto Apply(const V& v) { using std::tan; return tan(v); }
+    };
+
+    // #######################
+    // Nodes
+    // #######################
+
+    template <typename Op, typename L, typename R>
+    class BinaryExpression : public Expression<BinaryExpression<Op, L, R>> {
+    public:
+        using value_type = decltype(Op::Apply(std::declval<typename L::value_type>(), std::declval<typename R::value_type>()));
+        using layout_type = typename CommonLayout<typename L::layout_type, typename R::layout_type>::type;
+        static constexpr bool kIsScalar = L::kIsScalar && R::kIsScalar;
+
+        BinaryExpression(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+            if constexpr (!L::kIsScalar && !R::kIsScalar) {
+                if (lhs_.Shape() != rhs_.Shape()) {
+                    throw std::invalid_argument("Expression: shape mismatch");
+                }
+            }
+        }
+
+        inline value_type operator[](const std::size_t i) const { return Op::Apply(lhs_[i], rhs_[i]); }
+        inline value_type operator()(const std::size_t row, const std::size_t j) const { return Op::Apply(lhs_(row, j), rhs_(row, j)); }
+        inline bool IsContiguous() const noexcept { return lhs_.IsContiguous() && rhs_.IsContiguous(); }
+
+        inline const ArrayShape& Shape() const noexcept {
+            if constexpr (L::kIsScalar) {
+                return rhs_.Shape();
+            } else {
+                return lhs_.Shape();
+            }
+        }
+
+        inline std::size_t Size() const noexcept {
+            if constexpr (L::kIsScalar) {
+                return rhs_.Size();
+            } else {
+                return lhs_.Size();
+            }
+        }
+
+    private:
+        L lhs_;
+        R rhs_;
+    };
+
+    template <typename Op, typename E>
+    class UnaryExpression : public Expression<UnaryExpression<Op, E>> {
+    public:
+        using value_type = decltype(Op::Apply(std::declval<typename E::value_type>()));
+        using layout_type = typename E::layout_type;
+        static constexpr bool kIsScalar = E::kIsScalar;
+
+        explicit UnaryExpression(const E& operand) : operand_(operand) { }
+
+        inline value_type operator[](const std::size_t i) const { return Op::Apply(operand_[i]); }
+        inline value_type operator()(const std::size_t row, const std::size_t j) const { return Op::Apply(operand_(row, j)); }
+        inline bool IsContiguous() const noexcept { return operand_.IsContiguous(); }
+        inline const ArrayShape& Shape() const noexcept { return operand_.Shape(); }
+        inline std::size_t Size() const noexcept { return operand_.Size(); }
+
+    private:
+        E operand_;
+    };
+
+    // #######################
+    // Operand wrapping
+    // #######################
+
+    template <typename X, typename = void>
+    struct OperandOf { };
+
+    template <typename X>
+    struct OperandOf<X, std::enable_if_t<IsArray<X>::value>> {
+        using type = ArrayOperand<X>;
+        static inline type Make(const X& x) { return type(x); }
+    };
+
+    template <typename X>
+    struct OperandOf<X, std::enable_if_t<IsExpression<X>::value>> {
+        using type = X;
+        static inline const type& Make(const X& x) { return x; }
+    };
+
+    template <typename X>
+    struct OperandOf<X, std::enable_if_t<IsScalar<X>::value>> {
+        using type = ScalarOperand<X>;
+        static inline type Make(const X& x) { return type(x); }
+    };
+
+    // True when (L, R) are valid binary operands and at least one of them is an array or expression.
+    template <typename L, typename R>
+    struct IsBinaryOperands
+        : std::integral_constant<bool,
+            (IsArray<L>::value || IsExpression<L>::value || IsArray<R>::value || IsExpression<R>::value)
+            && (IsArray<L>::value || IsExpression<L>::value || IsScalar<L>::value)
+            && (IsArray<R>::value || IsExpression<R>::value || IsScalar<R>::value)> { };
+
+    template <typename X>
+    struct IsUnaryOperand : std::integral_constant<bool, IsArray<X>::value || IsExpression<X>::value> { };
+
+    template <typename Op, typename L, typename R>
+    using BinaryExpressionOf = BinaryExpression<Op, typename OperandOf<L>::type, typename OperandOf<R>::type>;
+
+    template <typename Op, typename X>
+    using UnaryExpressionOf = UnaryExpression<Op, typename OperandOf<X>::type>;
+
+    template <typename Op, typename L, typename R>
+    inline BinaryExpressionOf<Op, L, R> MakeBinaryExpression(const L& lhs, const R& rhs) {
+        return BinaryExpressionOf<Op, L, R>(OperandOf<L>::Make(lhs), OperandOf<R>::Make(rhs));
+    }
+
+    template <typename Op, typename X>
+    inline UnaryExpressionOf<Op, X> MakeUnaryExpression(const X& x) {
+        return UnaryExpressionOf<Op, X>(OperandOf<X>::Make(x));
+    }
+
+    // #######################
+    // Arithmetic
+    // #######################
+
+    template <typename L, typename R, std::enable_if_t<IsBinaryOperands<L, R>::value, int> = 0>
+    inline BinaryExpressionOf<AddOp, L, R> operator+(const L& lhs, const R& rhs) {
+        return MakeBinaryExpression<AddOp>(lhs, rhs);
+    }
+
+    template <typename L, typename R, std::enable_if_t<IsBinaryOperands<L, R>::value, int> = 0>
+    inline BinaryExpressionOf<SubOp, L, R> operator-(const L& lhs, const R& rhs) {
+        return MakeBinaryExpression<SubOp>(lhs, rhs);
+    }
+
+    template <typename L, typename R, std::enable_if_t<IsBinaryOperands<L, R>::value, int> = 0>
+    inline BinaryExpressionOf<MulOp, L, R> operator*(const L& lhs, const R& rhs) {
+        return MakeBinaryExpression<MulOp>(lhs, rhs);
+    }
+
+    template <typename L, typename R, std::enable_if_t<IsBinaryOperands<L, R>::value, int> = 0>
+    inline BinaryExpressionOf<DivOp, L, R> operator/(const L& lhs, const R& rhs) {
+        return MakeBinaryExpression<DivOp>(lhs, rhs);
+    }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<NegOp, X> operator-(const X& x) {
+        return MakeUnaryExpression<NegOp>(x);
+    }
+
+    // #######################
+    // Element-wise functions
+    // #######################
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<AbsOp, X> Abs(const X& x) { return MakeUnaryExpression<AbsOp>(x); }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<SqrtOp, X> Sqrt(const X& x) { return MakeUnaryExpression<SqrtOp>(x); }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<ExpOp, X> Exp(const X& x) { return MakeUnaryExpression<ExpOp>(x); }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<LogOp, X> Log(const X& x) { return MakeUnaryExpression<LogOp>(x); }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<SinOp, X> Sin(const X& x) { return MakeUnaryExpression<SinOp>(x); }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<CosOp, X> Cos(const X& x) { return MakeUnaryExpression<CosOp>(x); }
+
+    template <typename X, std::enable_if_t<IsUnaryOperand<X>::value, int> = 0>
+    inline UnaryExpressionOf<TanOp, X> Tan(const X& x) { return MakeUnaryExpression<TanOp>(x); }
+}
+
+#endif /* EXPRESSION_HPP_ */
@@ -0,0 +1,522 @@
+#ifndef HALO_ARRAY_HPP_
+#define HALO_ARRAY_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "array_base.hpp"
+#include "array_view.hpp"
+#include "layout.hpp"
+#include "loop.hpp"
+#include "parallel.hpp"
+
+namespace array {
+
+    namespace detail {
+
+        // Calls f(offset_a, offset_b, length) for every row along the
+        // innermost axis of a `shape` box addressed through two sets of
+        // strides (unit stride along that axis on both sides). Rows of the
+        // next axis are a plain counted loop and the remaining axes are walked
+        // with an odometer, so thin faces (rows of one or two ghost cells) do
+        // not pay an index decomposition per row. Planes are split statically
+        // over ThreadPool::Global() once the box reaches kParallelThreshold
+        // elements.
+        template <typename Layout, std::size_t Rank, typename F>
+        void ForEachRegionRow(const std::array<std::size_t, Rank>& shape, const std::array<std::size_t, Rank>& strides_a,
+                              const std::array<std::size_t, Rank>& strides_b, F&& f) {
+            constexpr std::size_t inner = InnermostAxis<Layout, Rank>();
+            std::size_t size = 1;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                size *= shape[axis];
+            }
+            if (size == 0) return;
+            const std::size_t length = shape[inner];
+
+            // Axes other than `inner`, fastest varying first; the first one is
+            // the row loop, the others enumerate planes.
+            std::array<std::size_t, Rank> outer{};
+            for (std::size_t k = 0; k + 1 < Rank; ++k) {
+                outer[k] = Layout::kIsColumnMajor ? k + 1 : Rank - 2 - k;
+            }
+            const std::size_t rows = Rank > 1 ? shape[outer[0]] : 1;
+            const std::size_t row_a = Rank > 1 ? strides_a[outer[0]] : 0;
+            const std::size_t row_b = Rank > 1 ? strides_b[outer[0]] : 0;
+            const std::size_t num_planes = size / (length * rows);
+
+            auto process = [&](const std::size_t begin, const std::size_t end) {
+                std::array<std::size_t, Rank> index{};
+                std::size_t a = 0, b = 0;
+                std::size_t rest = begin;
+                for (std::size_t k = 1; k + 1 < Rank; ++k) {
+                    const std::size_t axis = outer[k];
+                    index[axis] = rest % shape[axis];
+                    rest /= shape[axis];
+                    a += index[axis] * strides_a[axis];
+                    b += index[axis] * strides_b[axis];
+                }
+                for (std::size_t plane = begin; plane < end; ++plane) {
+                    for (std::size_t row = 0; row < rows; ++row) {
+                        f(a + row * row_a, b + row * row_b, length);
+                    }
+                    for (std::size_t k = 1; k + 1 < Rank; ++k) {
+                        const std::size_t axis = outer[k];
+                        a += strides_a[axis];
+                        b += strides_b[axis];
+                        if (++index[axis] < shape[axis]) break;
+                        a -= shape[axis] * strides_a[axis];
+                        b -= shape[axis] * strides_b[axis];
+                        index[axis] = 0;
+                    }
+                }
+            };
+
+            ThreadPool& pool = ThreadPool::Global();
+            if (size < kParallelThreshold || pool.NumThreads() == 1 || num_planes == 1) {
+                process(0, num_planes);
+                return;
+            }
+            pool.Run([&](const std::size_t index, const std::size_t count) {
+                std::size_t begin, end;
+                StaticChunk(num_planes, 1, index, count, begin, end);
+                process(begin, end);
+            });
+        }
+
+        // dst = src for two views of the same shape, both contiguous along the
+        // innermost axis of Layout. Rows of one or two elements (the faces
+        // normal to the contiguous axis) get their own loops instead of a
+        // library call per row.
+        template <typename Layout, typename T, std::size_t Rank>
+        void CopyRegion(const ArrayView<const T, Rank>& src, const ArrayView<T, Rank>& dst) {
+            const T* s = src.Data();
+            T* d = dst.Data();
+            switch (src.Dim(InnermostAxis<Layout, Rank>())) {
+            case 1:
+                ForEachRegionRow<Layout>(src.Shape(), src.Strides(), dst.Strides(), [s, d](const std::size_t a, const std::size_t b, std::size_t) {
+                    d[b] = s[a];
+                });
+                break;
+            case 2:
+                ForEachRegionRow<Layout>(src.Shape(), src.Strides(), dst.Strides(), [s, d](const std::size_t a, const std::size_t b, std::size_t) {
+                    d[b] = s[a];
+                    d[b + 1] = s[a + 1];
+                });
+                break;
+            default:
+                ForEachRegionRow<Layout>(src.Shape(), src.Strides(), dst.Strides(), [s, d](const std::size_t a, const std::size_t b, const std::size_t length) {
+                    std::copy(s + a, s + a + length, d + b);
+                });
+                break;
+            }
+        }
+
+        template <typename Layout, typename T, std::size_t Rank>
+        void FillRegion(const ArrayView<T, Rank>& dst, const T& value) {
+            T* d = dst.Data();
+            ForEachRegionRow<Layout>(dst.Shape(), dst.Strides(), dst.Strides(), [d, &value](std::size_t, const std::size_t b, const std::size_t length) {
+                std::fill(d + b, d + b + length, value);
+            });
+        }
+
+        constexpr std::size_t RoundUp(const std::size_t n, const std::size_t multiple) noexcept {
+            return (n + multiple - 1) / multiple * multiple;
+        }
+
+        constexpr std::size_t PowerOf3(const std::size_t n) noexcept {
+            return n == 0 ? 1 : 3 * PowerOf3(n - 1);
+        }
+    }
+
+    // #######################
+    // HaloArray
+    // #######################
+    // `Rank`-dimensional array of Interior() points surrounded by Ghost()
+    // layers of ghost cells on every face, for domain decomposition. Points
+    // are addressed in interior coordinates: u(0, ..., 0) is the first
+    // interior point and the ghost cells sit at indices -Ghost()..-1 and
+    // Dim(axis)..Dim(axis) + Ghost() - 1.
+    //
+    // Shape() is Dim(axis) + 2 * Ghost() along every axis: the ArrayBase
+    // operations (Fill, Copy, expressions, the reductions, CheckNaN, Save,
+    // SaveNpy, ...) cover the ghost cells as well as the interior. Reduce
+    // InteriorView() for interior-only results, e.g. Sum(u.InteriorView()).
+    // The rows along the contiguous axis are padded to a Pitch() that is a
+    // multiple of kRowAlignment, and the block is allocated through an
+    // OffsetAllocator that starts it before Data(), so that every interior
+    // row starts on an Allocator alignment boundary (Data() itself, the
+    // first ghost cell, is only aligned to alignof(T)).
+    //
+    // Faces, edges and corners are named by a Direction, one of -1, 0, +1 per
+    // axis (never all zero): BoundaryView(d) is the layer of interior points
+    // a neighbour in direction d needs, GhostView(d) the ghost cells that
+    // neighbour fills. Pack/Unpack move them through contiguous buffers in
+    // storage order, so Pack(d) on one rank matches Unpack(-d) on the rank in
+    // direction d:
+    //     HaloArray<double, 3> u({nx, ny, nz}, 1);
+    //     u.ForEachDirection([&](const auto& d) {
+    //         buffers[d].resize(u.PackSize(d));
+    //         u.Pack(d, buffers[d].data());
+    //     });
+    //     ... exchange ...
+    //     u.Unpack(d, received.data());
+    //
+    // View() spans the ghost cells as well, so the array works directly with
+    // ApplyStencil and IterateStencil with ghost = Ghost().
+    template <typename T, std::size_t Rank, typename Allocator = AlignedAllocator<T>, typename Layout = RowMajor>
+    class HaloArray : public ArrayBase<T, OffsetAllocator<Allocator>, Layout> {
+        static_assert(Rank >= 1 && Rank <= ArrayShape::kMaxRank, "HaloArray: unsupported rank");
+
+        using Base = ArrayBase<T, OffsetAllocator<Allocator>, Layout>;
+        static constexpr std::size_t kRowAlignmentBytes = AllocatorAlignment<Allocator>::value;
+
+    public:
+        using index_array = std::array<std::size_t, Rank>;
+        using Direction = std::array<int, Rank>;
+
+        // Number of faces, edges and corners (3^Rank - 1).
+        static constexpr std::size_t kNumDirections = detail::PowerOf3(Rank) - 1;
+
+        // Padding granularity of the contiguous axis, in elements.
+        static constexpr std::size_t kRowAlignment =
+            kRowAlignmentBytes >= sizeof(T) && kRowAlignmentBytes % sizeof(T) == 0 ? kRowAlignmentBytes / sizeof(T) : 1;
+
+        // #######################
+        // Constructors
+        // #######################
+        HaloArray() : Base(), interior_{}, ghost_(0), origin_(0), strides_{} {
+            Resize(index_array{}, 0);
+        }
+
+        HaloArray(const index_array& interior, const std::size_t ghost)
+        : Base(), interior_{}, ghost_(0), origin_(0), strides_{} {
+            Resize(interior, ghost);
+        }
+
+        HaloArray(const index_array& interior, const std::size_t ghost, const T value) : HaloArray(interior, ghost) {
+            this->Fill(value);
+        }
+
+        // Copies get the same geometry, interior alignment included.
+        HaloArray(const HaloArray& other) : HaloArray(other.interior_, other.ghost_) {
+            Base::Copy(other);
+        }
+
+        HaloArray& operator=(const HaloArray& other) {
+            if (this != &other) {
+                Resize(other.interior_, other.ghost_);
+                Base::Copy(other);
+            }
+            return *this;
+        }
+
+        HaloArray(HaloArray&& other) noexcept
+        : Base(std::move(other)), interior_(other.interior_), ghost_(other.ghost_), origin_(other.origin_),
+          strides_(other.strides_) {
+            other.ResetGeometry();
+        }
+
+        HaloArray& operator=(HaloArray&& other) noexcept {
+            if (this == &other) {
+                return *this;
+            }
+            Base::operator=(std::move(other));
+            interior_ = other.interior_;
+            ghost_ = other.ghost_;
+            origin_ = other.origin_;
+            strides_ = other.strides_;
+            other.ResetGeometry();
+            return *this;
+        }
+
+        // #######################
+        // Geometry
+        // #######################
+        inline const index_array& Interior() const noexcept { return interior_; }
+        inline std::size_t Dim(const std::size_t axis) const noexcept { return interior_[axis]; }
+        inline std::size_t Ghost() const noexcept { return ghost_; }
+
+        // Element strides of the storage (padded along the contiguous axis).
+        inline const index_array& Strides() const noexcept { return strides_; }
+
+        // Interior points in the coordinates of View().
+        inline IndexRange<Rank> InteriorRange() const noexcept {
+            index_array begin, end;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                begin[axis] = ghost_;
+                end[axis] = ghost_ + interior_[axis];
+            }
+            return IndexRange<Rank>(begin, end);
+        }
+
+        // Changes the interior extents and the ghost width; values are
+        // unspecified afterwards, as for ArrayBase::Resize.
+        void Resize(const index_array& interior, const std::size_t ghost) {
+            constexpr std::size_t inner = InnermostAxis<Layout, Rank>();
+            // The block starts `offset` elements before Data(): the first
+            // interior point of row 0, and with the pitch that of every row,
+            // is then a multiple of kRowAlignment into it.
+            const std::size_t offset = detail::RoundUp(ghost, kRowAlignment) - ghost;
+            index_array shape;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                shape[axis] = interior[axis] + 2 * ghost;
+            }
+            index_array storage = shape;
+            storage[inner] = detail::RoundUp(shape[inner], kRowAlignment);
+
+            if (this->allocator_.Offset() != offset) {
+                this->DeleteArray();
+                this->allocator_ = OffsetAllocator<Allocator>(offset);
+            }
+            this->padding_ = Padding::Pitch(storage[inner]);
+            Base::Resize(ArrayShape(shape.begin(), shape.end()));
+
+            interior_ = interior;
+            ghost_ = ghost;
+            strides_ = LayoutStrides<Layout, Rank>(storage);
+            origin_ = 0;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                origin_ += ghost * strides_[axis];
+            }
+        }
+
+        void ResizeLike(const HaloArray& other) {
+            Resize(other.interior_, other.ghost_);
+        }
+
+        // Swap and Copy of ArrayBase, which also require the same interior
+        // extents and ghost width.
+        void Swap(HaloArray& other) {
+            CheckSameGeometry(other, "Swap: interior or ghost width mismatch");
+            Base::Swap(other);
+        }
+
+        void Copy(const HaloArray& other) {
+            CheckSameGeometry(other, "Copy: interior or ghost width mismatch");
+            Base::Copy(other);
+        }
+
+        // #######################
+        // Element access
+        // #######################
+        // Storage offset of interior coordinates (i, j, ...); ghost cells have
+        // negative or past-the-end coordinates.
+        template <typename... Indices>
+        inline std::size_t Offset(const Indices... index) const noexcept {
+            static_assert(sizeof...(Indices) == Rank, "HaloArray: wrong number of indices");
+            std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(origin_);
+            std::size_t axis = 0;
+            ((offset += static_cast<std::ptrdiff_t>(index) * static_cast<std::ptrdiff_t>(strides_[axis++])), ...);
+            return static_cast<std::size_t>(offset);
+        }
+
+        template <typename... Indices>
+        inline T& operator()(const Indices... index) noexcept {
+            return this->ptr_raw_data_[Offset(index...)];
+        }
+
+        template <typename... Indices>
+        inline const T& operator()(const Indices... index) const noexcept {
+            return this->ptr_raw_data_[Offset(index...)];
+        }
+
+        template <typename... Indices>
+        T& At(const Indices... index) {
+            CheckIndex(index...);
+            return (*this)(index...);
+        }
+
+        template <typename... Indices>
+        const T& At(const Indices... index) const {
+            CheckIndex(index...);
+            return (*this)(index...);
+        }
+
+        // #######################
+        // Views
+        // #######################
+        // Interior and ghost cells, without the padding.
+        inline ArrayView<T, Rank> View() { return Region<T>(this->ptr_raw_data_, Outer()); }
+        inline ArrayView<const T, Rank> View() const { return Region<const T>(this->ptr_raw_data_, Outer()); }
+
+        inline ArrayView<T, Rank> InteriorView() { return Region<T>(this->ptr_raw_data_, Inner()); }
+        inline ArrayView<const T, Rank> InteriorView() const { return Region<const T>(this->ptr_raw_data_, Inner()); }
+
+        // Interior points within Ghost() of the side(s) in direction d.
+        inline ArrayView<T, Rank> BoundaryView(const Direction& d) { return Region<T>(this->ptr_raw_data_, Side(d, false)); }
+        inline ArrayView<const T, Rank> BoundaryView(const Direction& d) const { return Region<const T>(this->ptr_raw_data_, Side(d, false)); }
+
+        // Ghost cells beyond the side(s) in direction d.
+        inline ArrayView<T, Rank> GhostView(const Direction& d) { return Region<T>(this->ptr_raw_data_, Side(d, true)); }
+        inline ArrayView<const T, Rank> GhostView(const Direction& d) const { return Region<const T>(this->ptr_raw_data_, Side(d, true)); }
+
+        // #######################
+        // Halo exchange
+        // #######################
+        // Calls f(d) for each of the kNumDirections faces, edges and corners.
+        template <typename F>
+        static void ForEachDirection(F&& f) {
+            for (std::size_t code = 0; code < kNumDirections + 1; ++code) {
+                Direction d;
+                std::size_t rest = code;
+                bool center = true;
+                for (std::size_t axis = 0; axis < Rank; ++axis) {
+                    d[axis] = static_cast<int>(rest % 3) - 1;
+                    rest /= 3;
+                    center &= d[axis] == 0;
+                }
+                if (!center) f(static_cast<const Direction&>(d));
+            }
+        }
+
+        static Direction Opposite(Direction d) noexcept {
+            for (int& x : d) x = -x;
+            return d;
+        }
+
+        // Elements of BoundaryView(d) and GhostView(d).
+        std::size_t PackSize(const Direction& d) const {
+            std::size_t size = 1;
+            for (const std::size_t n : Side(d, false).second) {
+                size *= n;
+            }
+            return size;
+        }
+
+        // buffer[0, PackSize(d)) = BoundaryView(d) in storage order.
+        void Pack(const Direction& d, T* buffer) const {
+            const ArrayView<const T, Rank> region = BoundaryView(d);
+            detail::CopyRegion<Layout>(region, ArrayView<T, Rank>(buffer, region.Shape(), LayoutStrides<Layout, Rank>(region.Shape())));
+        }
+
+        // GhostView(d) = buffer[0, PackSize(d)), as written by Pack(-d) on the
+        // neighbour in direction d.
+        void Unpack(const Direction& d, const T* buffer) {
+            const ArrayView<T, Rank> region = GhostView(d);
+            detail::CopyRegion<Layout>(ArrayView<const T, Rank>(buffer, region.Shape(), LayoutStrides<Layout, Rank>(region.Shape())), region);
+        }
+
+        // Periodic boundaries on a single domain: every ghost region gets the
+        // interior layer on the opposite side. Needs Ghost() <= Dim(axis).
+        void ExchangePeriodic() {
+            ForEachDirection([this](const Direction& d) {
+                detail::CopyRegion<Layout>(std::as_const(*this).BoundaryView(Opposite(d)), GhostView(d));
+            });
+        }
+
+        // Constant (Dirichlet) boundary: all ghost cells = value.
+        void FillGhosts(const T& value) {
+            ForEachDirection([this, &value](const Direction& d) {
+                detail::FillRegion<Layout>(GhostView(d), value);
+            });
+        }
+
+        // Same array type with another memory layout.
+        template <typename OtherLayout>
+        using rebind_layout = HaloArray<T, Rank, Allocator, OtherLayout>;
+
+        virtual std::size_t NumDimensions() const noexcept override {
+            return Rank;
+        }
+
+    private:
+        using signed_index_array = std::array<std::ptrdiff_t, Rank>;
+        using Box = std::pair<signed_index_array, index_array>;
+
+        index_array interior_;
+        std::size_t ghost_;
+        std::size_t origin_;
+        index_array strides_;
+
+        void ResetGeometry() noexcept {
+            interior_ = {};
+            ghost_ = 0;
+            origin_ = 0;
+            strides_ = {};
+        }
+
+        void CheckSameGeometry(const HaloArray& other, const char* message) const {
+            if (interior_ != other.interior_ || ghost_ != other.ghost_) {
+                throw std::invalid_argument(message);
+            }
+        }
+
+        template <typename... Indices>
+        void CheckIndex(const Indices... index) const {
+            const std::array<std::ptrdiff_t, Rank> i = {static_cast<std::ptrdiff_t>(index)...};
+            const std::ptrdiff_t g = static_cast<std::ptrdiff_t>(ghost_);
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                if (i[axis] < -g || i[axis] >= static_cast<std::ptrdiff_t>(interior_[axis]) + g) {
+                    throw std::out_of_range("HaloArray index out of range");
+                }
+            }
+        }
+
+        // Boxes as (first point in interior coordinates, extents).
+        Box Outer() const noexcept {
+            Box box;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                box.first[axis] = -static_cast<std::ptrdiff_t>(ghost_);
+                box.second[axis] = interior_[axis] + 2 * ghost_;
+            }
+            return box;
+        }
+
+        Box Inner() const noexcept {
+            return Box(signed_index_array{}, interior_);
+        }
+
+        Box Side(const Direction& d, const bool ghost) const {
+            Box box;
+            bool center = true;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(interior_[axis]);
+                const std::ptrdiff_t g = static_cast<std::ptrdiff_t>(ghost_);
+                switch (d[axis]) {
+                case -1:
+                    box.first[axis] = ghost ? -g : 0;
+                    box.second[axis] = ghost_;
+                    break;
+                case 0:
+                    box.first[axis] = 0;
+                    box.second[axis] = interior_[axis];
+                    break;
+                case 1:
+                    box.first[axis] = ghost ? n : n - g;
+                    box.second[axis] = ghost_;
+                    break;
+                default:
+                    throw std::invalid_argument("HaloArray: direction components must be -1, 0 or 1");
+                }
+                if (d[axis] != 0 && !ghost && ghost_ > interior_[axis]) {
+                    throw std::invalid_argument("HaloArray: ghost width exceeds the interior extent");
+                }
+                center &= d[axis] == 0;
+            }
+            if (center) {
+                throw std::invalid_argument("HaloArray: direction must not be all zero");
+            }
+            return box;
+        }
+
+        template <typename U>
+        ArrayView<U, Rank> Region(U* data, const Box& box) const noexcept {
+            if (data == nullptr) {
+                return ArrayView<U, Rank>(nullptr, box.second, strides_);
+            }
+            std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(origin_);
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                offset += box.first[axis] * static_cast<std::ptrdiff_t>(strides_[axis]);
+            }
+            return ArrayView<U, Rank>(data + offset, box.second, strides_);
+        }
+    };
+
+    template <typename T, std::size_t Rank, typename Allocator = AlignedAllocator<T>>
+    using ColumnMajorHaloArray = HaloArray<T, Rank, Allocator, ColumnMajor>;
+}
+
+#endif /* HALO_ARRAY_HPP_ */
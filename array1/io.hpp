@@ -0,0 +1,400 @@
+#ifndef IO_HPP_
+#define IO_HPP_
+
+#include <algorithm>
+#include <cerrno>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "array_base.hpp"
+#include "layout.hpp"
+#include "parallel.hpp"
+#include "shape.hpp"
+
+namespace array {
+
+    // #######################
+    // Array file format
+    // #######################
+    // A kFileDataAlignment-byte header followed by the elements in the storage
+    // order of the array's layout, without row padding. Header fields
+    // (integers little-endian):
+    //     0   8  magic "ARRAYBIN"
+    //     8   2  format version (1)
+    //     10  1  element kind: 'b' bool, 'i' signed, 'u' unsigned, 'f' float, 'c' complex
+    //     11  1  element size in bytes
+    //     12  1  byte order of the elements: '<' little-endian, '>' big-endian
+    //     13  1  layout: 'C' RowMajor, 'F' ColumnMajor
+    //     14  1  rank (1 to 6)
+    //     16  48 extents, 8 bytes each (unused ones zero)
+    //     64  8  byte offset of the elements
+    // The elements start on a page boundary, so the data part can also be
+    // read with O_DIRECT or opened as a MappedArray at offset
+    // ReadHeader(path).data_offset.
+    constexpr std::size_t kFileDataAlignment = 4096;
+
+    // How Save and Load move the elements:
+    //     Buffered  large pwritev/preadv calls straight from/into the array,
+    //               through the page cache.
+    //     Direct    O_DIRECT, bypassing the page cache, when the file system
+    //               supports it and Data() is kFileDataAlignment-aligned (e.g.
+    //               AlignedAllocator<T, kFileDataAlignment>); Buffered otherwise.
+    // Arrays of kParallelThreshold elements or more are transferred by all
+    // threads of ThreadPool::Global(), each on its ParallelForStatic chunk.
+    enum class IoMode {
+        Buffered,
+        Direct
+    };
+
+    // Decoded header of an array file.
+    struct ArrayFileHeader {
+        char kind;
+        std::size_t item_size;
+        bool little_endian;
+        bool column_major;
+        ArrayShape shape;
+        std::size_t data_offset;
+
+        std::size_t Size() const noexcept {
+            std::size_t size = shape.empty() ? 0 : 1;
+            for (const std::size_t n : shape) size *= n;
+            return size;
+        }
+    };
+
+    namespace detail {
+
+        constexpr char kFileMagic[8] = {'A', 'R', 'R', 'A', 'Y', 'B', 'I', 'N'};
+        constexpr std::uint16_t kFileVersion = 1;
+        constexpr std::size_t kFileHeaderBytes = 72;
+
+        // Segments per pwritev/preadv call.
+        constexpr std::size_t kIoMaxSegments = 256;
+
+        inline bool NativeLittleEndian() noexcept {
+            return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+        }
+
+        // Element kind and size of each byte-swapped component of T.
+        template <typename T>
+        struct DType {
+            static_assert(std::is_arithmetic<T>::value, "Save/Load: unsupported element type");
+            static constexpr char kind = std::is_same<T, bool>::value ? 'b'
+                                       : std::is_floating_point<T>::value ? 'f'
+                                       : std::is_signed<T>::value ? 'i' : 'u';
+            static constexpr std::size_t component = sizeof(T);
+        };
+
+        template <typename F>
+        struct DType<std::complex<F>> {
+            static constexpr char kind = 'c';
+            static constexpr std::size_t component = sizeof(F);
+        };
+
+        inline void PutLE(unsigned char* p, std::uint64_t value, const std::size_t bytes) noexcept {
+            for (std::size_t i = 0; i < bytes; ++i, value >>= 8) p[i] = static_cast<unsigned char>(value);
+        }
+
+        inline std::uint64_t GetLE(const unsigned char* p, const std::size_t bytes) noexcept {
+            std::uint64_t value = 0;
+            for (std::size_t i = bytes; i-- > 0;) value = (value << 8) | p[i];
+            return value;
+        }
+
+        // Owning file descriptor.
+        class FileHandle {
+        public:
+            FileHandle(const std::string& path, const int flags) : path_(path), fd_(::open(path.c_str(), flags, 0644)) { }
+
+            FileHandle(const FileHandle&) = delete;
+            FileHandle& operator=(const FileHandle&) = delete;
+
+            ~FileHandle() {
+                if (fd_ >= 0) ::close(fd_);
+            }
+
+            inline bool IsOpen() const noexcept { return fd_ >= 0; }
+            inline int Descriptor() const noexcept { return fd_; }
+            inline const std::string& Path() const noexcept { return path_; }
+
+            [[noreturn]] void Fail(const char* what) const {
+                throw std::system_error(errno, std::generic_category(), std::string(what) + " " + path_);
+            }
+
+            // Transfers all the bytes of the segments at `offset`, resuming
+            // after partial transfers and interrupted calls.
+            void Transfer(iovec* iov, std::size_t count, off_t offset, const bool write) const {
+                while (count > 0) {
+                    const int n = static_cast<int>(std::min(count, kIoMaxSegments));
+                    const ssize_t done = write ? ::pwritev(fd_, iov, n, offset) : ::preadv(fd_, iov, n, offset);
+                    if (done < 0) {
+                        if (errno == EINTR) continue;
+                        Fail(write ? "Save: cannot write" : "Load: cannot read");
+                    }
+                    if (done == 0) {
+                        throw std::runtime_error("Load: unexpected end of file " + path_);
+                    }
+                    offset += done;
+                    std::size_t left = static_cast<std::size_t>(done);
+                    while (left > 0 && left >= iov->iov_len) {
+                        left -= iov->iov_len;
+                        ++iov;
+                        --count;
+                    }
+                    if (left > 0) {
+                        iov->iov_base = static_cast<unsigned char*>(iov->iov_base) + left;
+                        iov->iov_len -= left;
+                    }
+                }
+            }
+
+        private:
+            std::string path_;
+            int fd_;
+        };
+
+        inline ArrayFileHeader ReadHeader(const FileHandle& file) {
+            unsigned char bytes[kFileHeaderBytes];
+            iovec iov = {bytes, sizeof(bytes)};
+            file.Transfer(&iov, 1, 0, false);
+            if (std::memcmp(bytes, kFileMagic, sizeof(kFileMagic)) != 0) {
+                throw std::runtime_error("Load: " + file.Path() + " is not an array file");
+            }
+            if (GetLE(bytes + 8, 2) != kFileVersion) {
+                throw std::runtime_error("Load: unsupported array file version in " + file.Path());
+            }
+            ArrayFileHeader header;
+            header.kind = static_cast<char>(bytes[10]);
+            header.item_size = bytes[11];
+            header.little_endian = bytes[12] == '<';
+            header.column_major = bytes[13] == 'F';
+            const std::size_t rank = bytes[14];
+            if (rank == 0 || rank > ArrayShape::kMaxRank) {
+                throw std::runtime_error("Load: invalid rank in " + file.Path());
+            }
+            std::size_t dims[ArrayShape::kMaxRank];
+            for (std::size_t axis = 0; axis < rank; ++axis) {
+                dims[axis] = static_cast<std::size_t>(GetLE(bytes + 16 + 8 * axis, 8));
+            }
+            header.shape = ArrayShape(dims, dims + rank);
+            header.data_offset = static_cast<std::size_t>(GetLE(bytes + 64, 8));
+            return header;
+        }
+
+        template <typename T, typename Layout>
+        void WriteHeader(const FileHandle& file, const ArrayShape& shape) {
+            std::vector<unsigned char> bytes(kFileDataAlignment, 0);
+            std::memcpy(bytes.data(), kFileMagic, sizeof(kFileMagic));
+            PutLE(&bytes[8], kFileVersion, 2);
+            bytes[10] = static_cast<unsigned char>(DType<T>::kind);
+            bytes[11] = static_cast<unsigned char>(sizeof(T));
+            bytes[12] = NativeLittleEndian() ? '<' : '>';
+            bytes[13] = Layout::kIsColumnMajor ? 'F' : 'C';
+            bytes[14] = static_cast<unsigned char>(shape.size());
+            for (std::size_t axis = 0; axis < shape.size(); ++axis) {
+                PutLE(&bytes[16 + 8 * axis], shape[axis], 8);
+            }
+            PutLE(&bytes[64], kFileDataAlignment, 8);
+            iovec iov = {bytes.data(), bytes.size()};
+            file.Transfer(&iov, 1, 0, true);
+        }
+
+        // Moves the elements [begin, end) (in storage order, padding excluded)
+        // of rows of `length` elements starting `pitch` apart at `data`, to or
+        // from the file bytes starting at `offset` + begin * sizeof(T).
+        template <typename T>
+        void TransferElements(const FileHandle& file, T* data, const std::size_t length, const std::size_t pitch,
+                              const std::size_t begin, const std::size_t end, const std::size_t offset, const bool write) {
+            iovec iov[kIoMaxSegments];
+            std::size_t count = 0;
+            std::size_t first = begin;
+            for (std::size_t i = begin; i < end;) {
+                const std::size_t row = i / length;
+                const std::size_t j = i - row * length;
+                const std::size_t n = std::min(length - j, end - i);
+                iov[count].iov_base = const_cast<std::remove_const_t<T>*>(data + row * pitch + j);
+                iov[count].iov_len = n * sizeof(T);
+                i += n;
+                if (++count == kIoMaxSegments || i == end) {
+                    file.Transfer(iov, count, static_cast<off_t>(offset + first * sizeof(T)), write);
+                    count = 0;
+                    first = i;
+                }
+            }
+        }
+
+        // Transfers all the elements of `a` in parallel chunks, through O_DIRECT
+        // for the whole pages when `mode` asks for it and the array and the
+        // file offset allow it.
+        template <typename T, typename A>
+        void TransferArray(const FileHandle& file, const int flags, A& a, const std::size_t offset, const IoMode mode, const bool write) {
+            const std::size_t n = a.Size();
+            if (n == 0) return;
+            T* data = const_cast<T*>(a.Data());
+            const std::size_t length = a.IsContiguous() ? n : a.RowLength();
+            const std::size_t pitch = a.IsContiguous() ? n : a.Pitch();
+
+            std::size_t direct_end = 0;
+#ifdef O_DIRECT
+            if (mode == IoMode::Direct && a.IsContiguous() && kFileDataAlignment % sizeof(T) == 0 && offset % kFileDataAlignment == 0 &&
+                reinterpret_cast<std::uintptr_t>(data) % kFileDataAlignment == 0) {
+                const FileHandle direct(file.Path(), flags | O_DIRECT);
+                if (direct.IsOpen()) {
+                    direct_end = n * sizeof(T) / kFileDataAlignment * kFileDataAlignment / sizeof(T);
+                    ParallelForStatic(direct_end, PageElements<T>(), [&](const std::size_t begin, const std::size_t end) {
+                        TransferElements(direct, data, length, pitch, begin, end, offset, write);
+                    });
+                }
+            }
+#else
+            (void)flags;
+            (void)mode;
+#endif
+            ParallelForStatic(n - direct_end, PageElements<T>(), [&](const std::size_t begin, const std::size_t end) {
+                TransferElements(file, data, length, pitch, direct_end + begin, direct_end + end, offset, write);
+            });
+        }
+
+        // Reverses the byte order of every `component`-byte word of [data, data + n).
+        template <typename T>
+        void SwapBytes(T* data, const std::size_t n, const std::size_t component) {
+            if (component == 1) return;
+            ParallelForStatic(n, PageElements<T>(), [=](const std::size_t begin, const std::size_t end) {
+                unsigned char* bytes = reinterpret_cast<unsigned char*>(data + begin);
+                unsigned char* const last = reinterpret_cast<unsigned char*>(data + end);
+                for (; bytes < last; bytes += component) std::reverse(bytes, bytes + component);
+            });
+        }
+
+        // a.Resize(shape[0], ..., shape[rank - 1]) when A has such a Resize.
+        template <typename A, std::size_t... I>
+        auto ResizeTo(A& a, const ArrayShape& shape, std::index_sequence<I...>, int) -> decltype(a.Resize(shape[I]...), void()) {
+            a.Resize(shape[I]...);
+        }
+
+        template <typename A, std::size_t... I>
+        void ResizeTo(A&, const ArrayShape&, std::index_sequence<I...>, long) {
+            throw std::invalid_argument("Load: shape mismatch and the array cannot be resized");
+        }
+
+        template <typename A>
+        void ResizeTo(A& a, const ArrayShape& shape) {
+            switch (shape.size()) {
+                case 1: ResizeTo(a, shape, std::make_index_sequence<1>{}, 0); break;
+                case 2: ResizeTo(a, shape, std::make_index_sequence<2>{}, 0); break;
+                case 3: ResizeTo(a, shape, std::make_index_sequence<3>{}, 0); break;
+                case 4: ResizeTo(a, shape, std::make_index_sequence<4>{}, 0); break;
+                case 5: ResizeTo(a, shape, std::make_index_sequence<5>{}, 0); break;
+                default: ResizeTo(a, shape, std::make_index_sequence<6>{}, 0); break;
+            }
+        }
+
+        // Checks that the data described by `header` has the element type,
+        // rank and layout of `a`.
+        template <typename A>
+        void CheckHeader(const std::string& path, const ArrayFileHeader& header, const A& a) {
+            using T = typename A::value_type;
+            using Layout = typename A::layout_type;
+            if (header.kind != DType<T>::kind || header.item_size != sizeof(T)) {
+                throw std::invalid_argument("Load: element type of " + path + " does not match the array");
+            }
+            if (header.shape.size() != a.NumDimensions()) {
+                throw std::invalid_argument("Load: rank of " + path + " does not match the array");
+            }
+            if (header.shape.size() > 1 && header.column_major != Layout::kIsColumnMajor) {
+                throw std::invalid_argument("Load: layout of " + path + " does not match the array");
+            }
+        }
+
+        // Checks `header` against `a` and the file size, resizes `a` if needed
+        // and reads the elements into it, swapping their bytes if the file
+        // has the other byte order.
+        template <typename A>
+        void ReadArray(const FileHandle& file, const int flags, const ArrayFileHeader& header, A& a, const IoMode mode) {
+            using T = typename A::value_type;
+            CheckHeader(file.Path(), header, a);
+            struct stat st;
+            if (::fstat(file.Descriptor(), &st) != 0) file.Fail("Load: cannot stat");
+            if (static_cast<std::size_t>(st.st_size) < header.data_offset + header.Size() * sizeof(T)) {
+                throw std::runtime_error("Load: " + file.Path() + " is truncated");
+            }
+
+            if (a.Shape() != header.shape) {
+                ResizeTo(a, header.shape);
+            }
+            TransferArray<T>(file, flags, a, header.data_offset, mode, false);
+            if (header.little_endian != NativeLittleEndian()) {
+                if (a.IsContiguous()) {
+                    SwapBytes(a.Data(), a.Size(), DType<T>::component);
+                } else {
+                    for (std::size_t row = 0; row < a.NumRows(); ++row) {
+                        SwapBytes(a.Data() + row * a.Pitch(), a.RowLength(), DType<T>::component);
+                    }
+                }
+            }
+        }
+    }
+
+    // #######################
+    // Save / Load
+    // #######################
+    // Header of the array file at `path`, e.g. to allocate before loading or
+    // to map the data part.
+    inline ArrayFileHeader ReadHeader(const std::string& path) {
+        const detail::FileHandle file(path, O_RDONLY);
+        if (!file.IsOpen()) file.Fail("Load: cannot open");
+        return detail::ReadHeader(file);
+    }
+
+    // Writes `a` to `path` (replaced if it exists) in the array file format.
+    //     Save("u.bin", u);
+    template <typename T, typename Allocator, typename Layout>
+    void Save(const std::string& path, const ArrayBase<T, Allocator, Layout>& a, const IoMode mode = IoMode::Buffered) {
+        const int flags = O_WRONLY;
+        const detail::FileHandle file(path, flags | O_CREAT | O_TRUNC);
+        if (!file.IsOpen()) file.Fail("Save: cannot open");
+        detail::WriteHeader<T, Layout>(file, a.Shape());
+        if (::ftruncate(file.Descriptor(), static_cast<off_t>(kFileDataAlignment + a.Size() * sizeof(T))) != 0) {
+            file.Fail("Save: cannot extend");
+        }
+        detail::TransferArray<const T>(file, flags, a, kFileDataAlignment, mode, true);
+    }
+
+    // Reads the array file at `path` into `a`, straight into its storage (no
+    // intermediate buffer). `a` keeps its allocation when it already has the
+    // file's shape and is resized otherwise. The element type, rank and
+    // layout must match the file (rank-1 files load in either layout); data
+    // of the other byte order is swapped in place.
+    //     Array3D<double> u(nx, ny, nz);
+    //     Load("u.bin", u);
+    //     auto v = Load<Array3D<double>>("v.bin");
+    template <typename A>
+    void Load(const std::string& path, A& a, const IoMode mode = IoMode::Buffered) {
+        const int flags = O_RDONLY;
+        const detail::FileHandle file(path, flags);
+        if (!file.IsOpen()) file.Fail("Load: cannot open");
+        detail::ReadArray(file, flags, detail::ReadHeader(file), a, mode);
+    }
+
+    template <typename A>
+    A Load(const std::string& path, const IoMode mode = IoMode::Buffered) {
+        A a;
+        Load(path, a, mode);
+        return a;
+    }
+}
+
+#endif /* IO_HPP_ */
@@ -0,0 +1,124 @@
+#ifndef LAYOUT_HPP_
+#define LAYOUT_HPP_
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace array {
+
+    // #######################
+    // Layout policies
+    // #######################
+    // Order of the elements of a dense array in memory. RowMajor (C order):
+    // the last index is contiguous. ColumnMajor (Fortran order): the first
+    // index is contiguous, so Data() of an Array2D<T, Allocator, ColumnMajor>
+    // can be handed to LAPACK-style routines with leading dimension Dim1().
+    struct RowMajor {
+        static constexpr bool kIsColumnMajor = false;
+    };
+
+    struct ColumnMajor {
+        static constexpr bool kIsColumnMajor = true;
+    };
+
+    // Axis with unit stride in a `Rank`-dimensional `Layout` array.
+    template <typename Layout, std::size_t Rank>
+    constexpr std::size_t InnermostAxis() noexcept {
+        return Layout::kIsColumnMajor ? 0 : Rank - 1;
+    }
+
+    // Element strides of a dense `Layout` array of extents `shape`.
+    template <typename Layout, std::size_t Rank>
+    inline std::array<std::size_t, Rank> LayoutStrides(const std::array<std::size_t, Rank>& shape) noexcept {
+        std::array<std::size_t, Rank> strides;
+        std::size_t stride = 1;
+        if constexpr (Layout::kIsColumnMajor) {
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                strides[axis] = stride;
+                stride *= shape[axis];
+            }
+        } else {
+            for (std::size_t axis = Rank; axis-- > 0;) {
+                strides[axis] = stride;
+                stride *= shape[axis];
+            }
+        }
+        return strides;
+    }
+
+    // Element strides of a `Layout` array of extents `shape` whose rows along
+    // the innermost axis start `pitch` elements apart (pitch >= that extent).
+    template <typename Layout, std::size_t Rank>
+    inline std::array<std::size_t, Rank> LayoutStrides(std::array<std::size_t, Rank> shape, const std::size_t pitch) noexcept {
+        shape[InnermostAxis<Layout, Rank>()] = pitch;
+        return LayoutStrides<Layout, Rank>(shape);
+    }
+
+    // #######################
+    // Padding
+    // #######################
+    // Padding of the rows along the innermost axis of an Array2D/Array3D: the
+    // pitch, the distance in elements between the starts of consecutive rows,
+    // may exceed the row length. When the row stride is a multiple of a large
+    // power of two (1024 or 2048 doubles wide grids), all elements of a column
+    // map to the same few cache sets and sweeps across rows thrash the caches.
+    class Padding {
+    public:
+        // Rows of at least this many bytes are padded by Auto().
+        static constexpr std::size_t kAutoMinRowBytes = 256;
+        static constexpr std::size_t kCacheLineBytes = 64;
+
+        constexpr Padding() noexcept : pitch_(0) { }
+
+        // Dense rows (the default).
+        static constexpr Padding None() noexcept { return Padding(0); }
+
+        // Rows of kAutoMinRowBytes or more start on a cache line and span an
+        // odd number of cache lines, so a column walks through every cache
+        // set. Shorter rows, and element types that do not divide a cache
+        // line, stay dense.
+        static constexpr Padding Auto() noexcept { return Padding(kAuto); }
+
+        // Rows start `pitch` elements apart; rows longer than that are dense.
+        static constexpr Padding Pitch(const std::size_t pitch) noexcept { return Padding(pitch == kAuto ? kAuto - 1 : pitch); }
+
+        constexpr bool IsNone() const noexcept { return pitch_ == 0; }
+        constexpr bool IsAuto() const noexcept { return pitch_ == kAuto; }
+
+        // Pitch of rows of `length` elements of type T.
+        template <typename T>
+        constexpr std::size_t PitchFor(const std::size_t length) const noexcept {
+            if (pitch_ == kAuto) {
+                if (kCacheLineBytes % sizeof(T) != 0 || length * sizeof(T) < kAutoMinRowBytes) return length;
+                std::size_t lines = (length * sizeof(T) + kCacheLineBytes - 1) / kCacheLineBytes;
+                lines |= 1;
+                return lines * (kCacheLineBytes / sizeof(T));
+            }
+            return pitch_ > length ? pitch_ : length;
+        }
+
+        constexpr bool operator==(const Padding& other) const noexcept { return pitch_ == other.pitch_; }
+        constexpr bool operator!=(const Padding& other) const noexcept { return pitch_ != other.pitch_; }
+
+    private:
+        static constexpr std::size_t kAuto = ~std::size_t(0);
+
+        explicit constexpr Padding(const std::size_t pitch) noexcept : pitch_(pitch) { }
+
+        std::size_t pitch_;
+    };
+
+    // Layout of an array type; RowMajor for views and anything without a layout_type.
+    template <typename A, typename = void>
+    struct LayoutOf {
+        using type = RowMajor;
+    };
+
+    template <typename A>
+    struct LayoutOf<A, std::void_t<typename A::layout_type>> {
+        using type = typename A::layout_type;
+    };
+}
+
+#endif /* LAYOUT_HPP_ */
@@ -0,0 +1,231 @@
+#ifndef LOOP_HPP_
+#define LOOP_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "array_view.hpp"
+#include "layout.hpp"
+#include "parallel.hpp"
+
+namespace array {
+
+    // Loops with fewer iterations than this run on the calling thread.
+    constexpr std::size_t kParallelLoopThreshold = std::size_t(1) << 15;
+
+    // #######################
+    // IndexRange
+    // #######################
+    // Box [begin, end) of `Rank`-dimensional indices.
+    template <std::size_t Rank>
+    class IndexRange {
+        static_assert(Rank >= 1, "IndexRange: rank must be at least 1");
+
+    public:
+        using index_array = std::array<std::size_t, Rank>;
+
+        IndexRange() noexcept : begin_{}, end_{} { }
+
+        explicit IndexRange(const index_array& end) noexcept : begin_{}, end_(end) { }
+
+        IndexRange(const index_array& begin, const index_array& end) noexcept : begin_(begin), end_(end) { }
+
+        static constexpr std::size_t NumDimensions() noexcept { return Rank; }
+
+        inline const index_array& Begin() const noexcept { return begin_; }
+        inline const index_array& End() const noexcept { return end_; }
+        inline std::size_t Begin(const std::size_t axis) const noexcept { return begin_[axis]; }
+        inline std::size_t End(const std::size_t axis) const noexcept { return end_[axis]; }
+        inline std::size_t Extent(const std::size_t axis) const noexcept { return end_[axis] > begin_[axis] ? end_[axis] - begin_[axis] : 0; }
+
+        inline std::size_t Size() const noexcept {
+            std::size_t size = 1;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                size *= Extent(axis);
+            }
+            return size;
+        }
+
+        inline bool IsEmpty() const noexcept { return Size() == 0; }
+
+    private:
+        index_array begin_;
+        index_array end_;
+    };
+
+    template <typename T, std::size_t Rank>
+    inline IndexRange<Rank> RangeOf(const ArrayView<T, Rank>& view) noexcept {
+        return IndexRange<Rank>(view.Shape());
+    }
+
+    // Full index range of an Array1D..Array6D.
+    template <typename A>
+    inline auto RangeOf(const A& array) -> decltype(RangeOf(array.View())) {
+        return RangeOf(array.View());
+    }
+
+    // Default tile: whole rows along the innermost axis (the contiguous,
+    // vectorizable one: the last for RowMajor, the first for ColumnMajor),
+    // 16 rows of the axis next to it, 1 along the others.
+    template <std::size_t Rank, typename Layout = RowMajor>
+    inline std::array<std::size_t, Rank> DefaultTile() noexcept {
+        std::array<std::size_t, Rank> tile;
+        tile.fill(1);
+        if constexpr (Layout::kIsColumnMajor) {
+            tile[0] = 0;
+            if constexpr (Rank >= 2) {
+                tile[1] = 16;
+            }
+        } else {
+            tile[Rank - 1] = 0;
+            if constexpr (Rank >= 2) {
+                tile[Rank - 2] = 16;
+            }
+        }
+        return tile;
+    }
+
+    namespace detail {
+
+        struct alignas(64) TileCounter {
+            std::atomic<std::size_t> next;
+            std::size_t end;
+        };
+
+        // Tile number `index`, tiles being numbered in the storage order of Layout.
+        template <typename Layout, std::size_t Rank>
+        IndexRange<Rank> TileAt(const IndexRange<Rank>& range, const std::array<std::size_t, Rank>& tile,
+                                const std::array<std::size_t, Rank>& counts, std::size_t index) {
+            std::array<std::size_t, Rank> begin, end;
+            for (std::size_t k = 0; k < Rank; ++k) {
+                const std::size_t axis = Layout::kIsColumnMajor ? k : Rank - 1 - k;
+                const std::size_t t = index % counts[axis];
+                index /= counts[axis];
+                begin[axis] = range.Begin(axis) + t * tile[axis];
+                end[axis] = std::min(range.End(axis), begin[axis] + tile[axis]);
+            }
+            return IndexRange<Rank>(begin, end);
+        }
+
+        template <std::size_t Axis, std::size_t Rank, typename F, typename... Indices>
+        inline void TileLoop(const IndexRange<Rank>& tile, F& f, const Indices... outer) {
+            const std::size_t begin = tile.Begin(Axis);
+            const std::size_t end = tile.End(Axis);
+            if constexpr (Axis + 1 == Rank) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    f(outer..., i);
+                }
+            } else {
+                for (std::size_t i = begin; i < end; ++i) {
+                    TileLoop<Axis + 1>(tile, f, outer..., i);
+                }
+            }
+        }
+
+        // Same with the first axis innermost; `Remaining` axes are still to be looped.
+        template <std::size_t Remaining, std::size_t Rank, typename F, typename... Indices>
+        inline void TileLoopColumnMajor(const IndexRange<Rank>& tile, F& f, const Indices... inner) {
+            const std::size_t begin = tile.Begin(Remaining - 1);
+            const std::size_t end = tile.End(Remaining - 1);
+            if constexpr (Remaining == 1) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    f(i, inner...);
+                }
+            } else {
+                for (std::size_t i = begin; i < end; ++i) {
+                    TileLoopColumnMajor<Remaining - 1>(tile, f, i, inner...);
+                }
+            }
+        }
+    }
+
+    // #######################
+    // ParallelForTiles
+    // #######################
+    // Cuts `range` into tiles of extent `tile` (0 = whole axis) and calls
+    // f(tile_range) once per tile on ThreadPool::Global(). Each thread starts
+    // on its own contiguous block of tiles, which keeps the page placement of
+    // ParallelForStatic/FirstTouchAllocator, and once its block is exhausted
+    // steals the remaining tiles of the other threads one at a time. Tiles are
+    // numbered in the storage order of Layout.
+    template <typename Layout = RowMajor, std::size_t Rank, typename F>
+    void ParallelForTiles(const IndexRange<Rank>& range, std::array<std::size_t, Rank> tile, F&& f) {
+        if (range.IsEmpty()) return;
+
+        std::array<std::size_t, Rank> counts;
+        std::size_t num_tiles = 1;
+        for (std::size_t axis = 0; axis < Rank; ++axis) {
+            if (tile[axis] == 0 || tile[axis] > range.Extent(axis)) tile[axis] = range.Extent(axis);
+            counts[axis] = (range.Extent(axis) + tile[axis] - 1) / tile[axis];
+            num_tiles *= counts[axis];
+        }
+
+        ThreadPool& pool = ThreadPool::Global();
+        if (range.Size() < kParallelLoopThreshold || pool.NumThreads() == 1 || num_tiles == 1) {
+            for (std::size_t t = 0; t < num_tiles; ++t) {
+                f(detail::TileAt<Layout>(range, tile, counts, t));
+            }
+            return;
+        }
+
+        std::vector<detail::TileCounter> counters(pool.NumThreads());
+        for (std::size_t t = 0; t < counters.size(); ++t) {
+            std::size_t begin, end;
+            StaticChunk(num_tiles, 1, t, counters.size(), begin, end);
+            counters[t].next.store(begin, std::memory_order_relaxed);
+            counters[t].end = end;
+        }
+
+        // Run() may call f(0, 1) alone (nested, or under a SerialScope): every
+        // thread walks all the counters, not just `num_threads` of them.
+        pool.Run([&](const std::size_t index, std::size_t) {
+            for (std::size_t k = 0; k < counters.size(); ++k) {
+                detail::TileCounter& counter = counters[(index + k) % counters.size()];
+                for (;;) {
+                    const std::size_t t = counter.next.fetch_add(1, std::memory_order_relaxed);
+                    if (t >= counter.end) break;
+                    f(detail::TileAt<Layout>(range, tile, counts, t));
+                }
+            }
+        });
+    }
+
+    template <typename Layout = RowMajor, std::size_t Rank, typename F>
+    inline void ParallelForTiles(const IndexRange<Rank>& range, F&& f) {
+        ParallelForTiles<Layout>(range, DefaultTile<Rank, Layout>(), f);
+    }
+
+    // #######################
+    // ParallelFor / ForEachIndex
+    // #######################
+    // Calls f(i, j, ...) for every index of `range`, tiled as ParallelForTiles.
+    // The innermost axis (the last, or the first for ColumnMajor) is a plain
+    // counted loop over f, so an inlined f on contiguous data is vectorized by
+    // the compiler. f must be safe to call concurrently for different indices.
+    template <typename Layout = RowMajor, std::size_t Rank, typename F>
+    void ParallelFor(const IndexRange<Rank>& range, const std::array<std::size_t, Rank>& tile, F&& f) {
+        ParallelForTiles<Layout>(range, tile, [&f](const IndexRange<Rank>& sub) {
+            if constexpr (Layout::kIsColumnMajor) {
+                detail::TileLoopColumnMajor<Rank>(sub, f);
+            } else {
+                detail::TileLoop<0>(sub, f);
+            }
+        });
+    }
+
+    template <typename Layout = RowMajor, std::size_t Rank, typename F>
+    inline void ParallelFor(const IndexRange<Rank>& range, F&& f) {
+        ParallelFor<Layout>(range, DefaultTile<Rank, Layout>(), f);
+    }
+
+    // ParallelFor over all indices of an array or view, in the array's layout order, e.g.
+    //     ForEachIndex(c, [&](std::size_t i, std::size_t j, std::size_t k) { c(i, j, k) = a(i, j, k) + b(i, j, k); });
+    template <typename A, typename F>
+    inline void ForEachIndex(const A& array, F&& f) {
+        ParallelFor<typename LayoutOf<A>::type>(RangeOf(array), f);
+    }
+}
+
+#endif /* LOOP_HPP_ */
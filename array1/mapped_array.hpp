@@ -0,0 +1,342 @@
+#ifndef MAPPED_ARRAY_HPP_
+#define MAPPED_ARRAY_HPP_
+
+#include <cerrno>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "allocator.hpp"
+#include "array1d.hpp"
+#include "array2d.hpp"
+#include "array3d.hpp"
+#include "array4d.hpp"
+#include "array5d.hpp"
+#include "array6d.hpp"
+#include "layout.hpp"
+#include "shape.hpp"
+
+namespace array {
+
+    // How a file is mapped:
+    //     ReadOnly     pages are mapped read-only; writing to the array faults.
+    //     ReadWrite    writes go to the file (created, and grown, as needed).
+    //     CopyOnWrite  writes stay private to the process; the file is unchanged.
+    enum class MapMode {
+        ReadOnly,
+        ReadWrite,
+        CopyOnWrite
+    };
+
+    // Access pattern hint passed to madvise for the mapped pages.
+    enum class MapAdvice {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed
+    };
+
+    namespace detail {
+
+        inline int MadviseFlag(const MapAdvice advice) noexcept {
+            switch (advice) {
+                case MapAdvice::Sequential: return MADV_SEQUENTIAL;
+                case MapAdvice::Random: return MADV_RANDOM;
+                case MapAdvice::WillNeed: return MADV_WILLNEED;
+                default: return MADV_NORMAL;
+            }
+        }
+
+        // Open file descriptor shared by the copies of one MappedAllocator. Each
+        // Map() maps the bytes [offset, offset + bytes) of the file; the mapping
+        // starts on the page boundary below offset and the returned pointer is
+        // moved forward by the difference.
+        class MappedFile {
+        public:
+            MappedFile(const std::string& path, const MapMode mode, const MapAdvice advice, const std::size_t offset)
+            : path_(path), mode_(mode), advice_(advice), offset_(offset), fd_(-1) {
+                fd_ = ::open(path.c_str(), mode == MapMode::ReadWrite ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+                if (fd_ < 0) {
+                    throw std::system_error(errno, std::generic_category(), "MappedArray: cannot open " + path);
+                }
+            }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            ~MappedFile() {
+                ::close(fd_);
+            }
+
+            inline const std::string& Path() const noexcept { return path_; }
+            inline MapMode Mode() const noexcept { return mode_; }
+            inline MapAdvice Advice() const noexcept { return advice_; }
+            inline std::size_t Offset() const noexcept { return offset_; }
+
+            void* Map(const std::size_t bytes) {
+                struct stat st;
+                if (::fstat(fd_, &st) != 0) {
+                    throw std::system_error(errno, std::generic_category(), "MappedArray: cannot stat " + path_);
+                }
+                const std::size_t end = offset_ + bytes;
+                if (static_cast<std::size_t>(st.st_size) < end) {
+                    if (mode_ != MapMode::ReadWrite) {
+                        throw std::invalid_argument("MappedArray: " + path_ + " is smaller than the requested shape");
+                    }
+                    if (::ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+                        throw std::system_error(errno, std::generic_category(), "MappedArray: cannot extend " + path_);
+                    }
+                }
+                const std::size_t lead = Lead();
+                const int prot = mode_ == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+                const int flags = mode_ == MapMode::CopyOnWrite ? MAP_PRIVATE : MAP_SHARED;
+                void* base = ::mmap(nullptr, lead + bytes, prot, flags, fd_, static_cast<off_t>(offset_ - lead));
+                if (base == MAP_FAILED) {
+                    throw std::system_error(errno, std::generic_category(), "MappedArray: cannot map " + path_);
+                }
+                if (advice_ != MapAdvice::Normal) {
+                    ::madvise(base, lead + bytes, MadviseFlag(advice_));
+                }
+                return static_cast<unsigned char*>(base) + lead;
+            }
+
+            void Unmap(void* ptr, const std::size_t bytes) noexcept {
+                const std::size_t lead = Lead();
+                ::munmap(static_cast<unsigned char*>(ptr) - lead, lead + bytes);
+            }
+
+            // Applies `advice` to the pages holding [ptr, ptr + bytes).
+            void Advise(void* ptr, const std::size_t bytes, const MapAdvice advice) {
+                advice_ = advice;
+                void* base = PageBase(ptr);
+                ::madvise(base, static_cast<unsigned char*>(ptr) + bytes - static_cast<unsigned char*>(base), MadviseFlag(advice));
+            }
+
+            // Writes the dirty pages of [ptr, ptr + bytes) back to the file.
+            void Flush(void* ptr, const std::size_t bytes) {
+                if (mode_ != MapMode::ReadWrite || bytes == 0) return;
+                void* base = PageBase(ptr);
+                if (::msync(base, static_cast<unsigned char*>(ptr) + bytes - static_cast<unsigned char*>(base), MS_SYNC) != 0) {
+                    throw std::system_error(errno, std::generic_category(), "MappedArray: cannot flush " + path_);
+                }
+            }
+
+        private:
+            std::string path_;
+            MapMode mode_;
+            MapAdvice advice_;
+            std::size_t offset_;
+            int fd_;
+
+            static std::size_t PageBytes() noexcept {
+                static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+                return page;
+            }
+
+            inline std::size_t Lead() const noexcept { return offset_ % PageBytes(); }
+
+            static void* PageBase(void* ptr) noexcept {
+                const std::size_t address = reinterpret_cast<std::size_t>(ptr);
+                return reinterpret_cast<void*>(address - address % PageBytes());
+            }
+        };
+    }
+
+    // #######################
+    // MappedAllocator
+    // #######################
+    // Allocator that maps a file region instead of allocating memory, so an
+    // array of this allocator is backed by the file (see MappedArray). A
+    // default-constructed MappedAllocator, e.g. the one of a copy or of
+    // Flatten(), is not bound to a file and allocates like AlignedAllocator.
+    // Mapped storage is only guaranteed alignof(T), since the file offset
+    // need not be a multiple of the cache line.
+    template <typename T>
+    class MappedAllocator {
+        static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                      "MappedAllocator: element type must be trivially copyable");
+
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+
+        template <typename U>
+        struct rebind {
+            using other = MappedAllocator<U>;
+        };
+
+        MappedAllocator() noexcept = default;
+
+        explicit MappedAllocator(std::shared_ptr<detail::MappedFile> file) noexcept : file_(std::move(file)) { }
+
+        template <typename U>
+        MappedAllocator(const MappedAllocator<U>& other) noexcept : file_(other.File()) { }
+
+        T* allocate(const std::size_t n) {
+            if (!file_) {
+                return AlignedAllocator<T>().allocate(n);
+            }
+            if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                throw std::bad_array_new_length();
+            }
+            return static_cast<T*>(file_->Map(n * sizeof(T)));
+        }
+
+        void deallocate(T* p, const std::size_t n) noexcept {
+            if (!file_) {
+                AlignedAllocator<T>().deallocate(p, n);
+            } else {
+                file_->Unmap(p, n * sizeof(T));
+            }
+        }
+
+        // File the storage is mapped from, or nullptr.
+        inline const std::shared_ptr<detail::MappedFile>& File() const noexcept { return file_; }
+
+    private:
+        std::shared_ptr<detail::MappedFile> file_;
+    };
+
+    template <typename T, typename U>
+    inline bool operator==(const MappedAllocator<T>& lhs, const MappedAllocator<U>& rhs) noexcept {
+        return lhs.File() == rhs.File();
+    }
+
+    template <typename T, typename U>
+    inline bool operator!=(const MappedAllocator<T>& lhs, const MappedAllocator<U>& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    // #######################
+    // MappedArray
+    // #######################
+    // Array1D..Array6D (A, with MappedAllocator) whose elements live in a file
+    // mapped into memory: opening is O(1) whatever the file size and the OS
+    // pages in only what is touched. The file holds the elements in the
+    // storage order of A's layout, without padding, starting at byte `offset`.
+    //     MappedArray3D<double> u("u.bin", {nx, ny, nz});                        // read-only
+    //     MappedArray3D<double> v("v.bin", {nx, ny, nz}, MapMode::ReadWrite);    // created if missing
+    //     v = 0.5 * u;
+    //     v.Flush();
+    // Every operation of A but Reserve, ShrinkToFit and SetPadding is
+    // available; in ReadOnly mode the array must only be read. Resize() remaps the file (growing it in ReadWrite mode). A
+    // MappedArray cannot be copied; load it into memory with Copy(), e.g.
+    //     Array3D<double> w;
+    //     w.ResizeLike(u);
+    //     w.Copy(u);
+    template <typename A>
+    class MappedArray : public A {
+        using T = typename A::value_type;
+        using Base = ArrayBase<T, typename A::allocator_type, typename A::layout_type>;
+        static_assert(std::is_same<typename A::allocator_type, MappedAllocator<T>>::value,
+                      "MappedArray: the array type must use MappedAllocator");
+
+    public:
+        MappedArray() = default;
+
+        MappedArray(const std::string& path, std::initializer_list<std::size_t> shape, const MapMode mode = MapMode::ReadOnly,
+                    const MapAdvice advice = MapAdvice::Normal, const std::size_t offset = 0)
+        : MappedArray(path, ArrayShape(shape), mode, advice, offset) { }
+
+        MappedArray(const std::string& path, const ArrayShape& shape, const MapMode mode = MapMode::ReadOnly,
+                    const MapAdvice advice = MapAdvice::Normal, const std::size_t offset = 0) {
+            if (shape.size() != this->NumDimensions()) {
+                throw std::invalid_argument("MappedArray: shape rank mismatch");
+            }
+            if (offset % alignof(T) != 0) {
+                throw std::invalid_argument("MappedArray: offset is not a multiple of the element alignment");
+            }
+            this->allocator_ = MappedAllocator<T>(std::make_shared<detail::MappedFile>(path, mode, advice, offset));
+            Base::Resize(shape);
+        }
+
+        MappedArray(const MappedArray&) = delete;
+        MappedArray& operator=(const MappedArray&) = delete;
+
+        MappedArray(MappedArray&&) noexcept = default;
+        MappedArray& operator=(MappedArray&&) noexcept = default;
+
+        using A::operator=;
+
+        inline bool IsMapped() const noexcept { return this->allocator_.File() != nullptr; }
+
+        const std::string& Path() const { return File().Path(); }
+        MapMode Mode() const { return File().Mode(); }
+        std::size_t FileOffset() const { return File().Offset(); }
+
+        // Changes the access pattern hint for the whole array, or for the
+        // elements [first, first + count) of Data(), e.g. MapAdvice::WillNeed
+        // on the slab a kernel is about to read.
+        void Advise(const MapAdvice advice) {
+            Advise(advice, 0, this->StorageSize());
+        }
+
+        void Advise(const MapAdvice advice, const std::size_t first, const std::size_t count) {
+            if (first + count > this->StorageSize()) {
+                throw std::invalid_argument("MappedArray::Advise: range out of bounds");
+            }
+            if (this->IsAllocated() && count > 0) {
+                File().Advise(this->ptr_raw_data_ + first, count * sizeof(T), advice);
+            }
+        }
+
+        // Writes modified pages back to the file and waits for the write
+        // (ReadWrite mode; otherwise a no-op). The OS also writes them back
+        // on its own and when the array is destroyed.
+        void Flush() {
+            if (this->IsAllocated()) {
+                File().Flush(this->ptr_raw_data_, this->StorageSize() * sizeof(T));
+            }
+        }
+
+        // The file layout has no row padding.
+        void SetPadding(Padding) = delete;
+
+        // The mapping is sized by Shape(): spare capacity would map the file
+        // again and move the elements into it (a write, which faults on a
+        // ReadOnly mapping) for nothing.
+        void Reserve(std::size_t) = delete;
+        void ShrinkToFit() = delete;
+
+    private:
+        detail::MappedFile& File() const {
+            if (!IsMapped()) {
+                throw std::logic_error("MappedArray: not mapped to a file");
+            }
+            return *this->allocator_.File();
+        }
+    };
+
+    template <typename T>
+    using MappedArray1D = MappedArray<Array1D<T, MappedAllocator<T>>>;
+
+    template <typename T, typename Layout = RowMajor>
+    using MappedArray2D = MappedArray<Array2D<T, MappedAllocator<T>, Layout>>;
+
+    template <typename T, typename Layout = RowMajor>
+    using MappedArray3D = MappedArray<Array3D<T, MappedAllocator<T>, Layout>>;
+
+    template <typename T, typename Layout = RowMajor>
+    using MappedArray4D = MappedArray<Array4D<T, MappedAllocator<T>, Layout>>;
+
+    template <typename T, typename Layout = RowMajor>
+    using MappedArray5D = MappedArray<Array5D<T, MappedAllocator<T>, Layout>>;
+
+    template <typename T, typename Layout = RowMajor>
+    using MappedArray6D = MappedArray<Array6D<T, MappedAllocator<T>, Layout>>;
+}
+
+#endif /* MAPPED_ARRAY_HPP_ */
@@ -0,0 +1,250 @@
+#ifndef MATMUL_HPP_
+#define MATMUL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "allocator.hpp"
+#include "array_view.hpp"
+#include "array2d.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace array {
+
+    namespace detail {
+
+        // Cache blocking of the GEMM loops: a kGemmKC x kGemmNC panel of B
+        // (4 MiB for double) is shared through L3, each thread packs a
+        // kGemmMC x kGemmKC block of A (192 KiB) that stays in L2, and the
+        // micro-kernel streams one kGemmKC x nr sliver of B from L1.
+        // kGemmMC is a multiple of every micro-kernel mr (4, 6, 12) and
+        // kGemmNC of every nr (8, 16, 32).
+        constexpr std::size_t kGemmMC = 96;
+        constexpr std::size_t kGemmKC = 256;
+        constexpr std::size_t kGemmNC = 2048;
+
+        // Packs the mc x kc block at `a` (element (i, p) at a[i * rs + p * cs])
+        // into slivers of mr rows, each stored column by column:
+        // packed[(i / mr) * mr * kc + p * mr + i % mr]. Rows past mc are zero.
+        template <typename T>
+        void PackA(const T* a, const std::size_t rs, const std::size_t cs, const std::size_t mc, const std::size_t kc,
+                   const std::size_t mr, T* packed) {
+            for (std::size_t i0 = 0; i0 < mc; i0 += mr) {
+                const std::size_t rows = std::min(mr, mc - i0);
+                for (std::size_t p = 0; p < kc; ++p) {
+                    const T* src = a + i0 * rs + p * cs;
+                    for (std::size_t i = 0; i < rows; ++i) {
+                        packed[i] = src[i * rs];
+                    }
+                    for (std::size_t i = rows; i < mr; ++i) {
+                        packed[i] = T(0);
+                    }
+                    packed += mr;
+                }
+            }
+        }
+
+        // Packs slivers [s0, s1) of nr columns of the kc x nc block at `b`
+        // (element (p, j) at b[p * rs + j * cs]), each stored row by row:
+        // packed[(j / nr) * nr * kc + p * nr + j % nr]. Columns past nc are zero.
+        template <typename T>
+        void PackB(const T* b, const std::size_t rs, const std::size_t cs, const std::size_t kc, const std::size_t nc,
+                   const std::size_t nr, const std::size_t s0, const std::size_t s1, T* packed) {
+            for (std::size_t s = s0; s < s1; ++s) {
+                const std::size_t j0 = s * nr;
+                const std::size_t cols = std::min(nr, nc - j0);
+                T* dst = packed + s * nr * kc;
+                for (std::size_t p = 0; p < kc; ++p) {
+                    const T* src = b + p * rs + j0 * cs;
+                    if (cs == 1) {
+                        std::copy(src, src + cols, dst);
+                    } else {
+                        for (std::size_t j = 0; j < cols; ++j) {
+                            dst[j] = src[j * cs];
+                        }
+                    }
+                    for (std::size_t j = cols; j < nr; ++j) {
+                        dst[j] = T(0);
+                    }
+                    dst += nr;
+                }
+            }
+        }
+
+        // c = alpha * ab + beta * c on the m x n corner of a micro-tile (ab has
+        // row length nr). c is not read when beta is zero.
+        template <typename T>
+        void UpdateTile(const T* ab, const std::size_t nr, const std::size_t m, const std::size_t n, const T alpha, const T beta,
+                        T* c, const std::size_t rs, const std::size_t cs) {
+            for (std::size_t i = 0; i < m; ++i) {
+                const T* src = ab + i * nr;
+                T* dst = c + i * rs;
+                if (beta == T(0)) {
+                    if (cs == 1) {
+                        for (std::size_t j = 0; j < n; ++j) dst[j] = alpha * src[j];
+                    } else {
+                        for (std::size_t j = 0; j < n; ++j) dst[j * cs] = alpha * src[j];
+                    }
+                } else {
+                    if (cs == 1) {
+                        for (std::size_t j = 0; j < n; ++j) dst[j] = alpha * src[j] + beta * dst[j];
+                    } else {
+                        for (std::size_t j = 0; j < n; ++j) dst[j * cs] = alpha * src[j] + beta * dst[j * cs];
+                    }
+                }
+            }
+        }
+
+        // c = beta * c (zero when beta is zero, whatever c holds).
+        template <typename T>
+        void ScaleMatrix(const ArrayView<T, 2>& c, const T beta) {
+            for (std::size_t i = 0; i < c.Dim(0); ++i) {
+                for (std::size_t j = 0; j < c.Dim(1); ++j) {
+                    T& x = c.Data()[i * c.Stride(0) + j * c.Stride(1)];
+                    x = beta == T(0) ? T(0) : beta * x;
+                }
+            }
+        }
+
+        // c = alpha * a * b + beta * c on views of any strides; c must not
+        // overlap a or b. Loop nest of the Goto/BLIS scheme:
+        //     jc (kGemmNC columns) > pc (kGemmKC depth, B panel packed once)
+        //     > ic (mc rows, A block packed per thread) > jr (nr) > ir (mr).
+        // The (ic, jr range) blocks of each panel are handed out to the threads
+        // of ThreadPool::Global() dynamically. When m alone gives too few
+        // blocks, mc is shrunk and the columns of the panel are split as well.
+        template <typename T>
+        void Gemm(const ArrayView<const T, 2>& a, const ArrayView<const T, 2>& b, const ArrayView<T, 2>& c,
+                  const T alpha, const T beta) {
+            const std::size_t m = a.Dim(0);
+            const std::size_t k = a.Dim(1);
+            const std::size_t n = b.Dim(1);
+            if (m == 0 || n == 0) return;
+            if (k == 0 || alpha == T(0)) {
+                ScaleMatrix(c, beta);
+                return;
+            }
+
+            const simd::GemmKernel<T> kernel = simd::SelectGemmKernel<T>();
+            const std::size_t mr = kernel.mr;
+            const std::size_t nr = kernel.nr;
+
+            ThreadPool& pool = ThreadPool::Global();
+            const bool parallel = m * n * k >= kParallelThreshold && pool.NumThreads() > 1;
+            const std::size_t num_threads = parallel ? pool.NumThreads() : 1;
+
+            const std::size_t rows_per_thread = (m + num_threads - 1) / num_threads;
+            const std::size_t mc = std::min(kGemmMC, (rows_per_thread + mr - 1) / mr * mr);
+            const std::size_t m_blocks = (m + mc - 1) / mc;
+
+            std::vector<T, AlignedAllocator<T>> packed_b(kGemmKC * std::min(kGemmNC, (n + nr - 1) / nr * nr));
+            std::vector<std::vector<T, AlignedAllocator<T>>> packed_a(num_threads);
+
+            const std::size_t a_rs = a.Stride(0), a_cs = a.Stride(1);
+            const std::size_t b_rs = b.Stride(0), b_cs = b.Stride(1);
+            const std::size_t c_rs = c.Stride(0), c_cs = c.Stride(1);
+
+            for (std::size_t jc = 0; jc < n; jc += kGemmNC) {
+                const std::size_t nc = std::min(kGemmNC, n - jc);
+                const std::size_t slivers = (nc + nr - 1) / nr;
+                const std::size_t n_splits = m_blocks >= num_threads ? 1 : std::min(slivers, num_threads / m_blocks);
+                const std::size_t num_units = m_blocks * n_splits;
+
+                for (std::size_t pc = 0; pc < k; pc += kGemmKC) {
+                    const std::size_t kc = std::min(kGemmKC, k - pc);
+                    const T beta_p = pc == 0 ? beta : T(1);
+                    const T* b_block = b.Data() + pc * b_rs + jc * b_cs;
+
+                    if (parallel) {
+                        pool.Run([&](const std::size_t index, const std::size_t count) {
+                            std::size_t s0, s1;
+                            StaticChunk(slivers, 1, index, count, s0, s1);
+                            PackB(b_block, b_rs, b_cs, kc, nc, nr, s0, s1, packed_b.data());
+                        });
+                    } else {
+                        PackB(b_block, b_rs, b_cs, kc, nc, nr, 0, slivers, packed_b.data());
+                    }
+
+                    std::atomic<std::size_t> next_unit(0);
+                    auto work = [&](const std::size_t index, std::size_t) {
+                        std::vector<T, AlignedAllocator<T>>& buffer = packed_a[index];
+                        buffer.resize(mc * kGemmKC);
+                        alignas(kDefaultAlignment) T ab[simd::kGemmMaxTile];
+                        for (;;) {
+                            const std::size_t unit = next_unit.fetch_add(1, std::memory_order_relaxed);
+                            if (unit >= num_units) return;
+                            const std::size_t ic = (unit / n_splits) * mc;
+                            const std::size_t mcb = std::min(mc, m - ic);
+                            PackA(a.Data() + ic * a_rs + pc * a_cs, a_rs, a_cs, mcb, kc, mr, buffer.data());
+
+                            std::size_t s0, s1;
+                            StaticChunk(slivers, 1, unit % n_splits, n_splits, s0, s1);
+                            for (std::size_t s = s0; s < s1; ++s) {
+                                const std::size_t jr = s * nr;
+                                const T* pb = packed_b.data() + s * nr * kc;
+                                for (std::size_t ir = 0; ir < mcb; ir += mr) {
+                                    kernel.run(kc, buffer.data() + ir * kc, pb, ab);
+                                    UpdateTile(ab, nr, std::min(mr, mcb - ir), std::min(nr, nc - jr), alpha, beta_p,
+                                               c.Data() + (ic + ir) * c_rs + (jc + jr) * c_cs, c_rs, c_cs);
+                                }
+                            }
+                        }
+                    };
+                    if (parallel) {
+                        pool.Run(work);
+                    } else {
+                        work(0, 1);
+                    }
+                }
+            }
+        }
+    }
+
+    // #######################
+    // MatMul
+    // #######################
+    // c = alpha * a * b + beta * c for an m x k matrix a and a k x n matrix b,
+    // with any mix of RowMajor and ColumnMajor operands. With beta == 0 (the
+    // default) c is resized to m x n and its old contents are never read;
+    // otherwise it must already be m x n. c may be a or b itself, in which
+    // case the product goes through a temporary.
+    //     Array2D<double> c;
+    //     MatMul(a, b, c);             // c = a * b
+    //     MatMul(a, b, c, 0.5, 1.0);   // c += 0.5 * a * b
+    template <typename T, typename AllocatorA, typename LayoutA, typename AllocatorB, typename LayoutB,
+              typename AllocatorC, typename LayoutC>
+    void MatMul(const Array2D<T, AllocatorA, LayoutA>& a, const Array2D<T, AllocatorB, LayoutB>& b,
+                Array2D<T, AllocatorC, LayoutC>& c, const std::common_type_t<T> alpha = T(1), const std::common_type_t<T> beta = T(0)) {
+        if (a.Dim2() != b.Dim1()) {
+            throw std::invalid_argument("MatMul: inner dimensions of a and b differ");
+        }
+        if (c.Size() != 0 && (c.Data() == a.Data() || c.Data() == b.Data())) {
+            Array2D<T, AllocatorC, LayoutC> result;
+            if (beta != T(0)) result = c;
+            MatMul(a, b, result, alpha, beta);
+            c = std::move(result);
+            return;
+        }
+        if (beta == T(0)) {
+            c.Resize(a.Dim1(), b.Dim2());
+        } else if (c.Dim1() != a.Dim1() || c.Dim2() != b.Dim2()) {
+            throw std::invalid_argument("MatMul: c must be a.Dim1() x b.Dim2() when beta is not zero");
+        }
+        detail::Gemm<T>(a.View(), b.View(), c.View(), alpha, beta);
+    }
+
+    template <typename T, typename AllocatorA, typename LayoutA, typename AllocatorB, typename LayoutB>
+    Array2D<T, AllocatorA, LayoutA> MatMul(const Array2D<T, AllocatorA, LayoutA>& a, const Array2D<T, AllocatorB, LayoutB>& b) {
+        Array2D<T, AllocatorA, LayoutA> c;
+        MatMul(a, b, c);
+        return c;
+    }
+}
+
+#endif /* MATMUL_HPP_ */
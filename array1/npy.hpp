@@ -0,0 +1,580 @@
+#ifndef NPY_HPP_
+#define NPY_HPP_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "array_base.hpp"
+#include "io.hpp"
+#include "layout.hpp"
+#include "mapped_array.hpp"
+#include "shape.hpp"
+
+namespace array {
+
+    // #######################
+    // NumPy .npy / .npz
+    // #######################
+    // .npy files (format 1.0 written; 1.0 to 3.0 read) hold one array:
+    // "\x93NUMPY", a version, and a Python dict literal giving the dtype
+    // ('descr'), the order ('fortran_order') and the shape, padded so that
+    // the elements start on a 64-byte boundary. RowMajor arrays are saved
+    // with fortran_order False and ColumnMajor ones with fortran_order True,
+    // so np.load gives an array of the same shape and indexing either way.
+    // Element types are those of Save/Load (bool, integers, floating point,
+    // std::complex); the elements are moved with the same parallel
+    // preadv/pwritev transfers, straight from/into the array's storage.
+    //     SaveNpy("u.npy", u);                              // np.load("u.npy")
+    //     auto v = LoadNpy<Array3D<double>>("v.npy");       // np.save("v.npy", v)
+    //     auto w = MapNpy<MappedArray3D<double>>("w.npy");  // no read at all
+    // .npz files are zip archives of .npy members named "<key>.npy", as
+    // written by np.savez; NpzWriter and NpzReader handle the uncompressed
+    // (stored) ones, with Zip64 records so that members may exceed 4 GiB.
+
+    namespace detail {
+
+        // CRC-32 (zip polynomial), eight bytes per step.
+        inline const std::array<std::array<std::uint32_t, 256>, 8>& Crc32Table() {
+            static const auto table = [] {
+                std::array<std::array<std::uint32_t, 256>, 8> t{};
+                for (std::uint32_t i = 0; i < 256; ++i) {
+                    std::uint32_t c = i;
+                    for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                    t[0][i] = c;
+                }
+                for (std::size_t s = 1; s < 8; ++s) {
+                    for (std::size_t i = 0; i < 256; ++i) t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+                }
+                return t;
+            }();
+            return table;
+        }
+
+        inline std::uint32_t Crc32(std::uint32_t crc, const void* data, std::size_t n) {
+            const auto& t = Crc32Table();
+            const unsigned char* p = static_cast<const unsigned char*>(data);
+            crc = ~crc;
+            for (; n >= 8; p += 8, n -= 8) {
+                const std::uint32_t lo = static_cast<std::uint32_t>(GetLE(p, 4)) ^ crc;
+                const std::uint32_t hi = static_cast<std::uint32_t>(GetLE(p + 4, 4));
+                crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+                      t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+            }
+            for (; n > 0; ++p, --n) crc = t[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+            return ~crc;
+        }
+
+        // Complete .npy header (magic to newline) for an array of T.
+        template <typename T, typename Layout>
+        std::string NpyHeader(const ArrayShape& shape) {
+            std::string dict = "{'descr': '";
+            dict += sizeof(T) == 1 ? '|' : NativeLittleEndian() ? '<' : '>';
+            dict += DType<T>::kind;
+            dict += std::to_string(sizeof(T));
+            dict += Layout::kIsColumnMajor && shape.size() > 1 ? "', 'fortran_order': True, 'shape': (" : "', 'fortran_order': False, 'shape': (";
+            for (std::size_t axis = 0; axis < shape.size(); ++axis) {
+                dict += std::to_string(shape[axis]);
+                dict += shape.size() == 1 ? "," : axis + 1 < shape.size() ? ", " : "";
+            }
+            dict += "), }";
+            const std::size_t length = (10 + dict.size() + 1 + 63) / 64 * 64 - 10;
+            dict.resize(length - 1, ' ');
+            dict += '\n';
+
+            std::string header("\x93NUMPY\x01\x00", 8);
+            header += static_cast<char>(length & 0xFF);
+            header += static_cast<char>(length >> 8);
+            return header + dict;
+        }
+
+        // Value text of `key` in a .npy header dict, up to the next ',' or
+        // '}' outside brackets and quotes.
+        inline std::string NpyField(const std::string& dict, const char* key, const std::string& path) {
+            std::size_t at = dict.find(std::string("'") + key + "'");
+            if (at == std::string::npos) at = dict.find(std::string("\"") + key + "\"");
+            if (at == std::string::npos || (at = dict.find(':', at)) == std::string::npos) {
+                throw std::runtime_error("LoadNpy: no '" + std::string(key) + "' in the header of " + path);
+            }
+            std::size_t begin = dict.find_first_not_of(' ', at + 1);
+            std::size_t end = begin;
+            int depth = 0;
+            for (char quote = 0; end < dict.size(); ++end) {
+                const char c = dict[end];
+                if (quote) {
+                    if (c == quote) quote = 0;
+                } else if (c == '\'' || c == '"') {
+                    quote = c;
+                } else if (c == '(' || c == '[') {
+                    ++depth;
+                } else if (c == ')' || c == ']') {
+                    --depth;
+                } else if ((c == ',' || c == '}') && depth == 0) {
+                    break;
+                }
+            }
+            while (end > begin && dict[end - 1] == ' ') --end;
+            return dict.substr(begin, end - begin);
+        }
+
+        // Parses the .npy header starting at byte `offset` of the file.
+        inline ArrayFileHeader ReadNpyHeader(const FileHandle& file, const std::size_t offset) {
+            unsigned char prefix[12];
+            iovec iov = {prefix, sizeof(prefix)};
+            file.Transfer(&iov, 1, static_cast<off_t>(offset), false);
+            if (std::memcmp(prefix, "\x93NUMPY", 6) != 0) {
+                throw std::runtime_error("LoadNpy: " + file.Path() + " is not a .npy file");
+            }
+            const unsigned major = prefix[6];
+            if (major < 1 || major > 3) {
+                throw std::runtime_error("LoadNpy: unsupported .npy version in " + file.Path());
+            }
+            const std::size_t start = major == 1 ? 10 : 12;
+            const std::size_t length = static_cast<std::size_t>(GetLE(prefix + 8, major == 1 ? 2 : 4));
+            std::string dict(length, '\0');
+            iov = {&dict[0], length};
+            file.Transfer(&iov, 1, static_cast<off_t>(offset + start), false);
+
+            const std::string descr = NpyField(dict, "descr", file.Path());
+            if (descr.size() < 4 || (descr[0] != '\'' && descr[0] != '"') || descr.find_first_not_of("0123456789", 3) != descr.size() - 1) {
+                throw std::runtime_error("LoadNpy: unsupported dtype " + descr + " in " + file.Path());
+            }
+            const std::string fortran = NpyField(dict, "fortran_order", file.Path());
+            const std::string shape = NpyField(dict, "shape", file.Path());
+            if (shape.empty() || shape.front() != '(' || shape.back() != ')') {
+                throw std::runtime_error("LoadNpy: invalid shape in " + file.Path());
+            }
+
+            ArrayFileHeader header;
+            const char order = descr[1];
+            header.kind = descr[2];
+            header.item_size = std::stoul(descr.substr(3));
+            header.little_endian = order == '<' || ((order == '|' || order == '=') && NativeLittleEndian());
+            header.column_major = fortran == "True";
+            std::size_t dims[ArrayShape::kMaxRank];
+            std::size_t rank = 0;
+            for (std::size_t i = 1; i + 1 < shape.size();) {
+                if (shape[i] == ' ' || shape[i] == ',') {
+                    ++i;
+                    continue;
+                }
+                if (rank == ArrayShape::kMaxRank) {
+                    throw std::runtime_error("LoadNpy: rank exceeds kMaxRank in " + file.Path());
+                }
+                std::size_t used = 0;
+                dims[rank++] = std::stoul(shape.substr(i), &used);
+                i += used;
+            }
+            header.shape = ArrayShape(dims, dims + rank);
+            header.data_offset = offset + start + length;
+            return header;
+        }
+
+        // Writes `header` then the elements of `a` at byte `offset` of the file.
+        template <typename T, typename Allocator, typename Layout>
+        void WriteNpy(const FileHandle& file, const std::size_t offset, const std::string& header,
+                      const ArrayBase<T, Allocator, Layout>& a) {
+            iovec iov = {const_cast<char*>(header.data()), header.size()};
+            file.Transfer(&iov, 1, static_cast<off_t>(offset), true);
+            TransferArray<const T>(file, O_WRONLY, a, offset + header.size(), IoMode::Buffered, true);
+        }
+
+        // Maps the elements described by `header` as an M (a MappedArray type).
+        template <typename M>
+        M MapNpy(const std::string& path, const ArrayFileHeader& header, const MapMode mode, const MapAdvice advice) {
+            CheckHeader(path, header, M());
+            if (header.little_endian != NativeLittleEndian() && header.item_size > 1) {
+                throw std::invalid_argument("MapNpy: " + path + " has the other byte order; use LoadNpy");
+            }
+            if (header.data_offset % alignof(typename M::value_type) != 0) {
+                throw std::invalid_argument("MapNpy: data in " + path + " is not aligned for its element type; use LoadNpy");
+            }
+            return M(path, header.shape, mode, advice, header.data_offset);
+        }
+    }
+
+    // Shape, dtype and data offset of the .npy file at `path`.
+    inline ArrayFileHeader ReadNpyHeader(const std::string& path) {
+        const detail::FileHandle file(path, O_RDONLY);
+        if (!file.IsOpen()) file.Fail("LoadNpy: cannot open");
+        return detail::ReadNpyHeader(file, 0);
+    }
+
+    template <typename T, typename Allocator, typename Layout>
+    void SaveNpy(const std::string& path, const ArrayBase<T, Allocator, Layout>& a) {
+        const detail::FileHandle file(path, O_WRONLY | O_CREAT | O_TRUNC);
+        if (!file.IsOpen()) file.Fail("SaveNpy: cannot open");
+        const std::string header = detail::NpyHeader<T, Layout>(a.Shape());
+        if (::ftruncate(file.Descriptor(), static_cast<off_t>(header.size() + a.Size() * sizeof(T))) != 0) {
+            file.Fail("SaveNpy: cannot extend");
+        }
+        detail::WriteNpy(file, 0, header, a);
+    }
+
+    // Reads a .npy file into `a` (resized if its shape differs). The dtype
+    // must be T, in either byte order, and fortran_order must match the
+    // layout of A (rank 1 loads in either).
+    template <typename A>
+    void LoadNpy(const std::string& path, A& a) {
+        const detail::FileHandle file(path, O_RDONLY);
+        if (!file.IsOpen()) file.Fail("LoadNpy: cannot open");
+        detail::ReadArray(file, O_RDONLY, detail::ReadNpyHeader(file, 0), a, IoMode::Buffered);
+    }
+
+    template <typename A>
+    A LoadNpy(const std::string& path) {
+        A a;
+        LoadNpy(path, a);
+        return a;
+    }
+
+    // Opens a .npy file as a MappedArray M (e.g. MappedArray3D<double>): pages
+    // are read only when touched. The dtype must be T in native byte order.
+    template <typename M>
+    M MapNpy(const std::string& path, const MapMode mode = MapMode::ReadOnly, const MapAdvice advice = MapAdvice::Normal) {
+        return detail::MapNpy<M>(path, ReadNpyHeader(path), mode, advice);
+    }
+
+    // #######################
+    // NpzWriter
+    // #######################
+    // Writes an uncompressed .npz archive, one Add() per array; np.load(path)[name]
+    // returns it. The member data is aligned to 64 bytes in the file, so
+    // NpzReader::Map works on every member. Close() (or the destructor)
+    // writes the zip directory.
+    //     NpzWriter npz("fields.npz");
+    //     npz.Add("u", u);
+    //     npz.Add("p", p);
+    //     npz.Close();
+    class NpzWriter {
+    public:
+        explicit NpzWriter(const std::string& path)
+        : file_(std::make_unique<detail::FileHandle>(path, O_WRONLY | O_CREAT | O_TRUNC)), offset_(0) {
+            if (!file_->IsOpen()) file_->Fail("NpzWriter: cannot open");
+        }
+
+        NpzWriter(NpzWriter&&) noexcept = default;
+        NpzWriter& operator=(NpzWriter&&) = default;
+
+        ~NpzWriter() {
+            try {
+                Close();
+            } catch (...) {
+            }
+        }
+
+        template <typename T, typename Allocator, typename Layout>
+        void Add(const std::string& name, const ArrayBase<T, Allocator, Layout>& a) {
+            if (!file_) {
+                throw std::logic_error("NpzWriter::Add: archive already closed");
+            }
+            const std::string member = name + ".npy";
+            for (const Entry& entry : entries_) {
+                if (entry.name == member) throw std::invalid_argument("NpzWriter::Add: duplicate name " + name);
+            }
+            const std::string header = detail::NpyHeader<T, Layout>(a.Shape());
+            std::uint32_t crc = detail::Crc32(0, header.data(), header.size());
+            if (a.IsContiguous()) {
+                crc = detail::Crc32(crc, a.Data(), a.Size() * sizeof(T));
+            } else {
+                for (std::size_t row = 0; row < a.NumRows(); ++row) {
+                    crc = detail::Crc32(crc, a.Data() + row * a.Pitch(), a.RowLength() * sizeof(T));
+                }
+            }
+            const std::uint64_t size = header.size() + a.Size() * sizeof(T);
+
+            // Local header: a Zip64 record with the sizes, then an alignment
+            // record padding the member data to a multiple of 64 bytes.
+            const std::size_t fixed = 30 + member.size() + 20 + 4;
+            const std::size_t pad = (64 - (offset_ + fixed) % 64) % 64;
+            std::vector<unsigned char> local(fixed + pad, 0);
+            Put(local, 0, 0x04034b50, 4);
+            Put(local, 4, 45, 2);
+            Put(local, 12, kDosDate, 2);
+            Put(local, 14, crc, 4);
+            Put(local, 18, 0xFFFFFFFFu, 4);
+            Put(local, 22, 0xFFFFFFFFu, 4);
+            Put(local, 26, member.size(), 2);
+            Put(local, 28, 20 + 4 + pad, 2);
+            std::memcpy(&local[30], member.data(), member.size());
+            std::size_t at = 30 + member.size();
+            Put(local, at, 0x0001, 2);
+            Put(local, at + 2, 16, 2);
+            Put(local, at + 4, size, 8);
+            Put(local, at + 12, size, 8);
+            Put(local, at + 20, kAlignmentExtra, 2);
+            Put(local, at + 22, pad, 2);
+            iovec iov = {local.data(), local.size()};
+            file_->Transfer(&iov, 1, static_cast<off_t>(offset_), true);
+
+            detail::WriteNpy(*file_, offset_ + local.size(), header, a);
+            entries_.push_back({member, crc, size, offset_});
+            offset_ += local.size() + size;
+        }
+
+        // Writes the central directory and closes the file; later calls do nothing.
+        void Close() {
+            if (!file_) return;
+            std::vector<unsigned char> tail;
+            for (const Entry& entry : entries_) {
+                const std::size_t at = tail.size();
+                tail.resize(at + 46 + entry.name.size() + 28, 0);
+                Put(tail, at, 0x02014b50, 4);
+                Put(tail, at + 4, 45, 2);
+                Put(tail, at + 6, 45, 2);
+                Put(tail, at + 14, kDosDate, 2);
+                Put(tail, at + 16, entry.crc, 4);
+                Put(tail, at + 20, 0xFFFFFFFFu, 4);
+                Put(tail, at + 24, 0xFFFFFFFFu, 4);
+                Put(tail, at + 28, entry.name.size(), 2);
+                Put(tail, at + 30, 28, 2);
+                Put(tail, at + 42, 0xFFFFFFFFu, 4);
+                std::memcpy(&tail[at + 46], entry.name.data(), entry.name.size());
+                const std::size_t extra = at + 46 + entry.name.size();
+                Put(tail, extra, 0x0001, 2);
+                Put(tail, extra + 2, 24, 2);
+                Put(tail, extra + 4, entry.size, 8);
+                Put(tail, extra + 12, entry.size, 8);
+                Put(tail, extra + 20, entry.offset, 8);
+            }
+            const std::uint64_t directory_size = tail.size();
+            // Zip64 end records (none for an empty archive, which np.load only
+            // recognizes by its leading end of central directory record).
+            if (!entries_.empty()) {
+                const std::uint64_t end64 = offset_ + directory_size;
+                const std::size_t at = tail.size();
+                tail.resize(at + 56 + 20, 0);
+                Put(tail, at, 0x06064b50, 4);
+                Put(tail, at + 4, 44, 8);
+                Put(tail, at + 12, 45, 2);
+                Put(tail, at + 14, 45, 2);
+                Put(tail, at + 24, entries_.size(), 8);
+                Put(tail, at + 32, entries_.size(), 8);
+                Put(tail, at + 40, directory_size, 8);
+                Put(tail, at + 48, offset_, 8);
+                Put(tail, at + 56, 0x07064b50, 4);
+                Put(tail, at + 64, end64, 8);
+                Put(tail, at + 72, 1, 4);
+            }
+            const std::size_t at = tail.size();
+            tail.resize(at + 22, 0);
+            Put(tail, at, 0x06054b50, 4);
+            Put(tail, at + 8, std::min<std::uint64_t>(entries_.size(), 0xFFFF), 2);
+            Put(tail, at + 10, std::min<std::uint64_t>(entries_.size(), 0xFFFF), 2);
+            Put(tail, at + 12, std::min<std::uint64_t>(directory_size, 0xFFFFFFFFu), 4);
+            Put(tail, at + 16, std::min<std::uint64_t>(offset_, 0xFFFFFFFFu), 4);
+            iovec iov = {tail.data(), tail.size()};
+            file_->Transfer(&iov, 1, static_cast<off_t>(offset_), true);
+            if (::ftruncate(file_->Descriptor(), static_cast<off_t>(offset_ + tail.size())) != 0) {
+                file_->Fail("NpzWriter: cannot truncate");
+            }
+            file_.reset();
+        }
+
+    private:
+        struct Entry {
+            std::string name;
+            std::uint32_t crc;
+            std::uint64_t size;
+            std::uint64_t offset;
+        };
+
+        // 1980-01-01, the earliest MS-DOS date, for every member.
+        static constexpr std::uint64_t kDosDate = (1 << 5) | 1;
+        // Extra field id used by zipalign for alignment padding.
+        static constexpr std::uint64_t kAlignmentExtra = 0xD935;
+
+        std::unique_ptr<detail::FileHandle> file_;
+        std::vector<Entry> entries_;
+        std::uint64_t offset_;
+
+        static void Put(std::vector<unsigned char>& bytes, const std::size_t at, const std::uint64_t value, const std::size_t n) {
+            detail::PutLE(&bytes[at], value, n);
+        }
+    };
+
+    // #######################
+    // NpzReader
+    // #######################
+    // Reads the members of an uncompressed .npz archive (np.savez; members of
+    // np.savez_compressed archives are rejected). Names are the member names
+    // without ".npy".
+    //     NpzReader npz("fields.npz");
+    //     auto u = npz.Load<Array3D<double>>("u");
+    //     auto p = npz.Map<MappedArray3D<double>>("p");
+    class NpzReader {
+    public:
+        explicit NpzReader(const std::string& path) : file_(std::make_unique<detail::FileHandle>(path, O_RDONLY)) {
+            if (!file_->IsOpen()) file_->Fail("NpzReader: cannot open");
+            ReadDirectory();
+        }
+
+        inline const std::string& Path() const noexcept { return file_->Path(); }
+
+        std::vector<std::string> Names() const {
+            std::vector<std::string> names;
+            for (const Entry& entry : entries_) names.push_back(entry.name);
+            return names;
+        }
+
+        bool Contains(const std::string& name) const {
+            for (const Entry& entry : entries_) {
+                if (entry.name == name) return true;
+            }
+            return false;
+        }
+
+        // .npy header of member `name`; data_offset is relative to the archive.
+        ArrayFileHeader Header(const std::string& name) const {
+            const Entry& entry = Find(name);
+            if (entry.method != 0) {
+                throw std::runtime_error("NpzReader: member " + name + " of " + Path() + " is compressed");
+            }
+            unsigned char local[30];
+            iovec iov = {local, sizeof(local)};
+            file_->Transfer(&iov, 1, static_cast<off_t>(entry.offset), false);
+            if (detail::GetLE(local, 4) != 0x04034b50) {
+                throw std::runtime_error("NpzReader: corrupt member " + name + " in " + Path());
+            }
+            const std::size_t start = entry.offset + 30 + detail::GetLE(local + 26, 2) + detail::GetLE(local + 28, 2);
+            const ArrayFileHeader header = detail::ReadNpyHeader(*file_, start);
+            if (header.data_offset + header.Size() * header.item_size > start + entry.size) {
+                throw std::runtime_error("NpzReader: member " + name + " of " + Path() + " is truncated");
+            }
+            return header;
+        }
+
+        template <typename A>
+        void Load(const std::string& name, A& a) const {
+            detail::ReadArray(*file_, O_RDONLY, Header(name), a, IoMode::Buffered);
+        }
+
+        template <typename A>
+        A Load(const std::string& name) const {
+            A a;
+            Load(name, a);
+            return a;
+        }
+
+        // Maps member `name` as a MappedArray M. ReadWrite is refused, since
+        // writing would invalidate the member's CRC.
+        template <typename M>
+        M Map(const std::string& name, const MapMode mode = MapMode::ReadOnly, const MapAdvice advice = MapAdvice::Normal) const {
+            if (mode == MapMode::ReadWrite) {
+                throw std::invalid_argument("NpzReader::Map: members cannot be mapped ReadWrite");
+            }
+            return detail::MapNpy<M>(Path(), Header(name), mode, advice);
+        }
+
+    private:
+        struct Entry {
+            std::string name;
+            unsigned method;
+            std::uint64_t size;
+            std::uint64_t offset;
+        };
+
+        std::unique_ptr<detail::FileHandle> file_;
+        std::vector<Entry> entries_;
+
+        const Entry& Find(const std::string& name) const {
+            for (const Entry& entry : entries_) {
+                if (entry.name == name) return entry;
+            }
+            throw std::invalid_argument("NpzReader: no member " + name + " in " + Path());
+        }
+
+        std::vector<unsigned char> Read(const std::uint64_t offset, const std::size_t n) const {
+            std::vector<unsigned char> bytes(n);
+            iovec iov = {bytes.data(), n};
+            if (n > 0) file_->Transfer(&iov, 1, static_cast<off_t>(offset), false);
+            return bytes;
+        }
+
+        // Finds the end of central directory record (and its Zip64 version)
+        // and lists the members.
+        void ReadDirectory() {
+            struct stat st;
+            if (::fstat(file_->Descriptor(), &st) != 0) file_->Fail("NpzReader: cannot stat");
+            const std::uint64_t file_size = static_cast<std::uint64_t>(st.st_size);
+            const std::size_t tail_size = static_cast<std::size_t>(std::min<std::uint64_t>(file_size, 22 + 65535));
+            if (tail_size < 22) {
+                throw std::runtime_error("NpzReader: " + Path() + " is not a zip archive");
+            }
+            const std::vector<unsigned char> tail = Read(file_size - tail_size, tail_size);
+            std::size_t end = tail_size - 22 + 1;
+            while (end-- > 0 && detail::GetLE(&tail[end], 4) != 0x06054b50) { }
+            if (end == std::size_t(-1)) {
+                throw std::runtime_error("NpzReader: " + Path() + " is not a zip archive");
+            }
+            std::uint64_t count = detail::GetLE(&tail[end + 10], 2);
+            std::uint64_t directory_size = detail::GetLE(&tail[end + 12], 4);
+            std::uint64_t directory_offset = detail::GetLE(&tail[end + 16], 4);
+            if (end >= 20 && detail::GetLE(&tail[end - 20], 4) == 0x07064b50) {
+                const std::vector<unsigned char> end64 = Read(detail::GetLE(&tail[end - 12], 8), 56);
+                if (detail::GetLE(end64.data(), 4) != 0x06064b50) {
+                    throw std::runtime_error("NpzReader: corrupt Zip64 directory in " + Path());
+                }
+                count = detail::GetLE(&end64[32], 8);
+                directory_size = detail::GetLE(&end64[40], 8);
+                directory_offset = detail::GetLE(&end64[48], 8);
+            }
+
+            const auto corrupt = [this] { return std::runtime_error("NpzReader: corrupt central directory in " + Path()); };
+            if (directory_offset > file_size || directory_size > file_size - directory_offset) throw corrupt();
+            const std::vector<unsigned char> directory = Read(directory_offset, static_cast<std::size_t>(directory_size));
+            for (std::size_t at = 0, i = 0; i < count; ++i) {
+                if (directory.size() - at < 46 || detail::GetLE(&directory[at], 4) != 0x02014b50) throw corrupt();
+                const unsigned char* record = &directory[at];
+                const std::size_t name_length = detail::GetLE(record + 28, 2);
+                const std::size_t extra_length = detail::GetLE(record + 30, 2);
+                const std::size_t comment_length = detail::GetLE(record + 32, 2);
+                if (directory.size() - at - 46 < name_length + extra_length + comment_length) throw corrupt();
+                Entry entry;
+                entry.name.assign(reinterpret_cast<const char*>(record + 46), name_length);
+                entry.method = static_cast<unsigned>(detail::GetLE(record + 10, 2));
+                std::uint64_t size = detail::GetLE(record + 24, 4);
+                const bool compressed_size64 = detail::GetLE(record + 20, 4) == 0xFFFFFFFFu;
+                entry.offset = detail::GetLE(record + 42, 4);
+                const unsigned char* const extra_end = record + 46 + name_length + extra_length;
+                for (const unsigned char* extra = record + 46 + name_length; extra_end - extra >= 4;) {
+                    const std::size_t length = detail::GetLE(extra + 2, 2);
+                    if (static_cast<std::size_t>(extra_end - extra - 4) < length) throw corrupt();
+                    if (detail::GetLE(extra, 2) == 0x0001) {
+                        // Zip64 fields, present only for the values saturated above.
+                        const unsigned char* value = extra + 4;
+                        std::size_t left = length;
+                        const auto next = [&] {
+                            if (left < 8) throw corrupt();
+                            left -= 8;
+                            value += 8;
+                            return detail::GetLE(value - 8, 8);
+                        };
+                        if (size == 0xFFFFFFFFu) size = next();
+                        if (compressed_size64) next();
+                        if (entry.offset == 0xFFFFFFFFu) entry.offset = next();
+                    }
+                    extra += 4 + length;
+                }
+                entry.size = size;
+                if (entry.name.size() > 4 && entry.name.compare(entry.name.size() - 4, 4, ".npy") == 0) {
+                    entry.name.resize(entry.name.size() - 4);
+                }
+                entries_.push_back(std::move(entry));
+                at += 46 + name_length + extra_length + comment_length;
+            }
+        }
+    };
+}
+
+#endif /* NPY_HPP_ */
@@ -0,0 +1,224 @@
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace array {
+
+    // Arrays smaller than this (in elements) are processed on the calling thread.
+    constexpr std::size_t kParallelThreshold = std::size_t(1) << 20;
+
+    // #######################
+    // ThreadPool
+    // #######################
+    // Fixed set of worker threads executing one job at a time. Run(f) calls
+    // f(thread_index, num_threads) once on every thread, the calling thread
+    // being index 0, and returns when all of them have finished. Run() from
+    // inside a job executes f(0, 1) serially instead of nesting.
+    // Link with -pthread.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(const std::size_t num_threads) : generation_(0), pending_(0), stop_(false) {
+            const std::size_t n = num_threads == 0 ? 1 : num_threads;
+            workers_.reserve(n - 1);
+            for (std::size_t i = 1; i < n; ++i) {
+                workers_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            cv_start_.notify_all();
+            for (std::thread& worker : workers_) {
+                worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        inline std::size_t NumThreads() const noexcept { return workers_.size() + 1; }
+
+        // While a SerialScope lives, Run() on the thread that created it runs
+        // f(0, 1) on that thread, as from inside a job: background threads
+        // (CheckpointWriter) then leave the workers to the other threads
+        // instead of queueing behind their jobs.
+        class SerialScope {
+        public:
+            SerialScope() noexcept : previous_(InsideJob()) { InsideJob() = true; }
+            ~SerialScope() { InsideJob() = previous_; }
+
+            SerialScope(const SerialScope&) = delete;
+            SerialScope& operator=(const SerialScope&) = delete;
+
+        private:
+            bool previous_;
+        };
+
+        // Process-wide pool. Its size is taken from the ARRAY_NUM_THREADS
+        // environment variable, or std::thread::hardware_concurrency().
+        static ThreadPool& Global() {
+            static ThreadPool pool(DefaultNumThreads());
+            return pool;
+        }
+
+        static std::size_t DefaultNumThreads() {
+            if (const char* env = std::getenv("ARRAY_NUM_THREADS")) {
+                const long n = std::strtol(env, nullptr, 10);
+                if (n > 0) return static_cast<std::size_t>(n);
+            }
+            const unsigned n = std::thread::hardware_concurrency();
+            return n == 0 ? 1 : n;
+        }
+
+        template <typename F>
+        void Run(F&& f) {
+            if (InsideJob() || workers_.empty()) {
+                f(std::size_t(0), std::size_t(1));
+                return;
+            }
+
+            std::lock_guard<std::mutex> run_lock(run_mutex_);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job_ = &Invoke<std::remove_reference_t<F>>;
+                job_context_ = &f;
+                error_ = nullptr;
+                pending_ = workers_.size();
+                ++generation_;
+            }
+            cv_start_.notify_all();
+
+            Execute(0);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_done_.wait(lock, [this] { return pending_ == 0; });
+            job_ = nullptr;
+            if (error_) {
+                std::rethrow_exception(error_);
+            }
+        }
+
+    private:
+        using JobFunction = void (*)(void*, std::size_t, std::size_t);
+
+        std::vector<std::thread> workers_;
+        std::mutex run_mutex_;
+        std::mutex mutex_;
+        std::condition_variable cv_start_;
+        std::condition_variable cv_done_;
+        JobFunction job_ = nullptr;
+        void* job_context_ = nullptr;
+        std::exception_ptr error_;
+        std::size_t generation_;
+        std::size_t pending_;
+        bool stop_;
+
+        template <typename F>
+        static void Invoke(void* context, const std::size_t index, const std::size_t num_threads) {
+            (*static_cast<F*>(context))(index, num_threads);
+        }
+
+        static bool& InsideJob() noexcept {
+            thread_local bool inside = false;
+            return inside;
+        }
+
+        void Execute(const std::size_t index) {
+            InsideJob() = true;
+            try {
+                job_(job_context_, index, NumThreads());
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            InsideJob() = false;
+        }
+
+        void WorkerLoop(const std::size_t index) {
+            std::size_t seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_start_.wait(lock, [this, seen] { return stop_ || generation_ != seen; });
+                    if (stop_) return;
+                    seen = generation_;
+                }
+                Execute(index);
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --pending_;
+                }
+                cv_done_.notify_one();
+            }
+        }
+    };
+
+    // #######################
+    // Static partitioning
+    // #######################
+    // [0, n) is split into one contiguous chunk per pool thread, with chunk
+    // boundaries on multiples of `grain`. The split depends only on n, grain
+    // and the pool size, so every loop over the same array touches the same
+    // pages from the same threads; this is what makes first-touch placement
+    // (FirstTouchAllocator) stick on NUMA systems.
+
+    constexpr std::size_t kPageSize = 4096;
+
+    // Elements of T per page (at least one).
+    template <typename T>
+    constexpr std::size_t PageElements() noexcept {
+        return sizeof(T) >= kPageSize ? 1 : kPageSize / sizeof(T);
+    }
+
+    inline void StaticChunk(const std::size_t n, const std::size_t grain, const std::size_t index, const std::size_t count,
+                            std::size_t& begin, std::size_t& end) noexcept {
+        const std::size_t units = (n + grain - 1) / grain;
+        begin = std::min(n, (units * index / count) * grain);
+        end = std::min(n, (units * (index + 1) / count) * grain);
+    }
+
+    // Calls f(begin, end) for the chunk of each thread. Loops shorter than
+    // kParallelThreshold run as a single chunk on the calling thread.
+    template <typename F>
+    void ParallelForStatic(const std::size_t n, const std::size_t grain, F&& f) {
+        if (n == 0) return;
+        ThreadPool& pool = ThreadPool::Global();
+        if (n < kParallelThreshold || pool.NumThreads() == 1) {
+            f(std::size_t(0), n);
+            return;
+        }
+        pool.Run([&](const std::size_t index, const std::size_t count) {
+            std::size_t begin, end;
+            StaticChunk(n, grain == 0 ? 1 : grain, index, count, begin, end);
+            if (begin < end) f(begin, end);
+        });
+    }
+
+    template <typename T>
+    void ParallelFill(T* data, const std::size_t n, const T& value) {
+        ParallelForStatic(n, PageElements<T>(), [=, &value](const std::size_t begin, const std::size_t end) {
+            std::fill(data + begin, data + end, value);
+        });
+    }
+
+    template <typename T>
+    void ParallelCopy(const T* src, const std::size_t n, T* dst) {
+        ParallelForStatic(n, PageElements<T>(), [=](const std::size_t begin, const std::size_t end) {
+            std::copy(src + begin, src + end, dst + begin);
+        });
+    }
+}
+
+#endif /* PARALLEL_HPP_ */
@@ -0,0 +1,242 @@
+#ifndef REDUCTION_HPP_
+#define REDUCTION_HPP_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "array_base.hpp"
+#include "array_view.hpp"
+#include "simd.hpp"
+
+namespace array {
+
+    // #######################
+    // Reductions
+    // #######################
+    // Contiguous rows are reduced by the SIMD kernels in simd.hpp; strided rows
+    // fall back to a scalar loop. NaN elements are ignored by Min/Max/MinMax and
+    // the Arg* functions, and propagate through Sum and the norms. Input made
+    // of NaN only has a NaN minimum and maximum (as numpy.nanmin/nanmax), and
+    // ArgMin/ArgMax then return the index of its first element.
+
+    namespace detail {
+
+        template <simd::ReduceKind Kind, typename T>
+        inline void ReduceRow(const T* row, const std::size_t n, const std::size_t stride, T* result) {
+            T partial[2];
+            if (stride == 1) {
+                simd::Reduce<Kind>(row, n, partial);
+            } else {
+                using S = simd::ScalarVec<T>;
+                partial[0] = simd::ReduceIdentity<Kind, T>();
+                partial[1] = simd::ReduceIdentity<simd::ReduceKind::Max, T>();
+                for (std::size_t i = 0; i < n; ++i) {
+                    simd::ReduceStep<Kind, S>(partial[0], partial[1], row[i * stride]);
+                }
+            }
+            result[0] = simd::ReduceCombine<Kind, simd::ScalarVec<T>>(result[0], partial[0]);
+            result[1] = simd::ScalarVec<T>::Max(result[1], partial[1]);
+        }
+
+        template <simd::ReduceKind Kind, typename T, std::size_t Rank>
+        inline void ReduceView(const ArrayView<const T, Rank>& view, T* result) {
+            result[0] = simd::ReduceIdentity<Kind, T>();
+            result[1] = simd::ReduceIdentity<simd::ReduceKind::Max, T>();
+            view.ForEachRow([result](const T* row, const std::size_t n, const std::size_t stride) {
+                ReduceRow<Kind>(row, n, stride, result);
+            });
+        }
+
+        template <typename T, std::size_t Rank>
+        inline void CheckNotEmpty(const ArrayView<const T, Rank>& view, const char* message) {
+            if (view.IsEmpty()) {
+                throw std::invalid_argument(message);
+            }
+        }
+
+        // Min/Max accumulators start at their identity (+-infinity) and skip
+        // NaN elements, so `value` equal to the identity may mean that every
+        // element is NaN; the result is NaN then.
+        template <simd::ReduceKind Kind, typename T, std::size_t Rank>
+        T NaNIfAllNaN(const ArrayView<const T, Rank>& view, const T value) {
+            if constexpr (std::is_floating_point<T>::value) {
+                if (value != simd::ReduceIdentity<Kind, T>()) return value;
+                bool all = true;
+                view.ForEachRow([&all](const T* row, const std::size_t n, const std::size_t stride) {
+                    for (std::size_t i = 0; i < n && all; ++i) {
+                        all = std::isnan(row[i * stride]);
+                    }
+                });
+                if (all) return std::numeric_limits<T>::quiet_NaN();
+            }
+            return value;
+        }
+
+        // Row-major index of the first element equal to `value` (the first
+        // NaN if `value` is NaN).
+        template <typename T, std::size_t Rank>
+        std::array<std::size_t, Rank> FindFirst(const ArrayView<const T, Rank>& view, const T value) {
+            std::array<std::size_t, Rank> index{};
+            std::size_t flat = 0;
+            bool found = false;
+            const bool nan = value != value;
+            view.ForEachRow([&](const T* row, const std::size_t n, const std::size_t stride) {
+                if (found) return;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const T x = row[i * stride];
+                    if (nan ? x != x : x == value) {
+                        flat += i;
+                        found = true;
+                        return;
+                    }
+                }
+                flat += n;
+            });
+            for (std::size_t axis = Rank; axis-- > 0;) {
+                index[axis] = flat % view.Dim(axis);
+                flat /= view.Dim(axis);
+            }
+            return index;
+        }
+    }
+
+    // #######################
+    // Views
+    // #######################
+
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    V Sum(const ArrayView<T, Rank>& view) {
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::Sum, V, Rank>(view, result);
+        return result[0];
+    }
+
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    V Min(const ArrayView<T, Rank>& view) {
+        detail::CheckNotEmpty<V, Rank>(view, "Min: empty array");
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::Min, V, Rank>(view, result);
+        return detail::NaNIfAllNaN<simd::ReduceKind::Min, V, Rank>(view, result[0]);
+    }
+
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    V Max(const ArrayView<T, Rank>& view) {
+        detail::CheckNotEmpty<V, Rank>(view, "Max: empty array");
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::Max, V, Rank>(view, result);
+        return detail::NaNIfAllNaN<simd::ReduceKind::Max, V, Rank>(view, result[0]);
+    }
+
+    // Minimum and maximum in a single pass over the data.
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    std::pair<V, V> MinMax(const ArrayView<T, Rank>& view) {
+        detail::CheckNotEmpty<V, Rank>(view, "MinMax: empty array");
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::MinMax, V, Rank>(view, result);
+        // Any non-NaN element lies between the two; all NaN leaves them crossed.
+        if constexpr (std::is_floating_point<V>::value) {
+            if (result[0] > result[1]) return std::make_pair(std::numeric_limits<V>::quiet_NaN(), std::numeric_limits<V>::quiet_NaN());
+        }
+        return std::make_pair(result[0], result[1]);
+    }
+
+    // Index of the first minimum in row-major order.
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    std::array<std::size_t, Rank> ArgMin(const ArrayView<T, Rank>& view) {
+        return detail::FindFirst<V, Rank>(view, Min(view));
+    }
+
+    // Index of the first maximum in row-major order.
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    std::array<std::size_t, Rank> ArgMax(const ArrayView<T, Rank>& view) {
+        return detail::FindFirst<V, Rank>(view, Max(view));
+    }
+
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    V NormL1(const ArrayView<T, Rank>& view) {
+        static_assert(std::is_floating_point<V>::value, "NormL1 requires floating point type");
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::SumAbs, V, Rank>(view, result);
+        return result[0];
+    }
+
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    V NormL2(const ArrayView<T, Rank>& view) {
+        static_assert(std::is_floating_point<V>::value, "NormL2 requires floating point type");
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::SumSquares, V, Rank>(view, result);
+        return std::sqrt(result[0]);
+    }
+
+    template <typename T, std::size_t Rank, typename V = std::remove_const_t<T>>
+    V NormLinf(const ArrayView<T, Rank>& view) {
+        static_assert(std::is_floating_point<V>::value, "NormLinf requires floating point type");
+        V result[2];
+        detail::ReduceView<simd::ReduceKind::MaxAbs, V, Rank>(view, result);
+        return result[0];
+    }
+
+    // #######################
+    // Arrays (any rank)
+    // #######################
+    // Padded arrays are reduced row by row, skipping the padding; ArgMin/ArgMax
+    // return the flat index into Data() (see UnravelIndex).
+
+    namespace detail {
+
+        // Elements of `a` as a 2-D view: a single row when it is contiguous,
+        // its rows along the innermost axis otherwise.
+        template <typename T, typename Allocator, typename Layout>
+        inline ArrayView<const T, 2> ElementRows(const ArrayBase<T, Allocator, Layout>& a) noexcept {
+            if (a.IsContiguous()) {
+                return ArrayView<const T, 2>(a.Data(), {1, a.Size()}, {a.Size(), 1});
+            }
+            return a.RowView();
+        }
+
+        template <typename T>
+        inline std::size_t StorageOffset(const ArrayView<const T, 2>& rows, const std::array<std::size_t, 2>& index) noexcept {
+            return index[0] * rows.Stride(0) + index[1];
+        }
+    }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline T Sum(const ArrayBase<T, Allocator, Layout>& a) { return Sum(detail::ElementRows(a)); }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline T Min(const ArrayBase<T, Allocator, Layout>& a) { return Min(detail::ElementRows(a)); }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline T Max(const ArrayBase<T, Allocator, Layout>& a) { return Max(detail::ElementRows(a)); }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline std::pair<T, T> MinMax(const ArrayBase<T, Allocator, Layout>& a) { return MinMax(detail::ElementRows(a)); }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline std::size_t ArgMin(const ArrayBase<T, Allocator, Layout>& a) {
+        const ArrayView<const T, 2> rows = detail::ElementRows(a);
+        return detail::StorageOffset(rows, ArgMin(rows));
+    }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline std::size_t ArgMax(const ArrayBase<T, Allocator, Layout>& a) {
+        const ArrayView<const T, 2> rows = detail::ElementRows(a);
+        return detail::StorageOffset(rows, ArgMax(rows));
+    }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline T NormL1(const ArrayBase<T, Allocator, Layout>& a) { return NormL1(detail::ElementRows(a)); }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline T NormL2(const ArrayBase<T, Allocator, Layout>& a) { return NormL2(detail::ElementRows(a)); }
+
+    template <typename T, typename Allocator, typename Layout>
+    inline T NormLinf(const ArrayBase<T, Allocator, Layout>& a) { return NormLinf(detail::ElementRows(a)); }
+}
+
+#endif /* REDUCTION_HPP_ */
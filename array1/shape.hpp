@@ -0,0 +1,74 @@
+#ifndef SHAPE_HPP_
+#define SHAPE_HPP_
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace array {
+
+    // #######################
+    // ArrayShape
+    // #######################
+    // Fixed-capacity shape stored inline (no heap allocation). Unused extents
+    // are kept at zero so that comparisons are a plain array compare.
+    class ArrayShape {
+    public:
+        static constexpr std::size_t kMaxRank = 6;
+
+        using value_type = std::size_t;
+        using iterator = std::size_t*;
+        using const_iterator = const std::size_t*;
+
+        ArrayShape() noexcept : rank_(0), dims_{} { }
+
+        ArrayShape(std::initializer_list<std::size_t> dims) : ArrayShape(dims.begin(), dims.end()) { }
+
+        template <typename Iterator>
+        ArrayShape(Iterator first, Iterator last) : rank_(0), dims_{} {
+            for (; first != last; ++first) {
+                if (rank_ == kMaxRank) {
+                    throw std::length_error("ArrayShape: rank exceeds kMaxRank");
+                }
+                dims_[rank_++] = static_cast<std::size_t>(*first);
+            }
+        }
+
+        inline std::size_t size() const noexcept { return rank_; }
+        inline bool empty() const noexcept { return rank_ == 0; }
+
+        inline std::size_t& operator[](const std::size_t axis) noexcept { return dims_[axis]; }
+        inline const std::size_t& operator[](const std::size_t axis) const noexcept { return dims_[axis]; }
+
+        inline std::size_t* data() noexcept { return dims_.data(); }
+        inline const std::size_t* data() const noexcept { return dims_.data(); }
+
+        inline iterator begin() noexcept { return dims_.data(); }
+        inline const_iterator begin() const noexcept { return dims_.data(); }
+        inline iterator end() noexcept { return dims_.data() + rank_; }
+        inline const_iterator end() const noexcept { return dims_.data() + rank_; }
+
+        inline void clear() noexcept {
+            rank_ = 0;
+            dims_.fill(0);
+        }
+
+        friend inline bool operator==(const ArrayShape& lhs, const ArrayShape& rhs) noexcept {
+            return lhs.rank_ == rhs.rank_ && lhs.dims_ == rhs.dims_;
+        }
+
+        friend inline bool operator!=(const ArrayShape& lhs, const ArrayShape& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        std::size_t rank_;
+        std::array<std::size_t, kMaxRank> dims_;
+    };
+
+    // Multi-dimensional element index; same inline storage as a shape.
+    using ArrayIndex = ArrayShape;
+}
+
+#endif /* SHAPE_HPP_ */
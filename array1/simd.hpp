@@ -0,0 +1,865 @@
+#ifndef SIMD_HPP_
+#define SIMD_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Explicit x86 SIMD paths (SSE2 / AVX2 / AVX-512) selected at run time.
+// Define DISABLE_SIMD to build with the portable scalar kernels only.
+#if !defined(DISABLE_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define ARRAY_SIMD_X86
+    // GCC 12 reports the _mm*_undefined_* pass-through operands of its own
+    // AVX-512 intrinsics as uninitialized when they are used via target attributes.
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #include <immintrin.h>
+    #pragma GCC diagnostic pop
+    #define ARRAY_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define ARRAY_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+    #define ARRAY_INLINE_AVX2 __attribute__((target("avx2,fma"), always_inline)) inline
+    #define ARRAY_INLINE_AVX512 __attribute__((target("avx512f,avx2,fma"), always_inline)) inline
+#endif
+
+namespace array {
+namespace simd {
+
+    enum class SimdLevel {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    inline SimdLevel DetectSimdLevel() noexcept {
+    #ifdef ARRAY_SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+        #ifdef __SSE2__
+        return SimdLevel::SSE2;
+        #endif
+    #endif
+        return SimdLevel::Scalar;
+    }
+
+    // Instruction set used by the dispatchers, detected once per process.
+    inline SimdLevel ActiveSimdLevel() noexcept {
+        static const SimdLevel level = DetectSimdLevel();
+        return level;
+    }
+
+    template <typename T>
+    struct IsSimdFloat : std::integral_constant<bool, std::is_same<T, float>::value || std::is_same<T, double>::value> { };
+
+    // #######################
+    // Reductions
+    // #######################
+
+    enum class ReduceKind {
+        Sum,
+        SumAbs,
+        SumSquares,
+        Min,
+        Max,
+        MaxAbs,
+        MinMax
+    };
+
+    // Neutral start value. Floating point Min/Max start from +/-infinity so that
+    // arrays holding only +/-max() or infinities reduce correctly.
+    template <ReduceKind Kind, typename T>
+    constexpr T ReduceIdentity() noexcept {
+        if constexpr (Kind == ReduceKind::Min || Kind == ReduceKind::MinMax) {
+            return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+        } else if constexpr (Kind == ReduceKind::Max) {
+            return std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+        } else {
+            return static_cast<T>(0);
+        }
+    }
+
+    // Min/Max follow the x86 convention Min(a, b) = a < b ? a : b, and kernels
+    // call them as Min(x, acc), so NaN elements never replace the accumulator.
+    template <typename T>
+    struct ScalarVec {
+        using scalar = T;
+        using reg = T;
+        static constexpr std::size_t kWidth = 1;
+
+        static inline reg Load(const T* p) { return *p; }
+        static inline reg Set1(const T v) { return v; }
+        static inline reg Add(const reg a, const reg b) { return a + b; }
+        static inline reg MulAdd(const reg a, const reg b, const reg c) { return a * b + c; }
+        static inline reg Min(const reg a, const reg b) { return a < b ? a : b; }
+        static inline reg Max(const reg a, const reg b) { return a > b ? a : b; }
+        static inline reg Abs(const reg a) {
+            if constexpr (std::is_signed<T>::value) {
+                return a < static_cast<T>(0) ? -a : a;
+            } else {
+                return a;
+            }
+        }
+        static inline T ReduceAdd(const reg a) { return a; }
+        static inline T ReduceMin(const reg a) { return a; }
+        static inline T ReduceMax(const reg a) { return a; }
+    };
+
+#if defined(ARRAY_SIMD_X86) && defined(__SSE2__)
+    template <typename T>
+    struct SseVec;
+
+    template <>
+    struct SseVec<double> {
+        using scalar = double;
+        using reg = __m128d;
+        static constexpr std::size_t kWidth = 2;
+
+        static inline reg Load(const double* p) { return _mm_loadu_pd(p); }
+        static inline reg Set1(const double v) { return _mm_set1_pd(v); }
+        static inline reg Add(const reg a, const reg b) { return _mm_add_pd(a, b); }
+        static inline reg MulAdd(const reg a, const reg b, const reg c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static inline reg Min(const reg a, const reg b) { return _mm_min_pd(a, b); }
+        static inline reg Max(const reg a, const reg b) { return _mm_max_pd(a, b); }
+        static inline reg Abs(const reg a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+        static inline double ReduceAdd(const reg a) { return _mm_cvtsd_f64(_mm_add_sd(a, _mm_unpackhi_pd(a, a))); }
+        static inline double ReduceMin(const reg a) { return _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(a, a), a)); }
+        static inline double ReduceMax(const reg a) { return _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(a, a), a)); }
+    };
+
+    template <>
+    struct SseVec<float> {
+        using scalar = float;
+        using reg = __m128;
+        static constexpr std::size_t kWidth = 4;
+
+        static inline reg Load(const float* p) { return _mm_loadu_ps(p); }
+        static inline reg Set1(const float v) { return _mm_set1_ps(v); }
+        static inline reg Add(const reg a, const reg b) { return _mm_add_ps(a, b); }
+        static inline reg MulAdd(const reg a, const reg b, const reg c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        static inline reg Min(const reg a, const reg b) { return _mm_min_ps(a, b); }
+        static inline reg Max(const reg a, const reg b) { return _mm_max_ps(a, b); }
+        static inline reg Abs(const reg a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static inline float ReduceAdd(reg a) {
+            a = _mm_add_ps(a, _mm_movehl_ps(a, a));
+            return _mm_cvtss_f32(_mm_add_ss(a, _mm_shuffle_ps(a, a, 1)));
+        }
+        static inline float ReduceMin(reg a) {
+            a = _mm_min_ps(_mm_movehl_ps(a, a), a);
+            return _mm_cvtss_f32(_mm_min_ss(_mm_shuffle_ps(a, a, 1), a));
+        }
+        static inline float ReduceMax(reg a) {
+            a = _mm_max_ps(_mm_movehl_ps(a, a), a);
+            return _mm_cvtss_f32(_mm_max_ss(_mm_shuffle_ps(a, a, 1), a));
+        }
+    };
+#endif
+
+    // #######################
+    // Generic kernel (scalar / SSE2)
+    // #######################
+    // Four independent accumulators hide the add/min/max latency. result[0] holds
+    // the reduction (the minimum for MinMax), result[1] the maximum for MinMax.
+
+    template <ReduceKind Kind, typename V>
+    inline void ReduceStep(typename V::reg& a, typename V::reg& b, const typename V::reg x) {
+        if constexpr (Kind == ReduceKind::Sum) {
+            a = V::Add(a, x);
+        } else if constexpr (Kind == ReduceKind::SumAbs) {
+            a = V::Add(a, V::Abs(x));
+        } else if constexpr (Kind == ReduceKind::SumSquares) {
+            a = V::MulAdd(x, x, a);
+        } else if constexpr (Kind == ReduceKind::Min) {
+            a = V::Min(x, a);
+        } else if constexpr (Kind == ReduceKind::Max) {
+            a = V::Max(x, a);
+        } else if constexpr (Kind == ReduceKind::MaxAbs) {
+            a = V::Max(V::Abs(x), a);
+        } else {
+            a = V::Min(x, a);
+            b = V::Max(x, b);
+        }
+    }
+
+    template <ReduceKind Kind, typename V>
+    inline typename V::reg ReduceCombine(const typename V::reg a, const typename V::reg b) {
+        if constexpr (Kind == ReduceKind::Min || Kind == ReduceKind::MinMax) {
+            return V::Min(a, b);
+        } else if constexpr (Kind == ReduceKind::Max || Kind == ReduceKind::MaxAbs) {
+            return V::Max(a, b);
+        } else {
+            return V::Add(a, b);
+        }
+    }
+
+    template <ReduceKind Kind, typename V>
+    inline typename V::scalar ReduceHorizontal(const typename V::reg a) {
+        if constexpr (Kind == ReduceKind::Min || Kind == ReduceKind::MinMax) {
+            return V::ReduceMin(a);
+        } else if constexpr (Kind == ReduceKind::Max || Kind == ReduceKind::MaxAbs) {
+            return V::ReduceMax(a);
+        } else {
+            return V::ReduceAdd(a);
+        }
+    }
+
+    template <ReduceKind Kind, typename T>
+    inline void ReduceTail(const T* p, const std::size_t begin, const std::size_t n, T* result) {
+        using S = ScalarVec<T>;
+        T a = result[0];
+        T b = result[1];
+        for (std::size_t i = begin; i < n; ++i) {
+            ReduceStep<Kind, S>(a, b, p[i]);
+        }
+        result[0] = a;
+        result[1] = b;
+    }
+
+    template <ReduceKind Kind, typename V>
+    inline void ReduceKernel(const typename V::scalar* p, const std::size_t n, typename V::scalar* result) {
+        using T = typename V::scalar;
+        using R = typename V::reg;
+        constexpr std::size_t W = V::kWidth;
+
+        const R init_a = V::Set1(ReduceIdentity<Kind, T>());
+        const R init_b = V::Set1(ReduceIdentity<ReduceKind::Max, T>());
+        R a0 = init_a, a1 = init_a, a2 = init_a, a3 = init_a;
+        R b0 = init_b, b1 = init_b, b2 = init_b, b3 = init_b;
+
+        std::size_t i = 0;
+        for (; i + 4 * W <= n; i += 4 * W) {
+            ReduceStep<Kind, V>(a0, b0, V::Load(p + i));
+            ReduceStep<Kind, V>(a1, b1, V::Load(p + i + W));
+            ReduceStep<Kind, V>(a2, b2, V::Load(p + i + 2 * W));
+            ReduceStep<Kind, V>(a3, b3, V::Load(p + i + 3 * W));
+        }
+        for (; i + W <= n; i += W) {
+            ReduceStep<Kind, V>(a0, b0, V::Load(p + i));
+        }
+
+        a0 = ReduceCombine<Kind, V>(ReduceCombine<Kind, V>(a0, a1), ReduceCombine<Kind, V>(a2, a3));
+        b0 = V::Max(V::Max(b0, b1), V::Max(b2, b3));
+        result[0] = ReduceHorizontal<Kind, V>(a0);
+        result[1] = V::ReduceMax(b0);
+        ReduceTail<Kind>(p, i, n, result);
+    }
+
+#ifdef ARRAY_SIMD_X86
+    // #######################
+    // AVX2
+    // #######################
+    template <typename T>
+    struct Avx2Vec;
+
+    template <>
+    struct Avx2Vec<double> {
+        using scalar = double;
+        using reg = __m256d;
+        static constexpr std::size_t kWidth = 4;
+
+        ARRAY_INLINE_AVX2 static reg Load(const double* p) { return _mm256_loadu_pd(p); }
+        ARRAY_INLINE_AVX2 static void Store(double* p, const reg a) { _mm256_storeu_pd(p, a); }
+        ARRAY_INLINE_AVX2 static reg Set1(const double v) { return _mm256_set1_pd(v); }
+        ARRAY_INLINE_AVX2 static reg Add(const reg a, const reg b) { return _mm256_add_pd(a, b); }
+        ARRAY_INLINE_AVX2 static reg MulAdd(const reg a, const reg b, const reg c) { return _mm256_fmadd_pd(a, b, c); }
+        ARRAY_INLINE_AVX2 static reg Min(const reg a, const reg b) { return _mm256_min_pd(a, b); }
+        ARRAY_INLINE_AVX2 static reg Max(const reg a, const reg b) { return _mm256_max_pd(a, b); }
+        ARRAY_INLINE_AVX2 static reg Abs(const reg a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+        ARRAY_INLINE_AVX2 static double ReduceAdd(const reg a) {
+            const __m128d v = _mm_add_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+        }
+        ARRAY_INLINE_AVX2 static double ReduceMin(const reg a) {
+            const __m128d v = _mm_min_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+            return _mm_cvtsd_f64(_mm_min_sd(_mm_unpackhi_pd(v, v), v));
+        }
+        ARRAY_INLINE_AVX2 static double ReduceMax(const reg a) {
+            const __m128d v = _mm_max_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+            return _mm_cvtsd_f64(_mm_max_sd(_mm_unpackhi_pd(v, v), v));
+        }
+    };
+
+    template <>
+    struct Avx2Vec<float> {
+        using scalar = float;
+        using reg = __m256;
+        static constexpr std::size_t kWidth = 8;
+
+        ARRAY_INLINE_AVX2 static reg Load(const float* p) { return _mm256_loadu_ps(p); }
+        ARRAY_INLINE_AVX2 static void Store(float* p, const reg a) { _mm256_storeu_ps(p, a); }
+        ARRAY_INLINE_AVX2 static reg Set1(const float v) { return _mm256_set1_ps(v); }
+        ARRAY_INLINE_AVX2 static reg Add(const reg a, const reg b) { return _mm256_add_ps(a, b); }
+        ARRAY_INLINE_AVX2 static reg MulAdd(const reg a, const reg b, const reg c) { return _mm256_fmadd_ps(a, b, c); }
+        ARRAY_INLINE_AVX2 static reg Min(const reg a, const reg b) { return _mm256_min_ps(a, b); }
+        ARRAY_INLINE_AVX2 static reg Max(const reg a, const reg b) { return _mm256_max_ps(a, b); }
+        ARRAY_INLINE_AVX2 static reg Abs(const reg a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        ARRAY_INLINE_AVX2 static float ReduceAdd(const reg a) {
+            __m128 v = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+            return _mm_cvtss_f32(_mm_add_ss(v, _mm_shuffle_ps(v, v, 1)));
+        }
+        ARRAY_INLINE_AVX2 static float ReduceMin(const reg a) {
+            __m128 v = _mm_min_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            v = _mm_min_ps(_mm_movehl_ps(v, v), v);
+            return _mm_cvtss_f32(_mm_min_ss(_mm_shuffle_ps(v, v, 1), v));
+        }
+        ARRAY_INLINE_AVX2 static float ReduceMax(const reg a) {
+            __m128 v = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+            v = _mm_max_ps(_mm_movehl_ps(v, v), v);
+            return _mm_cvtss_f32(_mm_max_ss(_mm_shuffle_ps(v, v, 1), v));
+        }
+    };
+
+    template <ReduceKind Kind, typename V>
+    ARRAY_INLINE_AVX2 void ReduceStepAvx2(typename V::reg& a, typename V::reg& b, const typename V::reg x) {
+        if constexpr (Kind == ReduceKind::Sum) {
+            a = V::Add(a, x);
+        } else if constexpr (Kind == ReduceKind::SumAbs) {
+            a = V::Add(a, V::Abs(x));
+        } else if constexpr (Kind == ReduceKind::SumSquares) {
+            a = V::MulAdd(x, x, a);
+        } else if constexpr (Kind == ReduceKind::Min) {
+            a = V::Min(x, a);
+        } else if constexpr (Kind == ReduceKind::Max) {
+            a = V::Max(x, a);
+        } else if constexpr (Kind == ReduceKind::MaxAbs) {
+            a = V::Max(V::Abs(x), a);
+        } else {
+            a = V::Min(x, a);
+            b = V::Max(x, b);
+        }
+    }
+
+    template <ReduceKind Kind, typename T>
+    ARRAY_TARGET_AVX2 void ReduceKernelAvx2(const T* p, const std::size_t n, T* result) {
+        using V = Avx2Vec<T>;
+        using R = typename V::reg;
+        constexpr std::size_t W = V::kWidth;
+        constexpr bool kIsMin = Kind == ReduceKind::Min || Kind == ReduceKind::MinMax;
+        constexpr bool kIsMax = Kind == ReduceKind::Max || Kind == ReduceKind::MaxAbs;
+
+        const R init_a = V::Set1(ReduceIdentity<Kind, T>());
+        const R init_b = V::Set1(ReduceIdentity<ReduceKind::Max, T>());
+        R a0 = init_a, a1 = init_a, a2 = init_a, a3 = init_a;
+        R b0 = init_b, b1 = init_b, b2 = init_b, b3 = init_b;
+
+        std::size_t i = 0;
+        for (; i + 4 * W <= n; i += 4 * W) {
+            ReduceStepAvx2<Kind, V>(a0, b0, V::Load(p + i));
+            ReduceStepAvx2<Kind, V>(a1, b1, V::Load(p + i + W));
+            ReduceStepAvx2<Kind, V>(a2, b2, V::Load(p + i + 2 * W));
+            ReduceStepAvx2<Kind, V>(a3, b3, V::Load(p + i + 3 * W));
+        }
+        for (; i + W <= n; i += W) {
+            ReduceStepAvx2<Kind, V>(a0, b0, V::Load(p + i));
+        }
+
+        if constexpr (kIsMin) {
+            result[0] = V::ReduceMin(V::Min(V::Min(a0, a1), V::Min(a2, a3)));
+        } else if constexpr (kIsMax) {
+            result[0] = V::ReduceMax(V::Max(V::Max(a0, a1), V::Max(a2, a3)));
+        } else {
+            result[0] = V::ReduceAdd(V::Add(V::Add(a0, a1), V::Add(a2, a3)));
+        }
+        result[1] = V::ReduceMax(V::Max(V::Max(b0, b1), V::Max(b2, b3)));
+        ReduceTail<Kind>(p, i, n, result);
+    }
+
+    // #######################
+    // AVX-512
+    // #######################
+    template <typename T>
+    struct Avx512Vec;
+
+    template <>
+    struct Avx512Vec<double> {
+        using scalar = double;
+        using reg = __m512d;
+        static constexpr std::size_t kWidth = 8;
+
+        ARRAY_INLINE_AVX512 static reg Load(const double* p) { return _mm512_loadu_pd(p); }
+        ARRAY_INLINE_AVX512 static void Store(double* p, const reg a) { _mm512_storeu_pd(p, a); }
+        ARRAY_INLINE_AVX512 static reg Set1(const double v) { return _mm512_set1_pd(v); }
+        ARRAY_INLINE_AVX512 static reg Add(const reg a, const reg b) { return _mm512_add_pd(a, b); }
+        ARRAY_INLINE_AVX512 static reg MulAdd(const reg a, const reg b, const reg c) { return _mm512_fmadd_pd(a, b, c); }
+        ARRAY_INLINE_AVX512 static reg Min(const reg a, const reg b) { return _mm512_min_pd(a, b); }
+        ARRAY_INLINE_AVX512 static reg Max(const reg a, const reg b) { return _mm512_max_pd(a, b); }
+        ARRAY_INLINE_AVX512 static reg Abs(const reg a) { return _mm512_abs_pd(a); }
+        // Fold to 256 bits and finish with the AVX2 reduction.
+        ARRAY_INLINE_AVX512 static __m256d Low(const reg a) { return _mm512_castpd512_pd256(a); }
+        ARRAY_INLINE_AVX512 static __m256d High(const reg a) { return _mm512_maskz_extractf64x4_pd(0xFF, a, 1); }
+        ARRAY_INLINE_AVX512 static double ReduceAdd(const reg a) { return Avx2Vec<double>::ReduceAdd(_mm256_add_pd(Low(a), High(a))); }
+        ARRAY_INLINE_AVX512 static double ReduceMin(const reg a) { return Avx2Vec<double>::ReduceMin(_mm256_min_pd(Low(a), High(a))); }
+        ARRAY_INLINE_AVX512 static double ReduceMax(const reg a) { return Avx2Vec<double>::ReduceMax(_mm256_max_pd(Low(a), High(a))); }
+    };
+
+    template <>
+    struct Avx512Vec<float> {
+        using scalar = float;
+        using reg = __m512;
+        static constexpr std::size_t kWidth = 16;
+
+        ARRAY_INLINE_AVX512 static reg Load(const float* p) { return _mm512_loadu_ps(p); }
+        ARRAY_INLINE_AVX512 static void Store(float* p, const reg a) { _mm512_storeu_ps(p, a); }
+        ARRAY_INLINE_AVX512 static reg Set1(const float v) { return _mm512_set1_ps(v); }
+        ARRAY_INLINE_AVX512 static reg Add(const reg a, const reg b) { return _mm512_add_ps(a, b); }
+        ARRAY_INLINE_AVX512 static reg MulAdd(const reg a, const reg b, const reg c) { return _mm512_fmadd_ps(a, b, c); }
+        ARRAY_INLINE_AVX512 static reg Min(const reg a, const reg b) { return _mm512_min_ps(a, b); }
+        ARRAY_INLINE_AVX512 static reg Max(const reg a, const reg b) { return _mm512_max_ps(a, b); }
+        ARRAY_INLINE_AVX512 static reg Abs(const reg a) { return _mm512_abs_ps(a); }
+        ARRAY_INLINE_AVX512 static __m256 Low(const reg a) { return _mm512_castps512_ps256(a); }
+        ARRAY_INLINE_AVX512 static __m256 High(const reg a) {
+            return _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xFF, _mm512_castps_pd(a), 1));
+        }
+        ARRAY_INLINE_AVX512 static float ReduceAdd(const reg a) { return Avx2Vec<float>::ReduceAdd(_mm256_add_ps(Low(a), High(a))); }
+        ARRAY_INLINE_AVX512 static float ReduceMin(const reg a) { return Avx2Vec<float>::ReduceMin(_mm256_min_ps(Low(a), High(a))); }
+        ARRAY_INLINE_AVX512 static float ReduceMax(const reg a) { return Avx2Vec<float>::ReduceMax(_mm256_max_ps(Low(a), High(a))); }
+    };
+
+    template <ReduceKind Kind, typename V>
+    ARRAY_INLINE_AVX512 void ReduceStepAvx512(typename V::reg& a, typename V::reg& b, const typename V::reg x) {
+        if constexpr (Kind == ReduceKind::Sum) {
+            a = V::Add(a, x);
+        } else if constexpr (Kind == ReduceKind::SumAbs) {
+            a = V::Add(a, V::Abs(x));
+        } else if constexpr (Kind == ReduceKind::SumSquares) {
+            a = V::MulAdd(x, x, a);
+        } else if constexpr (Kind == ReduceKind::Min) {
+            a = V::Min(x, a);
+        } else if constexpr (Kind == ReduceKind::Max) {
+            a = V::Max(x, a);
+        } else if constexpr (Kind == ReduceKind::MaxAbs) {
+            a = V::Max(V::Abs(x), a);
+        } else {
+            a = V::Min(x, a);
+            b = V::Max(x, b);
+        }
+    }
+
+    template <ReduceKind Kind, typename T>
+    ARRAY_TARGET_AVX512 void ReduceKernelAvx512(const T* p, const std::size_t n, T* result) {
+        using V = Avx512Vec<T>;
+        using R = typename V::reg;
+        constexpr std::size_t W = V::kWidth;
+        constexpr bool kIsMin = Kind == ReduceKind::Min || Kind == ReduceKind::MinMax;
+        constexpr bool kIsMax = Kind == ReduceKind::Max || Kind == ReduceKind::MaxAbs;
+
+        const R init_a = V::Set1(ReduceIdentity<Kind, T>());
+        const R init_b = V::Set1(ReduceIdentity<ReduceKind::Max, T>());
+        R a0 = init_a, a1 = init_a, a2 = init_a, a3 = init_a;
+        R b0 = init_b, b1 = init_b, b2 = init_b, b3 = init_b;
+
+        std::size_t i = 0;
+        for (; i + 4 * W <= n; i += 4 * W) {
+            ReduceStepAvx512<Kind, V>(a0, b0, V::Load(p + i));
+            ReduceStepAvx512<Kind, V>(a1, b1, V::Load(p + i + W));
+            ReduceStepAvx512<Kind, V>(a2, b2, V::Load(p + i + 2 * W));
+            ReduceStepAvx512<Kind, V>(a3, b3, V::Load(p + i + 3 * W));
+        }
+        for (; i + W <= n; i += W) {
+            ReduceStepAvx512<Kind, V>(a0, b0, V::Load(p + i));
+        }
+
+        if constexpr (kIsMin) {
+            result[0] = V::ReduceMin(V::Min(V::Min(a0, a1), V::Min(a2, a3)));
+        } else if constexpr (kIsMax) {
+            result[0] = V::ReduceMax(V::Max(V::Max(a0, a1), V::Max(a2, a3)));
+        } else {
+            result[0] = V::ReduceAdd(V::Add(V::Add(a0, a1), V::Add(a2, a3)));
+        }
+        result[1] = V::ReduceMax(V::Max(V::Max(b0, b1), V::Max(b2, b3)));
+        ReduceTail<Kind>(p, i, n, result);
+    }
+#endif
+
+    // #######################
+    // Dispatch
+    // #######################
+
+    // Reduces p[0, n) into result[0] (and result[1] for MinMax) with the widest
+    // instruction set available on this CPU.
+    template <ReduceKind Kind, typename T>
+    inline void Reduce(const T* p, const std::size_t n, T* result) {
+    #ifdef ARRAY_SIMD_X86
+        if constexpr (IsSimdFloat<T>::value) {
+            switch (ActiveSimdLevel()) {
+                case SimdLevel::AVX512:
+                    ReduceKernelAvx512<Kind>(p, n, result);
+                    return;
+                case SimdLevel::AVX2:
+                    ReduceKernelAvx2<Kind>(p, n, result);
+                    return;
+                #ifdef __SSE2__
+                case SimdLevel::SSE2:
+                    ReduceKernel<Kind, SseVec<T>>(p, n, result);
+                    return;
+                #endif
+                default:
+                    break;
+            }
+        }
+    #endif
+        ReduceKernel<Kind, ScalarVec<T>>(p, n, result);
+    }
+
+    // #######################
+    // Non-finite detection
+    // #######################
+    // IEEE-754 test on the bit pattern: with the sign bit cleared, a value is
+    // NaN iff its bits exceed the exponent mask and non-finite iff they are at
+    // least the exponent mask. Each block is scanned without branches and the
+    // exact position is only searched for once a block reports a hit.
+
+    template <typename T>
+    struct FloatBits;
+
+    template <>
+    struct FloatBits<float> {
+        using uint = std::uint32_t;
+        static constexpr uint kAbsMask = 0x7fffffffu;
+        static constexpr uint kExpMask = 0x7f800000u;
+    };
+
+    template <>
+    struct FloatBits<double> {
+        using uint = std::uint64_t;
+        static constexpr uint kAbsMask = 0x7fffffffffffffffull;
+        static constexpr uint kExpMask = 0x7ff0000000000000ull;
+    };
+
+    enum class CheckKind {
+        NaN,
+        NonFinite
+    };
+
+    template <CheckKind Kind, typename T>
+    constexpr typename FloatBits<T>::uint CheckThreshold() noexcept {
+        return Kind == CheckKind::NaN ? FloatBits<T>::kExpMask : FloatBits<T>::kExpMask - 1;
+    }
+
+    // Elements per early-exit block.
+    constexpr std::size_t kCheckBlock = 256;
+
+    template <typename T>
+    inline std::size_t FindFirstAboveScalar(const T* p, const std::size_t begin, const std::size_t end, const typename FloatBits<T>::uint threshold) {
+        using U = typename FloatBits<T>::uint;
+        for (std::size_t i = begin; i < end; ++i) {
+            U bits;
+            std::memcpy(&bits, p + i, sizeof(U));
+            if ((bits & FloatBits<T>::kAbsMask) > threshold) return i;
+        }
+        return end;
+    }
+
+    template <typename T>
+    inline std::size_t FindFirstAboveBlocked(const T* p, const std::size_t n, const typename FloatBits<T>::uint threshold) {
+        using U = typename FloatBits<T>::uint;
+        std::size_t i = 0;
+        for (; i + kCheckBlock <= n; i += kCheckBlock) {
+            bool hit = false;
+            for (std::size_t j = i; j < i + kCheckBlock; ++j) {
+                U bits;
+                std::memcpy(&bits, p + j, sizeof(U));
+                hit |= (bits & FloatBits<T>::kAbsMask) > threshold;
+            }
+            if (hit) return FindFirstAboveScalar(p, i, i + kCheckBlock, threshold);
+        }
+        return FindFirstAboveScalar(p, i, n, threshold);
+    }
+
+#ifdef ARRAY_SIMD_X86
+    template <typename T>
+    ARRAY_TARGET_AVX2 std::size_t FindFirstAboveAvx2(const T* p, const std::size_t n, const typename FloatBits<T>::uint threshold) {
+        constexpr std::size_t W = 32 / sizeof(T);
+        constexpr bool kIs64 = sizeof(T) == 8;
+        const __m256i abs_mask = kIs64 ? _mm256_set1_epi64x(static_cast<long long>(FloatBits<T>::kAbsMask))
+                                       : _mm256_set1_epi32(static_cast<int>(FloatBits<T>::kAbsMask));
+        const __m256i limit = kIs64 ? _mm256_set1_epi64x(static_cast<long long>(threshold))
+                                    : _mm256_set1_epi32(static_cast<int>(threshold));
+        std::size_t i = 0;
+        for (; i + kCheckBlock <= n; i += kCheckBlock) {
+            __m256i hit = _mm256_setzero_si256();
+            for (std::size_t j = i; j < i + kCheckBlock; j += W) {
+                const __m256i bits = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + j)), abs_mask);
+                hit = _mm256_or_si256(hit, kIs64 ? _mm256_cmpgt_epi64(bits, limit) : _mm256_cmpgt_epi32(bits, limit));
+            }
+            if (!_mm256_testz_si256(hit, hit)) return FindFirstAboveScalar(p, i, i + kCheckBlock, threshold);
+        }
+        return FindFirstAboveScalar(p, i, n, threshold);
+    }
+
+    template <typename T>
+    ARRAY_TARGET_AVX512 std::size_t FindFirstAboveAvx512(const T* p, const std::size_t n, const typename FloatBits<T>::uint threshold) {
+        constexpr std::size_t W = 64 / sizeof(T);
+        constexpr bool kIs64 = sizeof(T) == 8;
+        const __m512i abs_mask = kIs64 ? _mm512_set1_epi64(static_cast<long long>(FloatBits<T>::kAbsMask))
+                                       : _mm512_set1_epi32(static_cast<int>(FloatBits<T>::kAbsMask));
+        const __m512i limit = kIs64 ? _mm512_set1_epi64(static_cast<long long>(threshold))
+                                    : _mm512_set1_epi32(static_cast<int>(threshold));
+        std::size_t i = 0;
+        for (; i + kCheckBlock <= n; i += kCheckBlock) {
+            unsigned hit = 0;
+            for (std::size_t j = i; j < i + kCheckBlock; j += W) {
+                const __m512i bits = _mm512_and_si512(_mm512_loadu_si512(p + j), abs_mask);
+                hit |= kIs64 ? static_cast<unsigned>(_mm512_cmpgt_epi64_mask(bits, limit))
+                             : static_cast<unsigned>(_mm512_cmpgt_epi32_mask(bits, limit));
+            }
+            if (hit != 0) return FindFirstAboveScalar(p, i, i + kCheckBlock, threshold);
+        }
+        return FindFirstAboveScalar(p, i, n, threshold);
+    }
+#endif
+
+    // Offset of the first NaN (CheckKind::NaN) or NaN/Inf (CheckKind::NonFinite)
+    // element of p[0, n), or n if there is none.
+    template <CheckKind Kind, typename T>
+    inline std::size_t FindFirstNonFinite(const T* p, const std::size_t n) {
+        static_assert(IsSimdFloat<T>::value, "FindFirstNonFinite requires float or double");
+        constexpr typename FloatBits<T>::uint threshold = CheckThreshold<Kind, T>();
+    #ifdef ARRAY_SIMD_X86
+        switch (ActiveSimdLevel()) {
+            case SimdLevel::AVX512:
+                return FindFirstAboveAvx512(p, n, threshold);
+            case SimdLevel::AVX2:
+                return FindFirstAboveAvx2(p, n, threshold);
+            default:
+                break;
+        }
+    #endif
+        return FindFirstAboveBlocked(p, n, threshold);
+    }
+
+    // #######################
+    // Transpose tiles
+    // #######################
+    // dst[c * dst_ld + r] = src[r * src_ld + c] for r < rows, c < cols. The
+    // AVX2 kernels move elements as raw 4- or 8-byte lanes (8x8 resp. 4x4
+    // register transposes), so they serve any trivially copyable type of that
+    // size; partial micro tiles at the edges are copied by the scalar loop.
+
+    template <typename T>
+    struct IsTransposeLane : std::integral_constant<bool,
+        std::is_trivially_copyable<T>::value && (sizeof(T) == 4 || sizeof(T) == 8)> { };
+
+    template <typename T>
+    inline void TransposeTileScalar(const T* src, const std::size_t src_ld, T* dst, const std::size_t dst_ld,
+                                    const std::size_t rows, const std::size_t cols) {
+        for (std::size_t c = 0; c < cols; ++c) {
+            for (std::size_t r = 0; r < rows; ++r) {
+                dst[c * dst_ld + r] = src[r * src_ld + c];
+            }
+        }
+    }
+
+#ifdef ARRAY_SIMD_X86
+    ARRAY_INLINE_AVX2 void Transpose4x4Avx2(const double* s, const std::size_t sld, double* d, const std::size_t dld) {
+        const __m256d r0 = _mm256_loadu_pd(s);
+        const __m256d r1 = _mm256_loadu_pd(s + sld);
+        const __m256d r2 = _mm256_loadu_pd(s + 2 * sld);
+        const __m256d r3 = _mm256_loadu_pd(s + 3 * sld);
+        const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+        _mm256_storeu_pd(d, _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(d + dld, _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(d + 2 * dld, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(d + 3 * dld, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+
+    ARRAY_INLINE_AVX2 void Transpose8x8Avx2(const float* s, const std::size_t sld, float* d, const std::size_t dld) {
+        const __m256 r0 = _mm256_loadu_ps(s);
+        const __m256 r1 = _mm256_loadu_ps(s + sld);
+        const __m256 r2 = _mm256_loadu_ps(s + 2 * sld);
+        const __m256 r3 = _mm256_loadu_ps(s + 3 * sld);
+        const __m256 r4 = _mm256_loadu_ps(s + 4 * sld);
+        const __m256 r5 = _mm256_loadu_ps(s + 5 * sld);
+        const __m256 r6 = _mm256_loadu_ps(s + 6 * sld);
+        const __m256 r7 = _mm256_loadu_ps(s + 7 * sld);
+        const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+        const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+        const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+        const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+        const __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+        const __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+        const __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+        const __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+        const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_storeu_ps(d, _mm256_permute2f128_ps(u0, u4, 0x20));
+        _mm256_storeu_ps(d + dld, _mm256_permute2f128_ps(u1, u5, 0x20));
+        _mm256_storeu_ps(d + 2 * dld, _mm256_permute2f128_ps(u2, u6, 0x20));
+        _mm256_storeu_ps(d + 3 * dld, _mm256_permute2f128_ps(u3, u7, 0x20));
+        _mm256_storeu_ps(d + 4 * dld, _mm256_permute2f128_ps(u0, u4, 0x31));
+        _mm256_storeu_ps(d + 5 * dld, _mm256_permute2f128_ps(u1, u5, 0x31));
+        _mm256_storeu_ps(d + 6 * dld, _mm256_permute2f128_ps(u2, u6, 0x31));
+        _mm256_storeu_ps(d + 7 * dld, _mm256_permute2f128_ps(u3, u7, 0x31));
+    }
+
+    template <typename T>
+    ARRAY_TARGET_AVX2 void TransposeTileAvx2(const T* src, const std::size_t src_ld, T* dst, const std::size_t dst_ld,
+                                             const std::size_t rows, const std::size_t cols) {
+        using Lane = std::conditional_t<sizeof(T) == 8, double, float>;
+        constexpr std::size_t W = 32 / sizeof(T);
+        const Lane* s = reinterpret_cast<const Lane*>(src);
+        Lane* d = reinterpret_cast<Lane*>(dst);
+        const std::size_t rows_w = rows - rows % W;
+        const std::size_t cols_w = cols - cols % W;
+        for (std::size_t r = 0; r < rows_w; r += W) {
+            for (std::size_t c = 0; c < cols_w; c += W) {
+                if constexpr (sizeof(T) == 8) {
+                    Transpose4x4Avx2(s + r * src_ld + c, src_ld, d + c * dst_ld + r, dst_ld);
+                } else {
+                    Transpose8x8Avx2(s + r * src_ld + c, src_ld, d + c * dst_ld + r, dst_ld);
+                }
+            }
+        }
+        if (cols_w < cols) {
+            TransposeTileScalar(src + cols_w, src_ld, dst + cols_w * dst_ld, dst_ld, rows, cols - cols_w);
+        }
+        if (rows_w < rows) {
+            TransposeTileScalar(src + rows_w * src_ld, src_ld, dst + rows_w, dst_ld, rows - rows_w, cols_w);
+        }
+    }
+#endif
+
+    template <typename T>
+    inline void TransposeTile(const T* src, const std::size_t src_ld, T* dst, const std::size_t dst_ld,
+                              const std::size_t rows, const std::size_t cols) {
+    #ifdef ARRAY_SIMD_X86
+        if constexpr (IsTransposeLane<T>::value) {
+            if (ActiveSimdLevel() >= SimdLevel::AVX2) {
+                TransposeTileAvx2(src, src_ld, dst, dst_ld, rows, cols);
+                return;
+            }
+        }
+    #endif
+        TransposeTileScalar(src, src_ld, dst, dst_ld, rows, cols);
+    }
+
+    // #######################
+    // GEMM micro-kernels
+    // #######################
+    // ab[i * NR + j] = sum_p a[p * MR + i] * b[p * NR + j]: the MR x NR product
+    // of a packed MR x kc sliver of A and a packed kc x NR sliver of B, kept in
+    // registers for the whole kc loop. The SIMD kernels hold two vectors per
+    // row of the tile (NR = 2 * width), i.e. 2 * MR accumulators.
+
+    constexpr std::size_t kGemmMaxTile = 12 * 32;
+
+    template <typename T, std::size_t MR, std::size_t NR>
+    void GemmKernelScalar(const std::size_t kc, const T* a, const T* b, T* ab) {
+        T acc[MR * NR] = {};
+        for (std::size_t p = 0; p < kc; ++p) {
+            for (std::size_t i = 0; i < MR; ++i) {
+                const T ai = a[i];
+                for (std::size_t j = 0; j < NR; ++j) {
+                    acc[i * NR + j] += ai * b[j];
+                }
+            }
+            a += MR;
+            b += NR;
+        }
+        std::copy(acc, acc + MR * NR, ab);
+    }
+
+#ifdef ARRAY_SIMD_X86
+    template <typename T, std::size_t MR>
+    ARRAY_TARGET_AVX2 void GemmKernelAvx2(const std::size_t kc, const T* a, const T* b, T* ab) {
+        using V = Avx2Vec<T>;
+        using R = typename V::reg;
+        constexpr std::size_t W = V::kWidth;
+        R c[MR][2];
+        #pragma GCC unroll 16
+        for (std::size_t i = 0; i < MR; ++i) {
+            c[i][0] = V::Set1(T(0));
+            c[i][1] = V::Set1(T(0));
+        }
+        for (std::size_t p = 0; p < kc; ++p) {
+            const R b0 = V::Load(b);
+            const R b1 = V::Load(b + W);
+            #pragma GCC unroll 16
+            for (std::size_t i = 0; i < MR; ++i) {
+                const R ai = V::Set1(a[i]);
+                c[i][0] = V::MulAdd(ai, b0, c[i][0]);
+                c[i][1] = V::MulAdd(ai, b1, c[i][1]);
+            }
+            a += MR;
+            b += 2 * W;
+        }
+        #pragma GCC unroll 16
+        for (std::size_t i = 0; i < MR; ++i) {
+            V::Store(ab + i * 2 * W, c[i][0]);
+            V::Store(ab + i * 2 * W + W, c[i][1]);
+        }
+    }
+
+    template <typename T, std::size_t MR>
+    ARRAY_TARGET_AVX512 void GemmKernelAvx512(const std::size_t kc, const T* a, const T* b, T* ab) {
+        using V = Avx512Vec<T>;
+        using R = typename V::reg;
+        constexpr std::size_t W = V::kWidth;
+        R c[MR][2];
+        #pragma GCC unroll 16
+        for (std::size_t i = 0; i < MR; ++i) {
+            c[i][0] = V::Set1(T(0));
+            c[i][1] = V::Set1(T(0));
+        }
+        for (std::size_t p = 0; p < kc; ++p) {
+            const R b0 = V::Load(b);
+            const R b1 = V::Load(b + W);
+            #pragma GCC unroll 16
+            for (std::size_t i = 0; i < MR; ++i) {
+                const R ai = V::Set1(a[i]);
+                c[i][0] = V::MulAdd(ai, b0, c[i][0]);
+                c[i][1] = V::MulAdd(ai, b1, c[i][1]);
+            }
+            a += MR;
+            b += 2 * W;
+        }
+        #pragma GCC unroll 16
+        for (std::size_t i = 0; i < MR; ++i) {
+            V::Store(ab + i * 2 * W, c[i][0]);
+            V::Store(ab + i * 2 * W + W, c[i][1]);
+        }
+    }
+#endif
+
+    // Micro-kernel chosen for T on this CPU with its tile shape (mr x nr).
+    template <typename T>
+    struct GemmKernel {
+        std::size_t mr;
+        std::size_t nr;
+        void (*run)(std::size_t kc, const T* a, const T* b, T* ab);
+    };
+
+    template <typename T>
+    inline GemmKernel<T> SelectGemmKernel() noexcept {
+    #ifdef ARRAY_SIMD_X86
+        if constexpr (IsSimdFloat<T>::value) {
+            switch (ActiveSimdLevel()) {
+                case SimdLevel::AVX512:
+                    return {12, 2 * Avx512Vec<T>::kWidth, &GemmKernelAvx512<T, 12>};
+                case SimdLevel::AVX2:
+                    return {6, 2 * Avx2Vec<T>::kWidth, &GemmKernelAvx2<T, 6>};
+                default:
+                    break;
+            }
+        }
+    #endif
+        return {4, 8, &GemmKernelScalar<T, 4, 8>};
+    }
+}
+}
+
+#endif /* SIMD_HPP_ */
@@ -0,0 +1,549 @@
+#ifndef STENCIL_HPP_
+#define STENCIL_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "allocator.hpp"
+#include "array_view.hpp"
+#include "layout.hpp"
+#include "loop.hpp"
+#include "parallel.hpp"
+
+namespace array {
+
+    // #######################
+    // Stencil
+    // #######################
+    // Linear stencil out(x) = sum_k coefficient_k * in(x + offset_k), e.g.
+    //     Stencil<double, 3> s = Stencil<double, 3>::Laplacian(nu * dt / (dx * dx));
+    //     s.Add({0, 0, 0}, 1.0);   // explicit diffusion step u + c * Lu
+    template <typename T, std::size_t Rank>
+    class Stencil {
+    public:
+        using offset_type = std::array<std::ptrdiff_t, Rank>;
+
+        struct Term {
+            offset_type offset;
+            T coefficient;
+        };
+
+        Stencil() = default;
+
+        Stencil(std::initializer_list<Term> terms) {
+            for (const Term& term : terms) {
+                Add(term.offset, term.coefficient);
+            }
+        }
+
+        // Adds `coefficient` to the term at `offset`, creating it if needed.
+        Stencil& Add(const offset_type& offset, const T coefficient) {
+            for (Term& term : terms_) {
+                if (term.offset == offset) {
+                    term.coefficient += coefficient;
+                    return *this;
+                }
+            }
+            terms_.push_back({offset, coefficient});
+            return *this;
+        }
+
+        inline const std::vector<Term>& Terms() const noexcept { return terms_; }
+        inline std::size_t NumTerms() const noexcept { return terms_.size(); }
+
+        // Largest |offset| along any axis, i.e. the ghost width the stencil needs.
+        std::size_t Radius() const noexcept {
+            std::size_t radius = 0;
+            for (const Term& term : terms_) {
+                for (const std::ptrdiff_t o : term.offset) {
+                    radius = std::max(radius, static_cast<std::size_t>(o < 0 ? -o : o));
+                }
+            }
+            return radius;
+        }
+
+        // Second-order (2 * Rank + 1)-point Laplacian, scaled:
+        // scale * sum_axis (in(x - e_axis) - 2 in(x) + in(x + e_axis)).
+        static Stencil Laplacian(const T scale = T(1)) {
+            Stencil stencil;
+            stencil.Add(offset_type{}, -static_cast<T>(2 * Rank) * scale);
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                offset_type offset{};
+                offset[axis] = -1;
+                stencil.Add(offset, scale);
+                offset[axis] = 1;
+                stencil.Add(offset, scale);
+            }
+            return stencil;
+        }
+
+    private:
+        std::vector<Term> terms_;
+    };
+
+    // #######################
+    // Neighborhood
+    // #######################
+    // Input values around one point, as seen by the lambda form of
+    // ApplyStencil: u(di, dj, dk) is the input at offset (di, dj, dk).
+    template <typename T, std::size_t Rank>
+    class Neighborhood {
+    public:
+        Neighborhood(const T* center, const std::array<std::ptrdiff_t, Rank>& strides) noexcept
+        : center_(center), strides_(strides) { }
+
+        template <typename... Offsets>
+        inline const T& operator()(const Offsets... offsets) const noexcept {
+            static_assert(sizeof...(Offsets) == Rank, "Neighborhood: wrong number of offsets");
+            std::size_t axis = 0;
+            std::ptrdiff_t offset = 0;
+            ((offset += static_cast<std::ptrdiff_t>(offsets) * strides_[axis++]), ...);
+            return center_[offset];
+        }
+
+        inline const T& Center() const noexcept { return *center_; }
+
+    private:
+        const T* center_;
+        const std::array<std::ptrdiff_t, Rank>& strides_;
+    };
+
+    namespace detail {
+
+        // Per-thread, per-buffer budget of the tiles of temporal blocking.
+        constexpr std::size_t kStencilScratchBytes = std::size_t(1) << 20;
+
+        template <std::size_t Rank>
+        inline std::size_t FlatOffset(const std::array<std::size_t, Rank>& index, const std::array<std::size_t, Rank>& strides) noexcept {
+            std::size_t offset = 0;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                offset += index[axis] * strides[axis];
+            }
+            return offset;
+        }
+
+        // Offset of array point `index` in a buffer holding the box starting at `origin`.
+        template <std::size_t Rank>
+        inline std::size_t LocalOffset(const std::array<std::size_t, Rank>& index, const std::array<std::size_t, Rank>& origin,
+                                       const std::array<std::size_t, Rank>& strides) noexcept {
+            std::size_t offset = 0;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                offset += (index[axis] - origin[axis]) * strides[axis];
+            }
+            return offset;
+        }
+
+        template <std::size_t Rank>
+        inline std::array<std::ptrdiff_t, Rank> SignedStrides(const std::array<std::size_t, Rank>& strides) noexcept {
+            std::array<std::ptrdiff_t, Rank> result;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                result[axis] = static_cast<std::ptrdiff_t>(strides[axis]);
+            }
+            return result;
+        }
+
+        // Points at least `ghost` cells away from every face.
+        template <std::size_t Rank>
+        IndexRange<Rank> InteriorOf(const std::array<std::size_t, Rank>& shape, const std::size_t ghost) noexcept {
+            std::array<std::size_t, Rank> begin, end;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                begin[axis] = ghost;
+                end[axis] = shape[axis] > ghost ? shape[axis] - ghost : 0;
+            }
+            return IndexRange<Rank>(begin, end);
+        }
+
+        // Tile of the stencil sweeps: whole rows along the innermost axis, 16
+        // rows of the axis next to it and 32 along the others, so the planes
+        // a 3-D stencil reads around a row stay in L2.
+        template <std::size_t Rank, typename Layout>
+        inline std::array<std::size_t, Rank> StencilTile() noexcept {
+            std::array<std::size_t, Rank> tile;
+            tile.fill(32);
+            tile[InnermostAxis<Layout, Rank>()] = 0;
+            if constexpr (Rank >= 2) {
+                tile[Layout::kIsColumnMajor ? 1 : Rank - 2] = 16;
+            }
+            return tile;
+        }
+
+        // Calls row(index, length) for every row of `box` along the innermost
+        // axis of Layout, index being the first point of the row.
+        template <typename Layout, std::size_t Rank, typename F>
+        void ForEachRow(const IndexRange<Rank>& box, F&& row) {
+            if (box.IsEmpty()) return;
+            std::array<std::size_t, Rank> index = box.Begin();
+            const std::size_t length = box.Extent(InnermostAxis<Layout, Rank>());
+            for (;;) {
+                row(index, length);
+                std::size_t k = 1;
+                for (; k < Rank; ++k) {
+                    const std::size_t axis = Layout::kIsColumnMajor ? k : Rank - 1 - k;
+                    if (++index[axis] < box.End(axis)) break;
+                    index[axis] = box.Begin(axis);
+                }
+                if (k == Rank) return;
+            }
+        }
+
+        // Row kernel of a Stencil bound to the strides of a buffer:
+        // d[i] = sum_k c_k * s[i + offset_k] for i < n. Terms are summed up to
+        // eight at a time (a 7-point or 2-D 9-point stencil is a single pass),
+        // each pass being a unit-stride loop the compiler vectorizes.
+        template <typename T, std::size_t Rank>
+        class StencilRowKernel {
+        public:
+            StencilRowKernel(const Stencil<T, Rank>& stencil, const std::array<std::size_t, Rank>& strides) {
+                const std::array<std::ptrdiff_t, Rank> signed_strides = SignedStrides(strides);
+                for (const auto& term : stencil.Terms()) {
+                    std::ptrdiff_t offset = 0;
+                    for (std::size_t axis = 0; axis < Rank; ++axis) {
+                        offset += term.offset[axis] * signed_strides[axis];
+                    }
+                    offsets_.push_back(offset);
+                    coefficients_.push_back(term.coefficient);
+                }
+            }
+
+            void operator()(const T* s, T* d, const std::size_t n) const {
+                const std::size_t num_terms = offsets_.size();
+                if (num_terms == 0) {
+                    std::fill(d, d + n, T(0));
+                    return;
+                }
+                for (std::size_t k = 0; k < num_terms; k += kTermsPerPass) {
+                    PassUpTo<kTermsPerPass>(std::min(kTermsPerPass, num_terms - k), s, d, n, k);
+                }
+            }
+
+        private:
+            static constexpr std::size_t kTermsPerPass = 8;
+
+            std::vector<std::ptrdiff_t> offsets_;
+            std::vector<T> coefficients_;
+
+            template <std::size_t M>
+            void PassUpTo(const std::size_t m, const T* s, T* d, const std::size_t n, const std::size_t k) const {
+                if constexpr (M > 1) {
+                    if (m < M) {
+                        PassUpTo<M - 1>(m, s, d, n, k);
+                        return;
+                    }
+                }
+                Pass<M>(s, d, n, k);
+            }
+
+            template <std::size_t M>
+            void Pass(const T* s, T* d, const std::size_t n, const std::size_t k) const {
+                const T* p[M];
+                T c[M];
+                for (std::size_t j = 0; j < M; ++j) {
+                    p[j] = s + offsets_[k + j];
+                    c[j] = coefficients_[k + j];
+                }
+                if (k == 0) {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        T sum = c[0] * p[0][i];
+                        for (std::size_t j = 1; j < M; ++j) sum += c[j] * p[j][i];
+                        d[i] = sum;
+                    }
+                } else {
+                    for (std::size_t i = 0; i < n; ++i) {
+                        T sum = d[i];
+                        for (std::size_t j = 0; j < M; ++j) sum += c[j] * p[j][i];
+                        d[i] = sum;
+                    }
+                }
+            }
+        };
+
+        // Row kernel of a user function over a Neighborhood.
+        template <typename T, std::size_t Rank, typename F>
+        class LambdaRowKernel {
+        public:
+            LambdaRowKernel(F& f, const std::array<std::size_t, Rank>& strides) : f_(f), strides_(SignedStrides(strides)) { }
+
+            void operator()(const T* s, T* d, const std::size_t n) const {
+                for (std::size_t i = 0; i < n; ++i) {
+                    d[i] = f_(Neighborhood<T, Rank>(s + i, strides_));
+                }
+            }
+
+        private:
+            F& f_;
+            std::array<std::ptrdiff_t, Rank> strides_;
+        };
+
+        template <typename T, std::size_t Rank>
+        void CheckStencilArrays(const ArrayView<const T, Rank>& src, const ArrayView<T, Rank>& dst,
+                                const std::size_t ghost, const std::size_t radius) {
+            if (src.Shape() != dst.Shape()) {
+                throw std::invalid_argument("ApplyStencil: src and dst shapes differ");
+            }
+            if (radius > ghost) {
+                throw std::invalid_argument("ApplyStencil: stencil radius exceeds the ghost width");
+            }
+            if (!src.IsEmpty() && src.Data() == dst.Data()) {
+                throw std::invalid_argument("ApplyStencil: src and dst must be different arrays");
+            }
+        }
+
+        // dst = kernel(src) on `box`; the kernel is bound to the strides of src,
+        // dst may have other strides (e.g. another padding).
+        // Tiles of StencilTile are spread over ThreadPool::Global().
+        template <typename Layout, typename T, std::size_t Rank, typename Kernel>
+        void StencilSweep(const Kernel& kernel, const ArrayView<const T, Rank>& src, const ArrayView<T, Rank>& dst,
+                          const IndexRange<Rank>& box) {
+            ParallelForTiles<Layout>(box, StencilTile<Rank, Layout>(), [&](const IndexRange<Rank>& tile) {
+                ForEachRow<Layout>(tile, [&](const std::array<std::size_t, Rank>& index, const std::size_t length) {
+                    kernel(src.Data() + FlatOffset(index, src.Strides()), dst.Data() + FlatOffset(index, dst.Strides()), length);
+                });
+            });
+        }
+
+        // Tile of temporal blocking with a halo of `halo` cells: edge e along
+        // the outer axes and 2e along the innermost one (longer unit-stride
+        // rows), e being the largest of 256, 128, ..., 8 whose expanded box
+        // fits kStencilScratchBytes and which is at least 4 * halo, so that
+        // the redundant work on the halo stays moderate. All zero if none is.
+        template <typename T, typename Layout, std::size_t Rank>
+        std::array<std::size_t, Rank> TemporalTile(const std::array<std::size_t, Rank>& shape, const std::size_t halo) noexcept {
+            std::array<std::size_t, Rank> tile;
+            for (std::size_t edge = 256; edge >= 8 && edge >= 4 * halo; edge /= 2) {
+                tile.fill(edge);
+                tile[InnermostAxis<Layout, Rank>()] = 2 * edge;
+                std::size_t bytes = sizeof(T);
+                for (std::size_t axis = 0; axis < Rank; ++axis) {
+                    bytes *= std::min(shape[axis], tile[axis] + 2 * halo);
+                }
+                if (bytes <= kStencilScratchBytes) return tile;
+            }
+            tile.fill(0);
+            return tile;
+        }
+
+        // `steps` fused stencil steps from src to dst (temporal blocking).
+        // The interior is cut into tiles of TemporalTile. Each tile is
+        // advanced in two per-thread buffers holding it with a halo of
+        // steps * radius cells, the updated region shrinking by `radius` per
+        // step, until only the tile itself is left and written to dst. Cells
+        // outside the interior keep their src values throughout. A row kernel
+        // applies strides to its input only, so `bind(strides)` is called for
+        // src and for the buffers, and rows are written wherever they go.
+        template <typename Layout, typename T, std::size_t Rank, typename Bind>
+        void StencilSweepTemporal(const Bind& bind, const ArrayView<const T, Rank>& src, const ArrayView<T, Rank>& dst,
+                                  const std::size_t ghost, const std::size_t radius, const std::size_t steps) {
+            using index_array = std::array<std::size_t, Rank>;
+            const index_array& shape = src.Shape();
+            const IndexRange<Rank> interior = InteriorOf(shape, ghost);
+            if (interior.IsEmpty()) return;
+
+            const std::size_t halo = steps * radius;
+            index_array tile = TemporalTile<T, Layout>(shape, halo);
+            index_array counts;
+            std::size_t num_tiles = 1;
+            std::size_t box_elements = 1;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                box_elements *= std::min(shape[axis], tile[axis] + 2 * halo);
+                tile[axis] = std::min(tile[axis], interior.Extent(axis));
+                counts[axis] = (interior.Extent(axis) + tile[axis] - 1) / tile[axis];
+                num_tiles *= counts[axis];
+            }
+
+            ThreadPool& pool = ThreadPool::Global();
+            const bool parallel = interior.Size() * steps >= kParallelLoopThreshold && pool.NumThreads() > 1 && num_tiles > 1;
+            const std::size_t num_threads = parallel ? pool.NumThreads() : 1;
+            std::vector<std::vector<T, AlignedAllocator<T>>> buffers(2 * num_threads);
+            std::atomic<std::size_t> next_tile(0);
+
+            const auto src_kernel = bind(src.Strides());
+            auto work = [&](const std::size_t thread, std::size_t) {
+                std::vector<T, AlignedAllocator<T>>& buffer_a = buffers[2 * thread];
+                std::vector<T, AlignedAllocator<T>>& buffer_b = buffers[2 * thread + 1];
+                buffer_a.resize(box_elements);
+                buffer_b.resize(box_elements);
+                for (;;) {
+                    const std::size_t t = next_tile.fetch_add(1, std::memory_order_relaxed);
+                    if (t >= num_tiles) return;
+                    const IndexRange<Rank> own = TileAt<Layout>(interior, tile, counts, t);
+
+                    // Expanded box [lo, hi) in array coordinates, stored densely in the buffers.
+                    index_array lo, hi, extent;
+                    for (std::size_t axis = 0; axis < Rank; ++axis) {
+                        lo[axis] = own.Begin(axis) - std::min(own.Begin(axis), halo);
+                        hi[axis] = std::min(shape[axis], own.End(axis) + halo);
+                        extent[axis] = hi[axis] - lo[axis];
+                    }
+                    const index_array strides = LayoutStrides<Layout, Rank>(extent);
+                    const auto local_kernel = bind(strides);
+                    T* a = buffer_a.data();
+                    T* b = buffer_b.data();
+                    // Cells outside the interior are read by later steps but never
+                    // updated: copy the ones inside the box to both buffers.
+                    bool touches_boundary = false;
+                    for (std::size_t axis = 0; axis < Rank; ++axis) {
+                        touches_boundary |= lo[axis] < interior.Begin(axis) || hi[axis] > interior.End(axis);
+                    }
+                    if (touches_boundary) {
+                        constexpr std::size_t inner = InnermostAxis<Layout, Rank>();
+                        auto copy = [&](index_array index, const std::size_t begin, const std::size_t end) {
+                            if (begin >= end) return;
+                            index[inner] = begin;
+                            const T* row = src.Data() + FlatOffset(index, src.Strides());
+                            const std::size_t offset = LocalOffset(index, lo, strides);
+                            std::copy(row, row + (end - begin), a + offset);
+                            std::copy(row, row + (end - begin), b + offset);
+                        };
+                        ForEachRow<Layout>(IndexRange<Rank>(lo, hi), [&](const index_array& index, std::size_t) {
+                            bool ghost_row = false;
+                            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                                if (axis != inner) ghost_row |= index[axis] < interior.Begin(axis) || index[axis] >= interior.End(axis);
+                            }
+                            if (ghost_row) {
+                                copy(index, lo[inner], hi[inner]);
+                            } else {
+                                copy(index, lo[inner], std::min(hi[inner], interior.Begin(inner)));
+                                copy(index, std::max(lo[inner], interior.End(inner)), hi[inner]);
+                            }
+                        });
+                    }
+
+                    // The first step reads src and the last one writes dst
+                    // directly; the steps in between go from buffer to buffer.
+                    for (std::size_t step = 1; step <= steps; ++step) {
+                        const std::size_t reach = (steps - step) * radius;
+                        index_array begin, end;
+                        for (std::size_t axis = 0; axis < Rank; ++axis) {
+                            begin[axis] = std::max(ghost, own.Begin(axis) - std::min(own.Begin(axis), reach));
+                            end[axis] = std::min(interior.End(axis), own.End(axis) + reach);
+                        }
+                        const bool first = step == 1;
+                        const bool last = step == steps;
+                        const auto& kernel = first ? src_kernel : local_kernel;
+                        ForEachRow<Layout>(IndexRange<Rank>(begin, end), [&](const index_array& index, const std::size_t length) {
+                            const T* in = first ? src.Data() + FlatOffset(index, src.Strides()) : a + LocalOffset(index, lo, strides);
+                            T* out = last ? dst.Data() + FlatOffset(index, dst.Strides()) : b + LocalOffset(index, lo, strides);
+                            kernel(in, out, length);
+                        });
+                        std::swap(a, b);
+                    }
+                }
+            };
+            if (parallel) {
+                pool.Run(work);
+            } else {
+                work(0, 1);
+            }
+        }
+
+        template <typename Layout, typename A, typename Bind>
+        void IterateStencil(const Bind& bind, A& u, A& work, const std::size_t ghost, const std::size_t radius,
+                            const std::size_t steps, const std::size_t time_block) {
+            work.ResizeLike(u);
+            work.Copy(u);
+            const A& current = u;
+            const auto shape = current.View().Shape();
+            const auto interior = InteriorOf(shape, ghost);
+            using T = typename decltype(current.View())::value_type;
+            for (std::size_t done = 0; done < steps;) {
+                // Fewer fused steps when the halo would not leave a sensible tile.
+                std::size_t fused = std::min(std::max<std::size_t>(time_block, 1), steps - done);
+                while (fused > 1 && TemporalTile<T, Layout>(shape, fused * radius)[0] == 0) {
+                    --fused;
+                }
+                const auto in = current.View();
+                const auto out = work.View();
+                if (fused == 1) {
+                    StencilSweep<Layout>(bind(in.Strides()), in, out, interior);
+                } else {
+                    StencilSweepTemporal<Layout>(bind, in, out, ghost, radius, fused);
+                }
+                u.Swap(work);
+                done += fused;
+            }
+        }
+    }
+
+    // #######################
+    // ApplyStencil
+    // #######################
+    // dst = stencil(src) on the interior of src, the points at least `ghost`
+    // cells away from every face; the ghost cells of dst are left untouched.
+    // The ghost cells of src must hold the boundary values (boundary
+    // conditions, halo exchange) and the stencil radius must not exceed
+    // `ghost`. Works on any array with View() (Array1D..Array6D, either layout).
+    template <typename T, std::size_t Rank, typename A>
+    void ApplyStencil(const Stencil<T, Rank>& stencil, const A& src, A& dst, const std::size_t ghost) {
+        using Layout = typename LayoutOf<A>::type;
+        const ArrayView<const T, Rank> in = src.View();
+        const ArrayView<T, Rank> out = dst.View();
+        detail::CheckStencilArrays(in, out, ghost, stencil.Radius());
+        detail::StencilSweep<Layout>(detail::StencilRowKernel<T, Rank>(stencil, in.Strides()), in, out, detail::InteriorOf(in.Shape(), ghost));
+    }
+
+    // Same with dst(x) = f(u), u being the Neighborhood of x in src. f may read
+    // offsets up to `ghost` and is called concurrently from several threads.
+    //     ApplyStencil(u, v, 1, [c](const auto& n) {
+    //         return n(0, 0, 0) + c * (n(-1, 0, 0) + n(1, 0, 0) - 2.0 * n(0, 0, 0));
+    //     });
+    template <typename A, typename F>
+    void ApplyStencil(const A& src, A& dst, const std::size_t ghost, F&& f) {
+        using Layout = typename LayoutOf<A>::type;
+        const auto in = src.View();
+        const auto out = dst.View();
+        using T = typename decltype(out)::value_type;
+        constexpr std::size_t Rank = decltype(out)::NumDimensions();
+        detail::CheckStencilArrays(in, out, ghost, ghost);
+        detail::StencilSweep<Layout>(detail::LambdaRowKernel<T, Rank, std::remove_reference_t<F>>(f, in.Strides()), in, out, detail::InteriorOf(in.Shape(), ghost));
+    }
+
+    // #######################
+    // IterateStencil
+    // #######################
+    // Advances u by `steps` applications of the stencil with its ghost cells
+    // held fixed; u holds the result and `work` (resized as needed) is scratch.
+    // time_block > 1 fuses that many steps per pass over memory (temporal
+    // blocking, see detail::StencilSweepTemporal): main memory is read and
+    // written once per time_block steps instead of once per step, at the
+    // price of some redundant work at tile borders. It pays off when the
+    // sweep is bandwidth bound (arrays well beyond the last-level cache, all
+    // cores busy) and costs time when it is not. Fusing is only valid while
+    // the ghost cells stay constant (fixed boundary values); when they change
+    // every step (periodic or exchanged halos), refresh them between calls
+    // with time_block = 1.
+    template <typename T, std::size_t Rank, typename A>
+    void IterateStencil(const Stencil<T, Rank>& stencil, A& u, A& work, const std::size_t ghost, const std::size_t steps,
+                        const std::size_t time_block = 1) {
+        using Layout = typename LayoutOf<A>::type;
+        if (stencil.Radius() > ghost) {
+            throw std::invalid_argument("IterateStencil: stencil radius exceeds the ghost width");
+        }
+        auto bind = [&stencil](const std::array<std::size_t, Rank>& strides) {
+            return detail::StencilRowKernel<T, Rank>(stencil, strides);
+        };
+        detail::IterateStencil<Layout>(bind, u, work, ghost, stencil.Radius(), steps, time_block);
+    }
+
+    // Lambda form; f may read offsets up to `ghost`, which is also the radius
+    // the temporal blocking assumes.
+    template <typename A, typename F>
+    void IterateStencil(A& u, A& work, const std::size_t ghost, const std::size_t steps, const std::size_t time_block, F&& f) {
+        using Layout = typename LayoutOf<A>::type;
+        using view_type = decltype(u.View());
+        using T = typename view_type::value_type;
+        constexpr std::size_t Rank = view_type::NumDimensions();
+        auto bind = [&f](const std::array<std::size_t, Rank>& strides) {
+            return detail::LambdaRowKernel<T, Rank, std::remove_reference_t<F>>(f, strides);
+        };
+        detail::IterateStencil<Layout>(bind, u, work, ghost, ghost, steps, time_block);
+    }
+}
+
+#endif /* STENCIL_HPP_ */
@@ -38,7 +38,99 @@ void add3(const array::Array3D<double> &a, const array::Array3D<double> &b, arra
 }
 
 
+void add3_parallel(const array::Array3D<double> &a, const array::Array3D<double> &b, array::Array3D<double> &c) {
+    array::ForEachIndex(c, [&](std::size_t i, std::size_t j, std::size_t k) {
+        c(i, j, k) = a(i, j, k) + b(i, j, k);
+    });
+    return;
+}
+
+
+// ForEachIndex nested in a pool job, or under a SerialScope, runs on the
+// calling thread alone and must still visit every index.
+bool foreach_serial_scope() {
+    array::Array2D<int> a(512, 512, 0);
+    array::ThreadPool::SerialScope serial;
+    array::ForEachIndex(a, [&](std::size_t i, std::size_t j) { a(i, j) += 1; });
+    for (std::size_t i = 0; i < a.Dim1(); ++i) {
+        for (std::size_t j = 0; j < a.Dim2(); ++j) {
+            if (a(i, j) != 1) return false;
+        }
+    }
+    return true;
+}
+
+
+// Same for ApplyStencil: every interior point of v is updated.
+bool stencil_serial_scope() {
+    array::Array2D<double> u(514, 514, 1.0), v(514, 514, 0.0);
+    array::Stencil<double, 2> s = array::Stencil<double, 2>::Laplacian();
+    s.Add({0, 0}, 1.0);
+    array::ThreadPool::SerialScope serial;
+    array::ApplyStencil(s, u, v, 1);
+    for (std::size_t i = 1; i + 1 < v.Dim1(); ++i) {
+        for (std::size_t j = 1; j + 1 < v.Dim2(); ++j) {
+            if (v(i, j) != 1.0) return false;
+        }
+    }
+    return true;
+}
+
+
+// add3_parallel on a grid large enough to be split over the pool.
+bool add3_parallel_matches() {
+    const std::size_t n1 = 40, n2 = 50, n3 = 60;
+    array::Array3D<double> a(n1, n2, n3), b(n1, n2, n3), c(n1, n2, n3, 0.0);
+    for (std::size_t i = 0; i < n1; ++i) {
+        for (std::size_t j = 0; j < n2; ++j) {
+            for (std::size_t k = 0; k < n3; ++k) {
+                a(i, j, k) = i * 10000.0 + j * 100.0 + k;
+                b(i, j, k) = 0.5 * k;
+            }
+        }
+    }
+    add3_parallel(a, b, c);
+    for (std::size_t i = 0; i < n1; ++i) {
+        for (std::size_t j = 0; j < n2; ++j) {
+            for (std::size_t k = 0; k < n3; ++k) {
+                if (c(i, j, k) != a(i, j, k) + b(i, j, k)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+// Reshape must carry the pitch of the new rows along.
+bool reshape_pitch() {
+    array::Array3D<int> b(3, 4, 5);
+    b.Reshape(3, 5, 4);
+    if (b.Pitch() != 4 || b.StorageSize() > b.Capacity()) return false;
+    b.Fill(7);
+    b(2, 4, 3) = 8;
+    return b(0, 0, 0) == 7 && b(2, 4, 3) == 8 && b.Data()[59] == 8;
+}
+
+
 int main() {
+    if (!foreach_serial_scope()) {
+        std::cout << "ForEachIndex under SerialScope skipped indices" << std::endl;
+        return 1;
+    }
+    if (!stencil_serial_scope()) {
+        std::cout << "ApplyStencil under SerialScope skipped tiles" << std::endl;
+        return 1;
+    }
+    if (!add3_parallel_matches()) {
+        std::cout << "add3_parallel gave a wrong sum" << std::endl;
+        return 1;
+    }
+    if (!reshape_pitch()) {
+        std::cout << "Reshape kept the old pitch" << std::endl;
+        return 1;
+    }
+
+
     // const int N = 1000;
     // array::Array1D<double> a(N, 1.0), b(N, 2.0), c(N);
     // add1(a, b, c);
@@ -0,0 +1,228 @@
+#ifndef TRANSPOSE_HPP_
+#define TRANSPOSE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "array_view.hpp"
+#include "array2d.hpp"
+#include "parallel.hpp"
+#include "simd.hpp"
+
+namespace array {
+
+    namespace detail {
+
+        // Edge of the square tiles of the transposing copy: 256 bytes per tile
+        // row, so one source and one destination tile (8 KiB each for double)
+        // stay in L1 while they are shuffled.
+        template <typename T>
+        constexpr std::size_t TransposeTileExtent() noexcept {
+            return sizeof(T) >= 32 ? 8 : 256 / sizeof(T);
+        }
+
+        // Axis of extent > 1 with the smallest stride, preferring `prefer` on ties.
+        template <typename T, std::size_t Rank>
+        std::size_t InnermostAxisOf(const ArrayView<T, Rank>& view, const std::size_t prefer) {
+            std::size_t best = prefer;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                if (view.Dim(axis) > 1 && (view.Dim(best) <= 1 || view.Stride(axis) < view.Stride(best))) {
+                    best = axis;
+                }
+            }
+            return best;
+        }
+
+        // Copies `src` into `dst` of the same shape; both may have any strides.
+        // dst is written along its innermost axis a. When src is contiguous along
+        // another axis b, each (a, b) plane is copied as a cache-blocked SIMD
+        // transpose; otherwise element rows along a are copied. The work (rows
+        // or column blocks of planes) is split statically over ThreadPool::Global()
+        // once the copy reaches kParallelThreshold elements.
+        template <typename T, std::size_t Rank>
+        void CopyStrided(const ArrayView<const T, Rank>& src, const ArrayView<T, Rank>& dst) {
+            if (src.Shape() != dst.Shape()) {
+                throw std::invalid_argument("CopyStrided: shape mismatch");
+            }
+            if (dst.IsEmpty()) return;
+
+            const std::size_t a = InnermostAxisOf(dst, Rank - 1);
+            const std::size_t b = InnermostAxisOf(src, a);
+            const bool transpose = b != a && src.Stride(b) == 1 && dst.Stride(a) == 1;
+
+            std::array<std::size_t, Rank> outer;
+            std::size_t num_outer = 0;
+            std::size_t outer_count = 1;
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                if (axis == a || (transpose && axis == b)) continue;
+                outer[num_outer++] = axis;
+                outer_count *= dst.Dim(axis);
+            }
+
+            constexpr std::size_t B = TransposeTileExtent<T>();
+            const std::size_t na = dst.Dim(a);
+            const std::size_t nb = dst.Dim(b);
+            const std::size_t blocks = transpose ? (nb + B - 1) / B : 1;
+            const std::size_t num_units = outer_count * blocks;
+
+            auto process = [&](const std::size_t begin, const std::size_t end) {
+                for (std::size_t unit = begin; unit < end; ++unit) {
+                    std::size_t rest = unit / blocks;
+                    const T* s = src.Data();
+                    T* d = dst.Data();
+                    for (std::size_t k = num_outer; k-- > 0;) {
+                        const std::size_t axis = outer[k];
+                        const std::size_t i = rest % dst.Dim(axis);
+                        rest /= dst.Dim(axis);
+                        s += i * src.Stride(axis);
+                        d += i * dst.Stride(axis);
+                    }
+                    if (transpose) {
+                        const std::size_t x0 = (unit % blocks) * B;
+                        const std::size_t x1 = std::min(nb, x0 + B);
+                        for (std::size_t y0 = 0; y0 < na; y0 += B) {
+                            simd::TransposeTile(s + y0 * src.Stride(a) + x0, src.Stride(a), d + x0 * dst.Stride(b) + y0, dst.Stride(b),
+                                                std::min(B, na - y0), x1 - x0);
+                        }
+                    } else {
+                        const std::size_t ss = src.Stride(a);
+                        const std::size_t ds = dst.Stride(a);
+                        if (ss == 1 && ds == 1) {
+                            std::copy(s, s + na, d);
+                        } else {
+                            for (std::size_t i = 0; i < na; ++i) {
+                                d[i * ds] = s[i * ss];
+                            }
+                        }
+                    }
+                }
+            };
+
+            ThreadPool& pool = ThreadPool::Global();
+            if (dst.Size() < kParallelThreshold || pool.NumThreads() == 1 || num_units == 1) {
+                process(0, num_units);
+                return;
+            }
+            pool.Run([&](const std::size_t index, const std::size_t count) {
+                std::size_t begin, end;
+                StaticChunk(num_units, 1, index, count, begin, end);
+                process(begin, end);
+            });
+        }
+    }
+
+    // Axis permutation of an array type with View().
+    template <typename A>
+    using AxesOf = std::array<std::size_t, decltype(std::declval<const A&>().View())::NumDimensions()>;
+
+    // #######################
+    // Permute
+    // #######################
+    // dst = src with its axes reordered: axis k of dst is axis axes[k] of src,
+    // i.e. dst(i_0, ..., i_{R-1}) = src(j) with j[axes[k]] = i_k (the numpy
+    // transpose convention). dst is resized; its layout may differ from src.
+    // dst may be src itself, in which case the result goes through a
+    // temporary.
+    //     Array4D<double> b;
+    //     Permute(a, {3, 0, 1, 2}, b);
+    template <typename A, typename B>
+    void Permute(const A& src, const AxesOf<A>& axes, B& dst) {
+        if (dst.Size() != 0 && static_cast<const void*>(dst.Data()) == static_cast<const void*>(src.View().Data())) {
+            B result;
+            Permute(src, axes, result);
+            dst = std::move(result);
+            return;
+        }
+        const auto view = src.View().Permute(axes);
+        std::apply([&dst](const auto... n) { dst.Resize(n...); }, view.Shape());
+        detail::CopyStrided(view, dst.View());
+    }
+
+    template <typename A>
+    A Permute(const A& src, const AxesOf<A>& axes) {
+        A dst;
+        Permute(src, axes, dst);
+        return dst;
+    }
+
+    // #######################
+    // Transpose
+    // #######################
+
+    // Transpose(a, a) is TransposeInPlace(a).
+    template <typename T, typename Allocator, typename Layout, typename B>
+    void Transpose(const Array2D<T, Allocator, Layout>& src, B& dst) {
+        if constexpr (std::is_same<B, Array2D<T, Allocator, Layout>>::value) {
+            if (&dst == &src) {
+                TransposeInPlace(dst);
+                return;
+            }
+        }
+        Permute(src, {1, 0}, dst);
+    }
+
+    template <typename T, typename Allocator, typename Layout>
+    Array2D<T, Allocator, Layout> Transpose(const Array2D<T, Allocator, Layout>& src) {
+        return Permute(src, {1, 0});
+    }
+
+    // Square matrices are transposed in place, swapping pairs of tiles through
+    // a per-thread buffer; rows of tiles are handed out dynamically because
+    // their work shrinks towards the bottom. Other shapes go through a
+    // temporary transposed copy.
+    template <typename T, typename Allocator, typename Layout>
+    void TransposeInPlace(Array2D<T, Allocator, Layout>& a) {
+        if (a.Dim1() != a.Dim2()) {
+            a = Transpose(a);
+            return;
+        }
+        const std::size_t n = a.Dim1();
+        if (n < 2) return;
+
+        constexpr std::size_t B = detail::TransposeTileExtent<T>();
+        const std::size_t num_tiles = (n + B - 1) / B;
+        const std::size_t ld = a.Pitch();
+        T* data = a.Data();
+        std::atomic<std::size_t> next_row(0);
+
+        auto work = [&](std::size_t, std::size_t) {
+            std::vector<T> buffer(B * B);
+            T* tmp = buffer.data();
+            for (;;) {
+                const std::size_t ti = next_row.fetch_add(1, std::memory_order_relaxed);
+                if (ti >= num_tiles) return;
+                const std::size_t i0 = ti * B;
+                const std::size_t hi = std::min(B, n - i0);
+                for (std::size_t tj = ti; tj < num_tiles; ++tj) {
+                    const std::size_t j0 = tj * B;
+                    const std::size_t wj = std::min(B, n - j0);
+                    T* upper = data + i0 * ld + j0;
+                    T* lower = data + j0 * ld + i0;
+                    simd::TransposeTile(upper, ld, tmp, B, hi, wj);
+                    if (tj != ti) {
+                        simd::TransposeTile(lower, ld, upper, ld, wj, hi);
+                    }
+                    for (std::size_t r = 0; r < wj; ++r) {
+                        std::copy(tmp + r * B, tmp + r * B + hi, lower + r * ld);
+                    }
+                }
+            }
+        };
+
+        ThreadPool& pool = ThreadPool::Global();
+        if (n * n < kParallelThreshold || pool.NumThreads() == 1) {
+            work(0, 1);
+        } else {
+            pool.Run(work);
+        }
+    }
+}
+
+#endif /* TRANSPOSE_HPP_ */
@@ -2,8 +2,17 @@
 #define ARRAY_HPP
 
 #include "types.hpp"
+#include <array>
 #include <vector>
 #include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
 
 namespace array
 {
@@ -12,12 +21,175 @@ namespace array
         Allocated
     };
 
-    using ArrayShape = std::vector<types::Size>;
+    // Bulk operations (Fill/Zero/One, copies) on arrays of kParallelThreshold
+    // elements or more run in an OpenMP parallel region when compiled with
+    // -fopenmp. Every thread always gets the same contiguous range of a given
+    // array (ThreadRange), so with ENABLE_FIRST_TOUCH the pages touched at
+    // allocation are the ones the same thread fills and copies later.
+    constexpr types::Size kParallelThreshold = types::Size(1) << 20;
+    constexpr types::Size kPageSize = 4096;
+
+    inline void ThreadRange(const types::Size n, types::Size& begin, types::Size& end) {
+    #ifdef _OPENMP
+        const types::Size index = static_cast<types::Size>(omp_get_thread_num());
+        const types::Size count = static_cast<types::Size>(omp_get_num_threads());
+        begin = n * index / count;
+        end = n * (index + 1) / count;
+    #else
+        begin = 0;
+        end = n;
+    #endif
+    }
+
+    // Calls f(begin, end) on the range of every thread, or f(0, n) once if
+    // `parallel` is false.
+    template <typename F>
+    inline void ParallelRange(const types::Size n, const bool parallel, F&& f) {
+    #ifdef _OPENMP
+        #pragma omp parallel if(parallel)
+    #endif
+        {
+            types::Size begin, end;
+            ThreadRange(n, begin, end);
+            if (begin < end) f(begin, end);
+        }
+        (void)parallel;
+    }
+
+    template <typename F>
+    inline void ParallelRange(const types::Size n, F&& f) {
+        ParallelRange(n, n >= kParallelThreshold, f);
+    }
 
     template <typename T>
-    class Array {
+    inline void ParallelFill(T* pdata, const types::Size n, const T& value) {
+        ParallelRange(n, [=, &value](const types::Size begin, const types::Size end) {
+            std::fill(pdata + begin, pdata + end, value);
+        });
+    }
+
+    template <typename T>
+    inline void ParallelCopy(const T* src, const types::Size n, T* dst) {
+        ParallelRange(n, [=](const types::Size begin, const types::Size end) {
+            std::copy(src + begin, src + end, dst + begin);
+        });
+    }
+
+    template <typename T>
+    inline T* AllocateStorage(const types::Size n) {
+        T* pdata = new T[n];
+    #ifdef ENABLE_FIRST_TOUCH
+        unsigned char* bytes = reinterpret_cast<unsigned char*>(pdata);
+        ParallelRange(n, [=](const types::Size begin, const types::Size end) {
+            for (types::Size offset = begin * sizeof(T); offset < end * sizeof(T); offset += kPageSize) {
+                bytes[offset] = 0;
+            }
+        });
+    #endif
+        return pdata;
+    }
+
+    // Shape of up to kMaxRank dimensions stored inline, so that creating,
+    // copying and comparing shapes never allocates. Unused extents stay zero.
+    class ArrayShape {
+    public:
+        static constexpr types::Size kMaxRank = 6;
+
+        using value_type = types::Size;
+        using iterator = types::Size*;
+        using const_iterator = const types::Size*;
+
+        ArrayShape() noexcept : ndim_(0), dims_{} { }
+
+        ArrayShape(std::initializer_list<types::Size> dims) : ArrayShape(dims.begin(), dims.end()) { }
+
+        ArrayShape(const std::vector<types::Size>& dims) : ArrayShape(dims.begin(), dims.end()) { }
+
+        template <typename Iterator>
+        ArrayShape(Iterator first, Iterator last) : ndim_(0), dims_{} {
+            for (; first != last; ++first) {
+                if (ndim_ == kMaxRank) {
+                    throw std::length_error("ArrayShape: rank exceeds kMaxRank");
+                }
+                dims_[ndim_++] = static_cast<types::Size>(*first);
+            }
+        }
+
+        inline types::Size size() const noexcept { return ndim_; }
+        inline bool empty() const noexcept { return ndim_ == 0; }
+
+        inline types::Size& operator[](const types::Size axis) noexcept { return dims_[axis]; }
+        inline const types::Size& operator[](const types::Size axis) const noexcept { return dims_[axis]; }
+
+        inline iterator begin() noexcept { return dims_.data(); }
+        inline const_iterator begin() const noexcept { return dims_.data(); }
+        inline iterator end() noexcept { return dims_.data() + ndim_; }
+        inline const_iterator end() const noexcept { return dims_.data() + ndim_; }
+
+        inline void clear() noexcept {
+            ndim_ = 0;
+            dims_.fill(0);
+        }
+
+        friend inline bool operator==(const ArrayShape& lhs, const ArrayShape& rhs) noexcept {
+            return lhs.ndim_ == rhs.ndim_ && lhs.dims_ == rhs.dims_;
+        }
+
+        friend inline bool operator!=(const ArrayShape& lhs, const ArrayShape& rhs) noexcept {
+            return !(lhs == rhs);
+        }
+
+    private:
+        types::Size ndim_;
+        std::array<types::Size, kMaxRank> dims_;
+    };
+
+    // Non-owning contiguous 1-D view of an array's elements.
+    // Valid only while the viewed array is alive and not resized.
+    template <typename T>
+    class ArrayFlatView {
+    public:
+        ArrayFlatView() noexcept : pdata_(nullptr), size_(0) { }
+        ArrayFlatView(T* pdata, const types::Size size) noexcept : pdata_(pdata), size_(size) { }
+
+        inline types::Size Size() const noexcept { return size_; }
+
+        inline T* Data() const noexcept { return pdata_; }
+        inline T* Begin() const noexcept { return pdata_; }
+        inline T* End() const noexcept { return pdata_ + size_; }
+
+        inline T& operator()(const types::Index i) const { return pdata_[i]; }
+
+    private:
+        T* pdata_;
+        types::Size size_;
+    };
+
+    // Rank value selecting the runtime-rank Array<T>.
+    constexpr types::Size kDynamicRank = 0;
+
+    // Memory layout of Array<T, Rank, Layout>. RowMajor (C order): the last
+    // index is contiguous. ColumnMajor (Fortran order): the first index is
+    // contiguous, so the buffer can be shared with column-major (LAPACK-style)
+    // code without a copy. The runtime-rank Array<T> is always RowMajor.
+    struct RowMajor {
+        static constexpr bool kIsColumnMajor = false;
+    };
+
+    struct ColumnMajor {
+        static constexpr bool kIsColumnMajor = true;
+    };
+
+    template <typename T, types::Size Rank = kDynamicRank, typename Layout = RowMajor>
+    class Array;
+
+    // #######################
+    // Array<T>: runtime rank
+    // #######################
+    template <typename T>
+    class Array<T, kDynamicRank, RowMajor> {
     public:
-        Array() : size_(0), shape_({}), ndim_(0), pdata_(nullptr), status_(ArrayStatus::Empty) { }
+        Array() : size_(0), shape_(), ndim_(0), pdata_(nullptr), status_(ArrayStatus::Empty) { }
 
         Array(const types::Size n1)
         : shape_({n1}), ndim_(1), pdata_(nullptr), status_(ArrayStatus::Empty) {
@@ -63,11 +235,10 @@ namespace array
 
         // copy constructor
         Array(const Array& other)
-        : shape_(other.shape_), size_(other.size_), ndim_(other.ndim_), pdata_(nullptr), status_(ArrayStatus::Empty) {
-            std::cout << "copy" << std::endl;
+        : size_(other.size_), shape_(other.shape_), ndim_(other.ndim_), pdata_(nullptr), status_(ArrayStatus::Empty) {
             AllocateArray();
             if (other.IsAllocated()) {
-                std::copy(other.Begin(), other.End(), pdata_);
+                ParallelCopy(other.pdata_, other.size_, pdata_);
             }
         }
 
@@ -78,14 +249,11 @@ namespace array
             }
 
             if (shape_ != other.shape_) {
-                DeleteArray();
-                shape_ = other.shape_;
-                size_ = other.size_;
-                AllocateArray();
+                ResizeImpl(other.shape_);
             }
 
             if (other.IsAllocated()) {
-                std::copy(other.Begin(), other.End(), pdata_);
+                ParallelCopy(other.pdata_, other.size_, pdata_);
             }
 
             return *this;
@@ -93,8 +261,9 @@ namespace array
 
         // move constructor
         Array(Array&& other) noexcept
-        : shape_(std::move(other.shape_)), size_(other.size_), ndim_(other.ndim_), pdata_(nullptr), status_(other.status_) {
+        : size_(other.size_), capacity_(other.capacity_), shape_(other.shape_), ndim_(other.ndim_), pdata_(other.pdata_), status_(other.status_) {
             other.size_ = 0;
+            other.capacity_ = 0;
             other.shape_.clear();
             other.ndim_ = 0;
             other.pdata_ = nullptr;
@@ -102,19 +271,21 @@ namespace array
         }
 
         // move operator
-        Array& operator=(Array&& other) {
+        Array& operator=(Array&& other) noexcept {
             if (this == &other) {
                 return *this;
             }
 
             DeleteArray();
-            shape_ = std::move(other.shape_);
+            shape_ = other.shape_;
             size_ = other.size_;
+            capacity_ = other.capacity_;
             ndim_ = other.ndim_;
             pdata_ = other.pdata_;
             status_ = other.status_;
 
             other.size_ = 0;
+            other.capacity_ = 0;
             other.shape_.clear();
             other.ndim_ = 0;
             other.pdata_ = nullptr;
@@ -145,8 +316,8 @@ namespace array
         inline T* End() { return pdata_ + size_; }
         inline const T* End() const { return pdata_ + size_; }
 
-        inline bool IsEmpty() { return status_ == ArrayStatus::Empty; }
-        inline bool IsAllocated() { return status_ == ArrayStatus::Allocated; }
+        inline bool IsEmpty() const { return status_ == ArrayStatus::Empty; }
+        inline bool IsAllocated() const { return status_ == ArrayStatus::Allocated; }
 
         inline bool HasSameShape(const Array& other) const {
             return shape_ == other.shape_;
@@ -196,25 +367,50 @@ namespace array
 
         void Fill(const T& value) {
             if (IsAllocated()) {
-                std::fill(pdata_, pdata_ + size_, value);
+                ParallelFill(pdata_, size_, value);
             }
         }
 
         void Zero() {
             if (IsAllocated()) {
-                std::fill(pdata_, pdata_ + size_, static_cast<T>(0));
+                ParallelFill(pdata_, size_, static_cast<T>(0));
             }
         }
 
         void One() {
             if (IsAllocated()) {
-                std::fill(pdata_, pdata_ + size_, static_cast<T>(1));
+                ParallelFill(pdata_, size_, static_cast<T>(1));
             }
         }
 
         void Swap(Array& other) noexcept {
             if (HasSameShape(other)) {
                 std::swap(pdata_, other.pdata_);
+                std::swap(capacity_, other.capacity_);
+            }
+        }
+
+        // Number of elements the current allocation can hold without reallocating.
+        inline types::Size Capacity() const { return capacity_; }
+
+        // Grows the allocation to hold at least n elements. Current contents are kept.
+        void Reserve(const types::Size n) {
+            if (n > capacity_) {
+                Reallocate(n);
+            }
+        }
+
+        // Releases the capacity beyond Size(). Current contents are kept.
+        void ShrinkToFit() {
+            if (capacity_ > size_) {
+                if (size_ == 0) {
+                    delete[] pdata_;
+                    pdata_ = nullptr;
+                    capacity_ = 0;
+                    status_ = ArrayStatus::Empty;
+                } else {
+                    Reallocate(size_);
+                }
             }
         }
 
@@ -259,10 +455,14 @@ namespace array
             }
         }
 
+        // Zero-copy flatten: a 1-D view aliasing this array's storage.
+        ArrayFlatView<T> FlatView() noexcept { return ArrayFlatView<T>(pdata_, size_); }
+        ArrayFlatView<const T> FlatView() const noexcept { return ArrayFlatView<const T>(pdata_, size_); }
+
         Array Flatten() const {
             Array<T> flat(size_);
             if (IsAllocated()) {
-                std::copy(pdata_, pdata_ + size_, flat.pdata_);
+                ParallelCopy(pdata_, size_, flat.pdata_);
             }
             return flat;
         }
@@ -270,7 +470,7 @@ namespace array
         void FlattenInto(Array& out_flat) const {
             out_flat.Resize(size_);
             if (IsAllocated()) {
-                std::copy(pdata_, pdata_ + size_, out_flat.pdata_);
+                ParallelCopy(pdata_, size_, out_flat.pdata_);
             }
         }
 
@@ -278,23 +478,37 @@ namespace array
         
         void AllocateArray() {
             if (IsEmpty() && size_ > 0) {
-                pdata_ = new T[size_];
+                pdata_ = AllocateStorage<T>(size_);
+                capacity_ = size_;
                 status_ = ArrayStatus::Allocated;
             }
         }
 
+        // Moves the first size_ elements into a new allocation of n elements.
+        void Reallocate(const types::Size n) {
+            T* pdata = AllocateStorage<T>(n);
+            if (IsAllocated()) {
+                std::move(pdata_, pdata_ + size_, pdata);
+                delete[] pdata_;
+            }
+            pdata_ = pdata;
+            capacity_ = n;
+            status_ = ArrayStatus::Allocated;
+        }
+
         void DeleteArray() {
             if (IsAllocated()) {
                 delete[] pdata_;
                 pdata_ = nullptr;
                 size_ = 0;
+                capacity_ = 0;
                 shape_.clear();
                 ndim_ = 0;
                 status_ = ArrayStatus::Empty;
             }
         }
 
-        types::Size ComputeSize(ArrayShape& shape) {
+        types::Size ComputeSize(const ArrayShape& shape) const {
             if (shape.empty()) return 0;
             types::Size size = 1;
             for (types::Size dim : shape) {
@@ -303,27 +517,568 @@ namespace array
             return size;
         }
 
+        // The existing allocation is reused whenever it is large enough;
+        // element values are unspecified after a shape change.
         void ResizeImpl(const ArrayShape& shape) {
+            const types::Size size = ComputeSize(shape);
             if (IsEmpty()) {
                 shape_ = shape;
-                size_ = ComputeSize(shape_);
+                size_ = size;
                 ndim_ = shape_.size();
                 AllocateArray();
             } else if (shape_ != shape) {
-                DeleteArray();
-                shape_ = shape;
-                size_ = ComputeSize(shape_);
-                ndim_ = shape_.size();
-                AllocateArray();
+                if (size > capacity_) {
+                    DeleteArray();
+                    shape_ = shape;
+                    size_ = size;
+                    ndim_ = shape_.size();
+                    AllocateArray();
+                } else {
+                    shape_ = shape;
+                    size_ = size;
+                    ndim_ = shape_.size();
+                }
             }
         }
 
         types::Size size_;
+        types::Size capacity_ = 0;
         ArrayShape shape_;
         types::Size ndim_;
         T* pdata_;
         ArrayStatus status_;
     };
+
+    // #######################
+    // Array<T, Rank>: compile-time rank
+    // #######################
+    // Shape and strides are stored inline and the index computation is unrolled
+    // at compile time, so element access costs the same as hand-written pointer
+    // arithmetic. Bulk operations (Fill, copies, Flatten) work in storage order.
+    template <typename T, types::Size Rank, typename Layout>
+    class Array {
+        static_assert(Rank >= 1 && Rank <= 6, "Array: rank must be between 1 and 6");
+
+    public:
+        using shape_type = std::array<types::Size, Rank>;
+        using layout_type = Layout;
+
+        // Same array type with another memory layout.
+        template <typename OtherLayout>
+        using rebind_layout = Array<T, Rank, OtherLayout>;
+
+        Array() : size_(0), shape_{}, strides_{}, pdata_(nullptr), status_(ArrayStatus::Empty) { }
+
+        template <typename... Dims, typename = std::enable_if_t<sizeof...(Dims) == Rank>>
+        explicit Array(const Dims... dims)
+        : size_(0), shape_{static_cast<types::Size>(dims)...}, strides_{}, pdata_(nullptr), status_(ArrayStatus::Empty) {
+            size_ = ComputeStrides(shape_, strides_);
+            AllocateArray();
+        }
+
+        explicit Array(const shape_type& shape)
+        : size_(0), shape_(shape), strides_{}, pdata_(nullptr), status_(ArrayStatus::Empty) {
+            size_ = ComputeStrides(shape_, strides_);
+            AllocateArray();
+        }
+
+        // copy constructor
+        Array(const Array& other)
+        : size_(other.size_), shape_(other.shape_), strides_(other.strides_), pdata_(nullptr), status_(ArrayStatus::Empty) {
+            AllocateArray();
+            if (other.IsAllocated()) {
+                ParallelCopy(other.pdata_, other.size_, pdata_);
+            }
+        }
+
+        // copy operator
+        Array& operator=(const Array& other) {
+            if (this == &other) {
+                return *this;
+            }
+
+            if (shape_ != other.shape_) {
+                ResizeImpl(other.shape_);
+            }
+
+            if (other.IsAllocated()) {
+                ParallelCopy(other.pdata_, other.size_, pdata_);
+            }
+
+            return *this;
+        }
+
+        // move constructor
+        Array(Array&& other) noexcept
+        : size_(other.size_), capacity_(other.capacity_), shape_(other.shape_), strides_(other.strides_), pdata_(other.pdata_), status_(other.status_) {
+            other.size_ = 0;
+            other.capacity_ = 0;
+            other.shape_ = {};
+            other.strides_ = {};
+            other.pdata_ = nullptr;
+            other.status_ = ArrayStatus::Empty;
+        }
+
+        // move operator
+        Array& operator=(Array&& other) noexcept {
+            if (this == &other) {
+                return *this;
+            }
+
+            DeleteArray();
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            shape_ = other.shape_;
+            strides_ = other.strides_;
+            pdata_ = other.pdata_;
+            status_ = other.status_;
+
+            other.size_ = 0;
+            other.capacity_ = 0;
+            other.shape_ = {};
+            other.strides_ = {};
+            other.pdata_ = nullptr;
+            other.status_ = ArrayStatus::Empty;
+
+            return *this;
+        }
+
+        ~Array() { DeleteArray(); }
+
+        inline types::Size Size() const { return size_; }
+        inline const shape_type& Shape() const { return shape_; }
+        inline const shape_type& Strides() const { return strides_; }
+        static constexpr types::Size Ndim() { return Rank; }
+
+        inline types::Size Dim(const types::Size axis) const { return shape_[axis]; }
+
+        template <types::Size R = Rank, typename = std::enable_if_t<(R >= 1)>>
+        inline types::Size Dim1() const { return shape_[0]; }
+        template <types::Size R = Rank, typename = std::enable_if_t<(R >= 2)>>
+        inline types::Size Dim2() const { return shape_[1]; }
+        template <types::Size R = Rank, typename = std::enable_if_t<(R >= 3)>>
+        inline types::Size Dim3() const { return shape_[2]; }
+        template <types::Size R = Rank, typename = std::enable_if_t<(R >= 4)>>
+        inline types::Size Dim4() const { return shape_[3]; }
+        template <types::Size R = Rank, typename = std::enable_if_t<(R >= 5)>>
+        inline types::Size Dim5() const { return shape_[4]; }
+        template <types::Size R = Rank, typename = std::enable_if_t<(R >= 6)>>
+        inline types::Size Dim6() const { return shape_[5]; }
+
+        inline T* Data() { return pdata_; }
+        inline const T* Data() const { return pdata_; }
+
+        inline T* Begin() { return pdata_; }
+        inline const T* Begin() const { return pdata_; }
+
+        inline T* End() { return pdata_ + size_; }
+        inline const T* End() const { return pdata_ + size_; }
+
+        inline bool IsEmpty() const { return status_ == ArrayStatus::Empty; }
+        inline bool IsAllocated() const { return status_ == ArrayStatus::Allocated; }
+
+        inline bool HasSameShape(const Array& other) const {
+            return shape_ == other.shape_;
+        }
+
+        template <typename... Indices>
+        inline T& operator()(const Indices... indices) {
+            return pdata_[Offset(indices...)];
+        }
+
+        template <typename... Indices>
+        inline const T& operator()(const Indices... indices) const {
+            return pdata_[Offset(indices...)];
+        }
+
+        // Linear offset of (i, j, ...). The unit stride (last axis for RowMajor,
+        // first for ColumnMajor) is not multiplied.
+        template <typename... Indices>
+        inline types::Size Offset(const Indices... indices) const {
+            static_assert(sizeof...(Indices) == Rank, "Array: wrong number of indices");
+            const types::Index index[Rank] = {static_cast<types::Index>(indices)...};
+            if constexpr (Layout::kIsColumnMajor) {
+                return index[0] + OffsetImpl<1>(index, std::make_index_sequence<Rank - 1>{});
+            } else {
+                return OffsetImpl<0>(index, std::make_index_sequence<Rank - 1>{}) + index[Rank - 1];
+            }
+        }
+
+        void Fill(const T& value) {
+            if (IsAllocated()) {
+                ParallelFill(pdata_, size_, value);
+            }
+        }
+
+        void Zero() {
+            if (IsAllocated()) {
+                ParallelFill(pdata_, size_, static_cast<T>(0));
+            }
+        }
+
+        void One() {
+            if (IsAllocated()) {
+                ParallelFill(pdata_, size_, static_cast<T>(1));
+            }
+        }
+
+        void Swap(Array& other) noexcept {
+            if (HasSameShape(other)) {
+                std::swap(pdata_, other.pdata_);
+                std::swap(capacity_, other.capacity_);
+            }
+        }
+
+        // Number of elements the current allocation can hold without reallocating.
+        inline types::Size Capacity() const { return capacity_; }
+
+        // Grows the allocation to hold at least n elements. Current contents are kept.
+        void Reserve(const types::Size n) {
+            if (n > capacity_) {
+                Reallocate(n);
+            }
+        }
+
+        // Releases the capacity beyond Size(). Current contents are kept.
+        void ShrinkToFit() {
+            if (capacity_ > size_) {
+                if (size_ == 0) {
+                    delete[] pdata_;
+                    pdata_ = nullptr;
+                    capacity_ = 0;
+                    status_ = ArrayStatus::Empty;
+                } else {
+                    Reallocate(size_);
+                }
+            }
+        }
+
+        template <typename... Dims, typename = std::enable_if_t<sizeof...(Dims) == Rank>>
+        void Resize(const Dims... dims) {
+            ResizeImpl(shape_type{static_cast<types::Size>(dims)...});
+        }
+
+        void Resize(const shape_type& shape) {
+            ResizeImpl(shape);
+        }
+
+        ArrayFlatView<T> FlatView() noexcept { return ArrayFlatView<T>(pdata_, size_); }
+        ArrayFlatView<const T> FlatView() const noexcept { return ArrayFlatView<const T>(pdata_, size_); }
+
+        Array<T, 1> Flatten() const {
+            Array<T, 1> flat(size_);
+            if (IsAllocated()) {
+                ParallelCopy(pdata_, size_, flat.Data());
+            }
+            return flat;
+        }
+
+    private:
+
+        void AllocateArray() {
+            if (IsEmpty() && size_ > 0) {
+                pdata_ = AllocateStorage<T>(size_);
+                capacity_ = size_;
+                status_ = ArrayStatus::Allocated;
+            }
+        }
+
+        // Moves the first size_ elements into a new allocation of n elements.
+        void Reallocate(const types::Size n) {
+            T* pdata = AllocateStorage<T>(n);
+            if (IsAllocated()) {
+                std::move(pdata_, pdata_ + size_, pdata);
+                delete[] pdata_;
+            }
+            pdata_ = pdata;
+            capacity_ = n;
+            status_ = ArrayStatus::Allocated;
+        }
+
+        void DeleteArray() {
+            if (IsAllocated()) {
+                delete[] pdata_;
+                pdata_ = nullptr;
+                size_ = 0;
+                capacity_ = 0;
+                shape_ = {};
+                strides_ = {};
+                status_ = ArrayStatus::Empty;
+            }
+        }
+
+        // Fills the strides of `shape` in Layout order and returns the total size.
+        static types::Size ComputeStrides(const shape_type& shape, shape_type& strides) {
+            types::Size size = 1;
+            if constexpr (Layout::kIsColumnMajor) {
+                for (types::Size axis = 0; axis < Rank; ++axis) {
+                    strides[axis] = size;
+                    size *= shape[axis];
+                }
+            } else {
+                for (types::Size axis = Rank; axis-- > 0;) {
+                    strides[axis] = size;
+                    size *= shape[axis];
+                }
+            }
+            return size;
+        }
+
+        template <std::size_t First, std::size_t... Axes>
+        inline types::Size OffsetImpl(const types::Index* index, std::index_sequence<Axes...>) const {
+            return (types::Size(0) + ... + (index[First + Axes] * strides_[First + Axes]));
+        }
+
+        // The existing allocation is reused whenever it is large enough;
+        // element values are unspecified after a shape change.
+        void ResizeImpl(const shape_type& shape) {
+            if (IsEmpty()) {
+                shape_ = shape;
+                size_ = ComputeStrides(shape_, strides_);
+                AllocateArray();
+            } else if (shape_ != shape) {
+                shape_type strides;
+                const types::Size size = ComputeStrides(shape, strides);
+                if (size > capacity_) {
+                    DeleteArray();
+                    shape_ = shape;
+                    size_ = ComputeStrides(shape_, strides_);
+                    AllocateArray();
+                } else {
+                    shape_ = shape;
+                    strides_ = strides;
+                    size_ = size;
+                }
+            }
+        }
+
+        types::Size size_;
+        types::Size capacity_ = 0;
+        shape_type shape_;
+        shape_type strides_;
+        T* pdata_;
+        ArrayStatus status_;
+    };
+
+    template <typename T> using Array1D = Array<T, 1>;
+    template <typename T> using Array2D = Array<T, 2>;
+    template <typename T> using Array3D = Array<T, 3>;
+    template <typename T> using Array4D = Array<T, 4>;
+    template <typename T> using Array5D = Array<T, 5>;
+    template <typename T> using Array6D = Array<T, 6>;
+
+    template <typename T> using ColumnMajorArray2D = Array<T, 2, ColumnMajor>;
+    template <typename T> using ColumnMajorArray3D = Array<T, 3, ColumnMajor>;
+    template <typename T> using ColumnMajorArray4D = Array<T, 4, ColumnMajor>;
+    template <typename T> using ColumnMajorArray5D = Array<T, 5, ColumnMajor>;
+    template <typename T> using ColumnMajorArray6D = Array<T, 6, ColumnMajor>;
+
+    // #######################
+    // Strided copy / transpose
+    // #######################
+
+    // Edge of the square tiles of the transposing copy: 256 bytes per tile
+    // row, so one source and one destination tile stay in L1.
+    template <typename T>
+    constexpr types::Size TransposeTileExtent() {
+        return sizeof(T) >= 32 ? 8 : 256 / sizeof(T);
+    }
+
+    // dst[c * dst_ld + r] = src[r * src_ld + c] for r < rows, c < cols.
+    template <typename T>
+    inline void TransposeTile(const T* src, const types::Size src_ld, T* dst, const types::Size dst_ld,
+                              const types::Size rows, const types::Size cols) {
+        for (types::Size c = 0; c < cols; ++c) {
+            for (types::Size r = 0; r < rows; ++r) {
+                dst[c * dst_ld + r] = src[r * src_ld + c];
+            }
+        }
+    }
+
+    // Copies the `shape` elements of src (strides src_strides) to dst (strides
+    // dst_strides). dst is written along its unit-stride axis a; if src is
+    // contiguous along another axis b, every (a, b) plane is copied as a
+    // tiled transpose, otherwise as rows along a. Rows or column blocks of
+    // planes are split over the threads of ParallelRange.
+    template <typename T, types::Size Rank>
+    void CopyStrided(const T* src, const std::array<types::Size, Rank>& src_strides,
+                     T* dst, const std::array<types::Size, Rank>& dst_strides,
+                     const std::array<types::Size, Rank>& shape) {
+        types::Size size = 1;
+        for (types::Size dim : shape) size *= dim;
+        if (size == 0) return;
+
+        // Axis of extent > 1 with the smallest stride, preferring `prefer` on ties.
+        auto innermost = [&shape](const std::array<types::Size, Rank>& strides, const types::Size prefer) {
+            types::Size best = prefer;
+            for (types::Size axis = 0; axis < Rank; ++axis) {
+                if (shape[axis] > 1 && (shape[best] <= 1 || strides[axis] < strides[best])) best = axis;
+            }
+            return best;
+        };
+        const types::Size a = innermost(dst_strides, Rank - 1);
+        const types::Size b = innermost(src_strides, a);
+        const bool transpose = b != a && src_strides[b] == 1 && dst_strides[a] == 1;
+
+        std::array<types::Size, Rank> outer;
+        types::Size num_outer = 0;
+        types::Size outer_count = 1;
+        for (types::Size axis = 0; axis < Rank; ++axis) {
+            if (axis == a || (transpose && axis == b)) continue;
+            outer[num_outer++] = axis;
+            outer_count *= shape[axis];
+        }
+
+        constexpr types::Size B = TransposeTileExtent<T>();
+        const types::Size na = shape[a];
+        const types::Size nb = shape[b];
+        const types::Size blocks = transpose ? (nb + B - 1) / B : 1;
+        const types::Size num_units = outer_count * blocks;
+
+        ParallelRange(num_units, size >= kParallelThreshold, [&](const types::Size begin, const types::Size end) {
+            for (types::Size unit = begin; unit < end; ++unit) {
+                types::Size rest = unit / blocks;
+                const T* s = src;
+                T* d = dst;
+                for (types::Size k = num_outer; k-- > 0;) {
+                    const types::Size axis = outer[k];
+                    const types::Size i = rest % shape[axis];
+                    rest /= shape[axis];
+                    s += i * src_strides[axis];
+                    d += i * dst_strides[axis];
+                }
+                if (transpose) {
+                    const types::Size x0 = (unit % blocks) * B;
+                    const types::Size x1 = std::min(nb, x0 + B);
+                    for (types::Size y0 = 0; y0 < na; y0 += B) {
+                        TransposeTile(s + y0 * src_strides[a] + x0, src_strides[a], d + x0 * dst_strides[b] + y0, dst_strides[b],
+                                      std::min(B, na - y0), x1 - x0);
+                    }
+                } else {
+                    const types::Size ss = src_strides[a];
+                    const types::Size ds = dst_strides[a];
+                    for (types::Size i = 0; i < na; ++i) {
+                        d[i * ds] = s[i * ss];
+                    }
+                }
+            }
+        });
+    }
+
+    // #######################
+    // Layout conversion
+    // #######################
+    // Copies `src` into `dst`, which may use another layout; dst is resized to
+    // the shape of src. Different layouts are a tiled transposing copy
+    // (CopyStrided), equal layouts a plain ParallelCopy.
+    template <typename T, types::Size Rank, typename SrcLayout, typename DstLayout>
+    void ConvertLayout(const Array<T, Rank, SrcLayout>& src, Array<T, Rank, DstLayout>& dst) {
+        dst.Resize(src.Shape());
+        if (src.Size() == 0) return;
+        if constexpr (std::is_same<SrcLayout, DstLayout>::value) {
+            ParallelCopy(src.Data(), src.Size(), dst.Data());
+        } else {
+            CopyStrided(src.Data(), src.Strides(), dst.Data(), dst.Strides(), src.Shape());
+        }
+    }
+
+    // Copy of `a` in column-major (Fortran) order.
+    template <typename T, types::Size Rank, typename Layout>
+    Array<T, Rank, ColumnMajor> ToColumnMajor(const Array<T, Rank, Layout>& a) {
+        Array<T, Rank, ColumnMajor> result;
+        ConvertLayout(a, result);
+        return result;
+    }
+
+    // Copy of `a` in row-major (C) order.
+    template <typename T, types::Size Rank, typename Layout>
+    Array<T, Rank, RowMajor> ToRowMajor(const Array<T, Rank, Layout>& a) {
+        Array<T, Rank, RowMajor> result;
+        ConvertLayout(a, result);
+        return result;
+    }
+
+    // #######################
+    // Permute / Transpose
+    // #######################
+    // dst = src with its axes reordered: axis k of dst is axis axes[k] of src
+    // (the numpy transpose convention), e.g. Permute(a, {2, 0, 1}, b). dst is
+    // resized, may use another layout and must not be src.
+    template <typename T, types::Size Rank, typename SrcLayout, typename DstLayout>
+    void Permute(const Array<T, Rank, SrcLayout>& src, const std::array<types::Size, Rank>& axes, Array<T, Rank, DstLayout>& dst) {
+        std::array<types::Size, Rank> shape, strides;
+        std::array<bool, Rank> used{};
+        for (types::Size k = 0; k < Rank; ++k) {
+            if (axes[k] >= Rank || used[axes[k]]) {
+                throw std::invalid_argument("Permute: axes must be a permutation");
+            }
+            used[axes[k]] = true;
+            shape[k] = src.Shape()[axes[k]];
+            strides[k] = src.Strides()[axes[k]];
+        }
+        dst.Resize(shape);
+        if (src.Size() == 0) return;
+        CopyStrided(src.Data(), strides, dst.Data(), dst.Strides(), shape);
+    }
+
+    template <typename T, types::Size Rank, typename Layout>
+    Array<T, Rank, Layout> Permute(const Array<T, Rank, Layout>& src, const std::array<types::Size, Rank>& axes) {
+        Array<T, Rank, Layout> dst;
+        Permute(src, axes, dst);
+        return dst;
+    }
+
+    template <typename T, typename SrcLayout, typename DstLayout>
+    void Transpose(const Array<T, 2, SrcLayout>& src, Array<T, 2, DstLayout>& dst) {
+        Permute(src, {1, 0}, dst);
+    }
+
+    template <typename T, typename Layout>
+    Array<T, 2, Layout> Transpose(const Array<T, 2, Layout>& src) {
+        return Permute(src, {1, 0});
+    }
+
+    // Square matrices are transposed in place by swapping pairs of tiles
+    // through a per-thread buffer (rows of tiles are scheduled dynamically,
+    // as their work shrinks towards the bottom); other shapes go through a
+    // temporary transposed copy.
+    template <typename T, typename Layout>
+    void TransposeInPlace(Array<T, 2, Layout>& a) {
+        if (a.Dim1() != a.Dim2()) {
+            a = Transpose(a);
+            return;
+        }
+        const types::Size n = a.Dim1();
+        constexpr types::Size B = TransposeTileExtent<T>();
+        const std::ptrdiff_t num_tiles = static_cast<std::ptrdiff_t>((n + B - 1) / B);
+        T* data = a.Data();
+    #ifdef _OPENMP
+        #pragma omp parallel if(n * n >= kParallelThreshold)
+    #endif
+        {
+            std::vector<T> buffer(B * B);
+            T* tmp = buffer.data();
+        #ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+        #endif
+            for (std::ptrdiff_t ti = 0; ti < num_tiles; ++ti) {
+                const types::Size i0 = static_cast<types::Size>(ti) * B;
+                const types::Size hi = std::min(B, n - i0);
+                for (types::Size j0 = i0; j0 < n; j0 += B) {
+                    const types::Size wj = std::min(B, n - j0);
+                    T* upper = data + i0 * n + j0;
+                    T* lower = data + j0 * n + i0;
+                    TransposeTile(upper, n, tmp, B, hi, wj);
+                    if (j0 != i0) {
+                        TransposeTile(lower, n, upper, n, wj, hi);
+                    }
+                    for (types::Size r = 0; r < wj; ++r) {
+                        std::copy(tmp + r * B, tmp + r * B + hi, lower + r * n);
+                    }
+                }
+            }
+        }
+    }
 }
 
 #endif /* ARRAY_HPP */
\ No newline at end of file
@@ -0,0 +1,333 @@
+#ifndef IO_HPP
+#define IO_HPP
+
+#include "array.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace array
+{
+    // #######################
+    // Array file format
+    // #######################
+    // Same format as array1's io.hpp, so files move freely between the two
+    // libraries: a kFileDataAlignment-byte header followed by the elements
+    // in storage order. Header fields (integers little-endian):
+    //     0   8  magic "ARRAYBIN"
+    //     8   2  format version (1)
+    //     10  1  element kind: 'b' bool, 'i' signed, 'u' unsigned, 'f' float, 'c' complex
+    //     11  1  element size in bytes
+    //     12  1  byte order of the elements: '<' little-endian, '>' big-endian
+    //     13  1  layout: 'C' RowMajor, 'F' ColumnMajor
+    //     14  1  rank (1 to 6)
+    //     16  48 extents, 8 bytes each (unused ones zero)
+    //     64  8  byte offset of the elements
+    constexpr types::Size kFileDataAlignment = 4096;
+
+    // How Save and Load move the elements: Buffered uses large pwritev/preadv
+    // calls straight from/into the array; Direct uses O_DIRECT when the file
+    // system supports it and Data() is kFileDataAlignment-aligned, and
+    // Buffered otherwise. Arrays of kParallelThreshold elements or more are
+    // transferred by every OpenMP thread on its own range.
+    enum class IoMode {
+        Buffered,
+        Direct
+    };
+
+    // Decoded header of an array file.
+    struct ArrayFileHeader {
+        char kind;
+        types::Size item_size;
+        bool little_endian;
+        bool column_major;
+        ArrayShape shape;
+        types::Size data_offset;
+
+        types::Size Size() const noexcept {
+            types::Size size = shape.empty() ? 0 : 1;
+            for (const types::Size n : shape) size *= n;
+            return size;
+        }
+    };
+
+    // Element kind and size of each byte-swapped component of T.
+    template <typename T>
+    struct FileDType {
+        static_assert(std::is_arithmetic<T>::value, "Save/Load: unsupported element type");
+        static constexpr char kind = std::is_same<T, bool>::value ? 'b'
+                                   : std::is_floating_point<T>::value ? 'f'
+                                   : std::is_signed<T>::value ? 'i' : 'u';
+        static constexpr types::Size component = sizeof(T);
+    };
+
+    template <typename F>
+    struct FileDType<std::complex<F>> {
+        static constexpr char kind = 'c';
+        static constexpr types::Size component = sizeof(F);
+    };
+
+    // Open file descriptor of an array file. Transfer() moves all the bytes
+    // of a list of segments, resuming after partial transfers.
+    class ArrayFile {
+    public:
+        static constexpr types::Size kMaxSegments = 256;
+
+        ArrayFile(const std::string& path, const int flags) : path_(path), fd_(::open(path.c_str(), flags, 0644)) { }
+
+        ArrayFile(const ArrayFile&) = delete;
+        ArrayFile& operator=(const ArrayFile&) = delete;
+
+        ~ArrayFile() {
+            if (fd_ >= 0) ::close(fd_);
+        }
+
+        inline bool IsOpen() const noexcept { return fd_ >= 0; }
+        inline int Descriptor() const noexcept { return fd_; }
+        inline const std::string& Path() const noexcept { return path_; }
+
+        [[noreturn]] void Fail(const char* what) const {
+            throw std::system_error(errno, std::generic_category(), std::string(what) + " " + path_);
+        }
+
+        void Transfer(iovec* iov, types::Size count, off_t offset, const bool write) const {
+            while (count > 0) {
+                const int n = static_cast<int>(std::min(count, kMaxSegments));
+                const ssize_t done = write ? ::pwritev(fd_, iov, n, offset) : ::preadv(fd_, iov, n, offset);
+                if (done < 0) {
+                    if (errno == EINTR) continue;
+                    Fail(write ? "Save: cannot write" : "Load: cannot read");
+                }
+                if (done == 0) {
+                    throw std::runtime_error("Load: unexpected end of file " + path_);
+                }
+                offset += done;
+                types::Size left = static_cast<types::Size>(done);
+                while (left > 0 && left >= iov->iov_len) {
+                    left -= iov->iov_len;
+                    ++iov;
+                    --count;
+                }
+                if (left > 0) {
+                    iov->iov_base = static_cast<unsigned char*>(iov->iov_base) + left;
+                    iov->iov_len -= left;
+                }
+            }
+        }
+
+        // Moves the elements [begin, end) of data to or from the file bytes
+        // at offset + begin * sizeof(T), in segments of at most 1 GiB.
+        template <typename T>
+        void TransferElements(T* data, const types::Size begin, const types::Size end, const types::Size offset, const bool write) const {
+            constexpr types::Size kSegmentElements = (types::Size(1) << 30) / sizeof(T);
+            iovec iov[kMaxSegments];
+            types::Size count = 0;
+            types::Size first = begin;
+            for (types::Size i = begin; i < end;) {
+                const types::Size n = std::min(kSegmentElements, end - i);
+                iov[count].iov_base = const_cast<std::remove_const_t<T>*>(data + i);
+                iov[count].iov_len = n * sizeof(T);
+                i += n;
+                if (++count == kMaxSegments || i == end) {
+                    Transfer(iov, count, static_cast<off_t>(offset + first * sizeof(T)), write);
+                    count = 0;
+                    first = i;
+                }
+            }
+        }
+
+    private:
+        std::string path_;
+        int fd_;
+    };
+
+    inline bool NativeLittleEndian() noexcept {
+        return __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+    }
+
+    inline ArrayFileHeader ReadArrayHeader(const ArrayFile& file) {
+        unsigned char bytes[72];
+        iovec iov = {bytes, sizeof(bytes)};
+        file.Transfer(&iov, 1, 0, false);
+        const auto get = [&](const types::Size at, const types::Size n) {
+            std::uint64_t value = 0;
+            for (types::Size i = n; i-- > 0;) value = (value << 8) | bytes[at + i];
+            return static_cast<types::Size>(value);
+        };
+        if (std::memcmp(bytes, "ARRAYBIN", 8) != 0) {
+            throw std::runtime_error("Load: " + file.Path() + " is not an array file");
+        }
+        if (get(8, 2) != 1) {
+            throw std::runtime_error("Load: unsupported array file version in " + file.Path());
+        }
+        ArrayFileHeader header;
+        header.kind = static_cast<char>(bytes[10]);
+        header.item_size = bytes[11];
+        header.little_endian = bytes[12] == '<';
+        header.column_major = bytes[13] == 'F';
+        const types::Size rank = bytes[14];
+        if (rank == 0 || rank > ArrayShape::kMaxRank) {
+            throw std::runtime_error("Load: invalid rank in " + file.Path());
+        }
+        types::Size dims[ArrayShape::kMaxRank];
+        for (types::Size axis = 0; axis < rank; ++axis) dims[axis] = get(16 + 8 * axis, 8);
+        header.shape = ArrayShape(dims, dims + rank);
+        header.data_offset = get(64, 8);
+        return header;
+    }
+
+    template <typename T, typename Layout>
+    void WriteArrayHeader(const ArrayFile& file, const ArrayShape& shape) {
+        std::vector<unsigned char> bytes(kFileDataAlignment, 0);
+        const auto put = [&](const types::Size at, std::uint64_t value, const types::Size n) {
+            for (types::Size i = 0; i < n; ++i, value >>= 8) bytes[at + i] = static_cast<unsigned char>(value);
+        };
+        std::memcpy(bytes.data(), "ARRAYBIN", 8);
+        put(8, 1, 2);
+        bytes[10] = static_cast<unsigned char>(FileDType<T>::kind);
+        bytes[11] = static_cast<unsigned char>(sizeof(T));
+        bytes[12] = NativeLittleEndian() ? '<' : '>';
+        bytes[13] = Layout::kIsColumnMajor ? 'F' : 'C';
+        bytes[14] = static_cast<unsigned char>(shape.size());
+        for (types::Size axis = 0; axis < shape.size(); ++axis) put(16 + 8 * axis, shape[axis], 8);
+        put(64, kFileDataAlignment, 8);
+        iovec iov = {bytes.data(), bytes.size()};
+        file.Transfer(&iov, 1, 0, true);
+    }
+
+    // Transfers the n elements at data in page-aligned ranges, one per OpenMP
+    // thread, through O_DIRECT for the whole pages when `mode` asks for it and
+    // data is aligned; the first error is rethrown after the parallel region.
+    template <typename T>
+    void TransferArray(const ArrayFile& file, const int flags, T* data, const types::Size n, const types::Size offset,
+                       const IoMode mode, const bool write) {
+        if (n == 0) return;
+        const types::Size grain = sizeof(T) >= kPageSize ? 1 : kPageSize / sizeof(T);
+        const auto transfer = [&](const ArrayFile& target, const types::Size first, const types::Size last) {
+            const types::Size units = (last - first + grain - 1) / grain;
+            std::exception_ptr error;
+            ParallelRange(units, n >= kParallelThreshold, [&](const types::Size begin, const types::Size end) {
+                try {
+                    target.TransferElements(data, first + begin * grain, std::min(last, first + end * grain), offset, write);
+                } catch (...) {
+                #ifdef _OPENMP
+                    #pragma omp critical(array_io_error)
+                #endif
+                    if (!error) error = std::current_exception();
+                }
+            });
+            if (error) std::rethrow_exception(error);
+        };
+
+        types::Size direct_end = 0;
+    #ifdef O_DIRECT
+        if (mode == IoMode::Direct && kFileDataAlignment % sizeof(T) == 0 &&
+            reinterpret_cast<std::uintptr_t>(data) % kFileDataAlignment == 0) {
+            const ArrayFile direct(file.Path(), flags | O_DIRECT);
+            if (direct.IsOpen()) {
+                direct_end = n * sizeof(T) / kFileDataAlignment * kFileDataAlignment / sizeof(T);
+                if (direct_end > 0) transfer(direct, 0, direct_end);
+            }
+        }
+    #else
+        (void)flags;
+        (void)mode;
+    #endif
+        if (direct_end < n) transfer(file, direct_end, n);
+    }
+
+    // Header of the array file at `path`.
+    inline ArrayFileHeader ReadHeader(const std::string& path) {
+        const ArrayFile file(path, O_RDONLY);
+        if (!file.IsOpen()) file.Fail("Load: cannot open");
+        return ReadArrayHeader(file);
+    }
+
+    // #######################
+    // Save / Load
+    // #######################
+    // Writes `a` (runtime or compile-time rank) to `path`, replacing the file.
+    template <typename T, types::Size Rank, typename Layout>
+    void Save(const std::string& path, const Array<T, Rank, Layout>& a, const IoMode mode = IoMode::Buffered) {
+        const ArrayShape shape(a.Shape().begin(), a.Shape().end());
+        if (shape.empty()) {
+            throw std::invalid_argument("Save: array has no shape");
+        }
+        const int flags = O_WRONLY;
+        const ArrayFile file(path, flags | O_CREAT | O_TRUNC);
+        if (!file.IsOpen()) file.Fail("Save: cannot open");
+        WriteArrayHeader<T, Layout>(file, shape);
+        if (::ftruncate(file.Descriptor(), static_cast<off_t>(kFileDataAlignment + a.Size() * sizeof(T))) != 0) {
+            file.Fail("Save: cannot extend");
+        }
+        TransferArray(file, flags, a.Data(), a.Size(), kFileDataAlignment, mode, true);
+    }
+
+    // Reads the array file at `path` straight into the storage of `a`, which
+    // is resized only if its shape differs. Element type, layout and (for a
+    // compile-time rank) rank must match the file; data of the other byte
+    // order is swapped in place.
+    template <typename T, types::Size Rank, typename Layout>
+    void Load(const std::string& path, Array<T, Rank, Layout>& a, const IoMode mode = IoMode::Buffered) {
+        const int flags = O_RDONLY;
+        const ArrayFile file(path, flags);
+        if (!file.IsOpen()) file.Fail("Load: cannot open");
+        const ArrayFileHeader header = ReadArrayHeader(file);
+
+        if (header.kind != FileDType<T>::kind || header.item_size != sizeof(T)) {
+            throw std::invalid_argument("Load: element type of " + path + " does not match the array");
+        }
+        if (Rank != kDynamicRank && header.shape.size() != Rank) {
+            throw std::invalid_argument("Load: rank of " + path + " does not match the array");
+        }
+        if (header.shape.size() > 1 && header.column_major != Layout::kIsColumnMajor) {
+            throw std::invalid_argument("Load: layout of " + path + " does not match the array");
+        }
+        struct stat st;
+        if (::fstat(file.Descriptor(), &st) != 0) file.Fail("Load: cannot stat");
+        if (static_cast<types::Size>(st.st_size) < header.data_offset + header.Size() * sizeof(T)) {
+            throw std::runtime_error("Load: " + path + " is truncated");
+        }
+
+        if constexpr (Rank == kDynamicRank) {
+            if (a.Shape() != header.shape) a.Resize(header.shape);
+        } else {
+            typename Array<T, Rank, Layout>::shape_type shape;
+            std::copy(header.shape.begin(), header.shape.end(), shape.begin());
+            if (a.Shape() != shape) a.Resize(shape);
+        }
+        TransferArray(file, flags, a.Data(), a.Size(), header.data_offset, mode, false);
+
+        const types::Size component = FileDType<T>::component;
+        if (header.little_endian != NativeLittleEndian() && component > 1) {
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(a.Data());
+            ParallelRange(a.Size(), [=](const types::Size begin, const types::Size end) {
+                for (types::Size i = begin * sizeof(T); i < end * sizeof(T); i += component) {
+                    std::reverse(bytes + i, bytes + i + component);
+                }
+            });
+        }
+    }
+
+    template <typename A>
+    A Load(const std::string& path, const IoMode mode = IoMode::Buffered) {
+        A a;
+        Load(path, a, mode);
+        return a;
+    }
+}
+
+#endif /* IO_HPP */
@@ -8,13 +8,24 @@
     2025/02/17 kawasaki
         メモリの確保する際に、失敗した際の例外処理を加えた。
         ENABLE_ARGUMENT_CHECKとENABLE_INDEX_RANGE_CHECKの修正と追加
+    2026/10/17
+        Array1D-Array5D add move constructor, move assignment, Swap
+        extents and indices changed from int to std::size_t
+        Array2D-Array5D: contiguous storage indexed by operator() with precomputed
+        strides; the operator[] pointer table is built on first use only
+        Array1D GetMaxValue: start from numeric_limits<T>::lowest() (min() is the smallest positive float)
+        GetMinValue/GetMaxValue: branch-free inner loops
 */
 
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <cmath>
 #include <string>
 #include <complex>
 #include <limits>
+#include <utility>
 
 namespace array
 {
@@ -51,45 +62,48 @@ class Array1D
 public:
     // constructor
     Array1D();
-    explicit Array1D(const int n1);
-    Array1D(const int n1, const T &a);
-    Array1D(const int n1, const T *a);
+    explicit Array1D(const std::size_t n1);
+    Array1D(const std::size_t n1, const T &a);
+    Array1D(const std::size_t n1, const T *a);
     Array1D(const Array1D &rhs);
+    Array1D(Array1D &&rhs) noexcept;
 
     // destructor
     ~Array1D();
 
     // operator
     Array1D & operator=(const Array1D &rhs);
+    Array1D & operator=(Array1D &&rhs) noexcept;
     Array1D & operator=(const T &a);
     bool operator==(const Array1D &rhs);
-    inline T & operator[](const int i);
-    inline const T & operator[](const int i) const;
+    inline T & operator[](const std::size_t i);
+    inline const T & operator[](const std::size_t i) const;
 
     // menmber function
-	inline int GetDim1() const { return n1_;}
-    inline int Size() const { return n1_; }
+	inline std::size_t GetDim1() const { return n1_;}
+    inline std::size_t Size() const { return n1_; }
     inline ArrayStatus CheckArrayStatus() const { return status_; }
 
-	void Resize(const int n1); 
-	void Assign(const int n1, const T &a);
+	void Resize(const std::size_t n1); 
+	void Assign(const std::size_t n1, const T &a);
+    void Swap(Array1D &rhs) noexcept;
 
     T GetMinValue();
-    T GetMinValue(const int start, const int end);
+    T GetMinValue(const std::size_t start, const std::size_t end);
     T GetMinValue(const Array1D<int> &indice);
-    T GetMinValue(const Array1D<int> &indice, const int indice_start, const int indice_end);
+    T GetMinValue(const Array1D<int> &indice, const std::size_t indice_start, const std::size_t indice_end);
 
-    int GetMinValueIndex();
+    std::size_t GetMinValueIndex();
 
     T GetMaxValue();
-    T GetMaxValue(const int start, const int end);
+    T GetMaxValue(const std::size_t start, const std::size_t end);
     T GetMaxValue(const Array1D<int> &indice);
-    T GetMaxValue(const Array1D<int> &indice, const int indice_start, const int indice_end);
+    T GetMaxValue(const Array1D<int> &indice, const std::size_t indice_start, const std::size_t indice_end);
 
-    int GetMaxValueIndex();
+    std::size_t GetMaxValueIndex();
 
 private:
-    int n1_;
+    std::size_t n1_;
     T* pv_;
     ArrayStatus status_;
 
@@ -103,41 +117,41 @@ template<typename T>
 Array1D<T>::Array1D() : n1_(0), pv_(nullptr), status_(ArrayStatus::empty) { }
 
 template<typename T>
-Array1D<T>::Array1D(const int n1)
+Array1D<T>::Array1D(const std::size_t n1)
     : n1_(n1), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array1D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array1D : n1 == 0" << std::endl;
     }
 #endif
     AllocateArray();
 }
 
 template<typename T>
-Array1D<T>::Array1D(const int n1, const T &a)
+Array1D<T>::Array1D(const std::size_t n1, const T &a)
     : n1_(n1), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array1D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array1D : n1 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) pv_[i] = a;
+    for (std::size_t i = 0; i < n1; ++i) pv_[i] = a;
 }
 
 template<typename T>
-Array1D<T>::Array1D(const int n1, const T *a)
+Array1D<T>::Array1D(const std::size_t n1, const T *a)
     : n1_(n1), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array1D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array1D : n1 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) pv_[i] = *a++;
+    for (std::size_t i = 0; i < n1; ++i) pv_[i] = *a++;
 }
 
 template<typename T>
@@ -145,12 +159,21 @@ Array1D<T>::Array1D(const Array1D<T> &rhs)
     : n1_(rhs.n1_), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array1D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array1D : n1 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1_; ++i) pv_[i] = rhs[i];
+    for (std::size_t i = 0; i < n1_; ++i) pv_[i] = rhs[i];
+}
+
+template<typename T>
+Array1D<T>::Array1D(Array1D<T> &&rhs) noexcept
+    : n1_(rhs.n1_), pv_(rhs.pv_), status_(rhs.status_)
+{
+    rhs.n1_ = 0;
+    rhs.pv_ = nullptr;
+    rhs.status_ = ArrayStatus::empty;
 }
 
 // destructor
@@ -172,17 +195,32 @@ Array1D<T> & Array1D<T>::operator=(const Array1D<T> &rhs)
             n1_ = rhs.n1_;
             AllocateArray();
         }
-        for (int i = 0; i < n1_; ++i) pv_[i] = rhs[i];
+        for (std::size_t i = 0; i < n1_; ++i) pv_[i] = rhs[i];
     }
     return *this;
 }
 
 
+template<typename T>
+Array1D<T> & Array1D<T>::operator=(Array1D<T> &&rhs) noexcept
+{
+    if (this != &rhs) {
+        DeleteArray();
+        n1_ = rhs.n1_;
+        pv_     = rhs.pv_;
+        status_ = rhs.status_;
+        rhs.n1_ = 0;
+        rhs.pv_     = nullptr;
+        rhs.status_ = ArrayStatus::empty;
+    }
+    return *this;
+}
+
 template<typename T>
 Array1D<T> & Array1D<T>::operator=(const T &a)
 {
     if (status_ == ArrayStatus::allocated) {
-        for (int i = 0; i < n1_; ++i) pv_[i] = a;
+        for (std::size_t i = 0; i < n1_; ++i) pv_[i] = a;
     }
     return *this;
 }
@@ -194,7 +232,7 @@ bool Array1D<T>::operator==(const Array1D &rhs)
         return false;
     }
 
-    for (int i = 0; i < n1_; ++i) {
+    for (std::size_t i = 0; i < n1_; ++i) {
         if (pv_[i] != rhs.pv_[i]) {
             return false;
         }
@@ -204,10 +242,10 @@ bool Array1D<T>::operator==(const Array1D &rhs)
 }
 
 template<typename T>
-inline T & Array1D<T>::operator[](const int i)
+inline T & Array1D<T>::operator[](const std::size_t i)
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || n1_ <= i) {
+    if (n1_ <= i) {
         std::cerr << "Array1D : out of index range" << std::endl;
         std::abort();
     }
@@ -217,10 +255,10 @@ inline T & Array1D<T>::operator[](const int i)
 
 
 template<typename T>
-inline const T & Array1D<T>::operator[](const int i) const
+inline const T & Array1D<T>::operator[](const std::size_t i) const
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || n1_ <= i) {
+    if (n1_ <= i) {
         std::cerr << "Array1D : out of index range" << std::endl;
         std::abort();
     }
@@ -232,11 +270,11 @@ inline const T & Array1D<T>::operator[](const int i) const
 
 
 template<typename T>
-void Array1D<T>::Resize(const int n1)
+void Array1D<T>::Resize(const std::size_t n1)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1 <= 0) {
-        std::cerr << "Array1D::Resize : n1 <= 0" << std::endl;
+    if (n1 == 0) {
+        std::cerr << "Array1D::Resize : n1 == 0" << std::endl;
     }
 #endif
 
@@ -248,11 +286,11 @@ void Array1D<T>::Resize(const int n1)
 }
 
 template<typename T>
-void Array1D<T>::Assign(const int n1, const T &a)
+void Array1D<T>::Assign(const std::size_t n1, const T &a)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1 <= 0) {
-        std::cerr << "Array1D::Assign : n1 <= 0" << std::endl;
+    if (n1 == 0) {
+        std::cerr << "Array1D::Assign : n1 == 0" << std::endl;
     }
 #endif
 
@@ -261,7 +299,21 @@ void Array1D<T>::Assign(const int n1, const T &a)
         n1_ = n1;
         AllocateArray();
     }
-    for (int i = 0; i < n1; ++i) pv_[i] = a;
+    for (std::size_t i = 0; i < n1; ++i) pv_[i] = a;
+}
+
+template<typename T>
+void Array1D<T>::Swap(Array1D<T> &rhs) noexcept
+{
+    std::swap(n1_, rhs.n1_);
+    std::swap(pv_, rhs.pv_);
+    std::swap(status_, rhs.status_);
+}
+
+template<typename T>
+inline void swap(Array1D<T> &a, Array1D<T> &b) noexcept
+{
+    a.Swap(b);
 }
 
 template<typename T>
@@ -311,18 +363,18 @@ T Array1D<T>::GetMinValue()
 
     T min = std::numeric_limits<T>::max();
 
-    for (int i = 0; i < n1_; ++i) {
-        if (min > pv_[i]) min = pv_[i];
+    for (std::size_t i = 0; i < n1_; ++i) {
+        min = (pv_[i] < min) ? pv_[i] : min;
     }
 
     return min;
 }
 
 template<typename T>
-T Array1D<T>::GetMinValue(const int start, const int end)
+T Array1D<T>::GetMinValue(const std::size_t start, const std::size_t end)
 {
-    if (start < 0) {
-        std::cerr << "Error : Array1D::GetMinValue : start < 0" << std::endl;
+    if (start > end) {
+        std::cerr << "Error : Array1D::GetMinValue : start > end" << std::endl;
         return static_cast<T>(0);
     }
 
@@ -333,8 +385,8 @@ T Array1D<T>::GetMinValue(const int start, const int end)
 
     T min = std::numeric_limits<T>::max();
 
-    for (int i = start; i < end; ++i) {
-        if (min > pv_[i]) min = pv_[i];
+    for (std::size_t i = start; i < end; ++i) {
+        min = (pv_[i] < min) ? pv_[i] : min;
     }
 
     return min;
@@ -349,10 +401,10 @@ T Array1D<T>::GetMinValue(const Array1D<int> &indice)
     }
 
     T min = std::numeric_limits<T>::max();
-    int j, indice_size = indice.Size();
+    std::size_t j, indice_size = indice.Size();
 
-    for (int i = 0; i < indice_size; ++i) {
-        j = indice[i];
+    for (std::size_t i = 0; i < indice_size; ++i) {
+        j = static_cast<std::size_t>(indice[i]);
         if (j >= n1_) {
             // std::cerr << "Error : Array1D::GetMinValue : j >= n1" << std::endl;
             continue;
@@ -364,15 +416,15 @@ T Array1D<T>::GetMinValue(const Array1D<int> &indice)
 }
 
 template<typename T>
-T Array1D<T>::GetMinValue(const Array1D<int> &indice, const int indice_start, const int indice_end)
+T Array1D<T>::GetMinValue(const Array1D<int> &indice, const std::size_t indice_start, const std::size_t indice_end)
 {
     if (indice.CheckArrayStatus() == ArrayStatus::empty) {
         std::cerr << "Error : Array1D::GetMinValue : indice.status_ == ArrayStatus::empty" << std::endl;
         return static_cast<T>(0);
     }
 
-    if (indice_start < 0) {
-        std::cerr << "Error : Array1D::GetMinValue : indice_start < 0" << std::endl;
+    if (indice_start > indice_end) {
+        std::cerr << "Error : Array1D::GetMinValue : indice_start > indice_end" << std::endl;
         return static_cast<T>(0);
     }
 
@@ -382,10 +434,10 @@ T Array1D<T>::GetMinValue(const Array1D<int> &indice, const int indice_start, co
     }
 
     T min = std::numeric_limits<T>::max();
-    int j, indice_size = indice.Size();
+    std::size_t j, indice_size = indice.Size();
 
-    for (int i = indice_start; i < indice_end; ++i) {
-        j = indice[i];
+    for (std::size_t i = indice_start; i < indice_end; ++i) {
+        j = static_cast<std::size_t>(indice[i]);
         if (j >= n1_) {
             // std::cerr << "Error : Array1D::GetMinValue : j >= n" << std::endl;
             continue;
@@ -397,14 +449,14 @@ T Array1D<T>::GetMinValue(const Array1D<int> &indice, const int indice_start, co
 }
 
 template<typename T>
-int Array1D<T>::GetMinValueIndex()
+std::size_t Array1D<T>::GetMinValueIndex()
 {
     if (status_ == ArrayStatus::empty) return 0;
 
     T min = std::numeric_limits<T>::max();
-    int index = 0;
+    std::size_t index = 0;
 
-    for (int i = 0; i < n1_; ++i) {
+    for (std::size_t i = 0; i < n1_; ++i) {
         if (min > pv_[i]) {
             min   = pv_[i];
             index = i;
@@ -421,20 +473,20 @@ T Array1D<T>::GetMaxValue()
 {
     if (status_ == ArrayStatus::empty) return static_cast<T>(0);
 
-    T max = std::numeric_limits<T>::min();
+    T max = std::numeric_limits<T>::lowest();
 
-    for (int i = 0; i < n1_; ++i) {
-        if (max < pv_[i]) max = pv_[i];
+    for (std::size_t i = 0; i < n1_; ++i) {
+        max = (pv_[i] > max) ? pv_[i] : max;
     }
 
     return max;
 }
 
 template<typename T>
-T Array1D<T>::GetMaxValue(const int start, const int end)
+T Array1D<T>::GetMaxValue(const std::size_t start, const std::size_t end)
 {
-    if (start < 0) {
-        std::cerr << "Error : Array1D::GetMinValue : start < 0" << std::endl;
+    if (start > end) {
+        std::cerr << "Error : Array1D::GetMinValue : start > end" << std::endl;
         return static_cast<T>(0);
     }
 
@@ -443,10 +495,10 @@ T Array1D<T>::GetMaxValue(const int start, const int end)
         return static_cast<T>(0);
     }
 
-    T max = std::numeric_limits<T>::min();
+    T max = std::numeric_limits<T>::lowest();
 
-    for (int i = start; i < end; ++i) {
-        if (max < pv_[i]) max = pv_[i];
+    for (std::size_t i = start; i < end; ++i) {
+        max = (pv_[i] > max) ? pv_[i] : max;
     }
 
     return max;
@@ -460,11 +512,11 @@ T Array1D<T>::GetMaxValue(const Array1D<int> &indice)
         return static_cast<T>(0);
     }
 
-    T max = std::numeric_limits<T>::min();
-    int j, indice_size = indice.Size();
+    T max = std::numeric_limits<T>::lowest();
+    std::size_t j, indice_size = indice.Size();
 
-    for (int i = 0; i < indice_size; ++i) {
-        j = indice[i];
+    for (std::size_t i = 0; i < indice_size; ++i) {
+        j = static_cast<std::size_t>(indice[i]);
         if (j >= n1_) {
             // std::cerr << "Error : Array1D::GetMinValue : j >= n1" << std::endl;
             continue;
@@ -476,15 +528,15 @@ T Array1D<T>::GetMaxValue(const Array1D<int> &indice)
 }
 
 template<typename T>
-T Array1D<T>::GetMaxValue(const Array1D<int> &indice, const int indice_start, const int indice_end)
+T Array1D<T>::GetMaxValue(const Array1D<int> &indice, const std::size_t indice_start, const std::size_t indice_end)
 {
     if (indice.CheckArrayStatus() == ArrayStatus::empty) {
         std::cerr << "Error : Array1D::GetMinValue : indice.status_ == ArrayStatus::empty" << std::endl;
         return static_cast<T>(0);
     }
 
-    if (indice_start < 0) {
-        std::cerr << "Error : Array1D::GetMinValue : indice_start < 0" << std::endl;
+    if (indice_start > indice_end) {
+        std::cerr << "Error : Array1D::GetMinValue : indice_start > indice_end" << std::endl;
         return static_cast<T>(0);
     }
 
@@ -493,11 +545,11 @@ T Array1D<T>::GetMaxValue(const Array1D<int> &indice, const int indice_start, co
         return static_cast<T>(0);
     }
 
-    T max = std::numeric_limits<T>::min();
-    int j;
+    T max = std::numeric_limits<T>::lowest();
+    std::size_t j;
 
-    for (int i = indice_start; i < indice_end; ++i) {
-        j = indice[i];
+    for (std::size_t i = indice_start; i < indice_end; ++i) {
+        j = static_cast<std::size_t>(indice[i]);
         if (j >= n1_) {
             // std::cerr << "Error : Array1D::GetMinValue : j >= n" << std::endl;
             continue;
@@ -509,14 +561,14 @@ T Array1D<T>::GetMaxValue(const Array1D<int> &indice, const int indice_start, co
 }
 
 template<typename T>
-int Array1D<T>::GetMaxValueIndex()
+std::size_t Array1D<T>::GetMaxValueIndex()
 {
     if (status_ == ArrayStatus::empty) return 0;
 
-    T max = std::numeric_limits<T>::min();
-    int index = 0;
+    T max = std::numeric_limits<T>::lowest();
+    std::size_t index = 0;
 
-    for (int i = 0; i < n1_; ++i) {
+    for (std::size_t i = 0; i < n1_; ++i) {
         if (max < pv_[i]) {
             max   = pv_[i];
             index = i;
@@ -533,115 +585,131 @@ class Array2D
 #############################################################
 */
 
-
 template<typename T>
 class Array2D
 {
 public:
     // constructor
     Array2D();
-    Array2D(const int n1, const int n2);
-    Array2D(const int n1, const int n2, const T &a);
-    Array2D(const int n1, const int n2, const T *a);
+    Array2D(const std::size_t n1, const std::size_t n2);
+    Array2D(const std::size_t n1, const std::size_t n2, const T &a);
+    Array2D(const std::size_t n1, const std::size_t n2, const T *a);
     Array2D(const Array2D &rhs);
+    Array2D(Array2D &&rhs) noexcept;
 
     // destructor
     ~Array2D();
 
     // operator
     Array2D & operator=(const Array2D &rhs);
+    Array2D & operator=(Array2D &&rhs) noexcept;
     Array2D & operator=(const T &a);
 
-	inline T* operator[](const int i);
-	inline const T* operator[](const int i) const;
+    // a(i, j) : flat index with precomputed strides
+    inline T& operator()(const std::size_t i, const std::size_t j);
+    inline const T& operator()(const std::size_t i, const std::size_t j) const;
 
-    // menmber function
-	inline int GetDim1() const { return n1_;};
-	inline int GetDim2() const { return n2_; };
+    // a[i][j] : through a pointer table built on first use
+    inline T* operator[](const std::size_t i);
+    inline const T* operator[](const std::size_t i) const;
 
-	void Resize(const int n1, const int n2); 
-	void Assign(const int n1, const int n2, const T &a); 
+    // menmber function
+    inline std::size_t GetDim1() const { return n1_; }
+    inline std::size_t GetDim2() const { return n2_; }
+    inline std::size_t Size() const { return n1_ * n2_; }
+    inline T* Data() { return data_; }
+    inline const T* Data() const { return data_; }
+    inline bool HasPointerTable() const { return pv_.load(std::memory_order_acquire) != nullptr; }
+
+    void Resize(const std::size_t n1, const std::size_t n2);
+    void Assign(const std::size_t n1, const std::size_t n2, const T &a);
+    void Swap(Array2D &rhs) noexcept;
+    void ReleasePointerTable();
 
 private:
-    int n1_;
-    int n2_;
-    T **pv_;
+    std::size_t n1_;
+    std::size_t n2_;
+    std::size_t stride1_;
+    T *data_;
+    mutable std::atomic<T**> pv_;
     ArrayStatus status_;
 
     void AllocateArray();
     void DeleteArray();
+    T** PointerTable() const;
+    static void DeletePointerTable(T** table);
 };
 
 // constructor
 
 template<typename T>
-Array2D<T>::Array2D() : n1_(0), n2_(0), pv_(nullptr), status_(ArrayStatus::empty) { }
+Array2D<T>::Array2D() : n1_(0), n2_(0), stride1_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty) { }
 
 template<typename T>
-Array2D<T>::Array2D(const int n1, const int n2)
-    : n1_(n1), n2_(n2), pv_(nullptr), status_(ArrayStatus::empty)
+Array2D<T>::Array2D(const std::size_t n1, const std::size_t n2)
+    : n1_(n1), n2_(n2), stride1_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1 <= 0) {
-        std::cout << "n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array2D : n1 == 0" << std::endl;
     }
-    if (n2 <= 0) {
-        std::cout << "n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array2D : n2 == 0" << std::endl;
     }
 #endif
     AllocateArray();
 }
 
 template<typename T>
-Array2D<T>::Array2D(const int n1, const int n2, const T &a)
-    : n1_(n1), n2_(n2), pv_(nullptr), status_(ArrayStatus::empty)
+Array2D<T>::Array2D(const std::size_t n1, const std::size_t n2, const T &a)
+    : n1_(n1), n2_(n2), stride1_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1 <= 0) {
-        std::cout << "n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array2D : n1 == 0" << std::endl;
     }
-    if (n2 <= 0) {
-        std::cout << "n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array2D : n2 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            pv_[i][j] = a;
-        }
-    }
+    std::fill(data_, data_ + Size(), a);
 }
 
 template<typename T>
-Array2D<T>::Array2D(const int n1, const int n2, const T *a)
-    : n1_(n1), n2_(n2), pv_(nullptr), status_(ArrayStatus::empty)
+Array2D<T>::Array2D(const std::size_t n1, const std::size_t n2, const T *a)
+    : n1_(n1), n2_(n2), stride1_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1 <= 0) {
-        std::cout << "n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array2D : n1 == 0" << std::endl;
     }
-    if (n2 <= 0) {
-        std::cout << "n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array2D : n2 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            pv_[i][j] = *a++;
-        }
-    }
+    std::copy(a, a + Size(), data_);
 }
 
 template<typename T>
-Array2D<T>::Array2D(const Array2D &rhs)
-    : n1_(rhs.n1_), n2_(rhs.n2_), pv_(nullptr), status_(ArrayStatus::empty)
+Array2D<T>::Array2D(const Array2D<T> &rhs)
+    : n1_(rhs.n1_), n2_(rhs.n2_), stride1_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
     AllocateArray();
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            pv_[i][j] = rhs[i][j];
-        }
-    }
+    std::copy(rhs.data_, rhs.data_ + Size(), data_);
+}
+
+template<typename T>
+Array2D<T>::Array2D(Array2D<T> &&rhs) noexcept
+    : n1_(rhs.n1_), n2_(rhs.n2_), stride1_(rhs.stride1_),
+      data_(rhs.data_), pv_(rhs.pv_.load(std::memory_order_acquire)), status_(rhs.status_)
+{
+    rhs.n1_ = 0;
+    rhs.n2_ = 0;
+    rhs.data_ = nullptr;
+    rhs.pv_.store(nullptr, std::memory_order_release);
+    rhs.status_ = ArrayStatus::empty;
 }
 
 // destructor
@@ -652,6 +720,7 @@ Array2D<T>::~Array2D()
 }
 
 // operator
+
 template<typename T>
 Array2D<T> & Array2D<T>::operator=(const Array2D &rhs)
 {
@@ -664,59 +733,94 @@ Array2D<T> & Array2D<T>::operator=(const Array2D &rhs)
             AllocateArray();
         }
 
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                pv_[i][j] = rhs[i][j];
-            }
-        }
+        std::copy(rhs.data_, rhs.data_ + Size(), data_);
 
     }
 
     return *this;
 }
 
+template<typename T>
+Array2D<T> & Array2D<T>::operator=(Array2D<T> &&rhs) noexcept
+{
+    if (this != &rhs) {
+        DeleteArray();
+        n1_ = rhs.n1_;
+        n2_ = rhs.n2_;
+        stride1_ = rhs.stride1_;
+        data_   = rhs.data_;
+        pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+        status_ = rhs.status_;
+        rhs.n1_ = 0;
+        rhs.n2_ = 0;
+        rhs.data_   = nullptr;
+        rhs.pv_.store(nullptr, std::memory_order_release);
+        rhs.status_ = ArrayStatus::empty;
+    }
+    return *this;
+}
+
 template<typename T>
 Array2D<T> & Array2D<T>::operator=(const T &a)
 {
     if (status_ == ArrayStatus::allocated) {
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                pv_[i][j] = a;
-            }
-        }
+        std::fill(data_, data_ + Size(), a);
     }
-
     return *this;
 }
 
 template<typename T>
-inline T* Array2D<T>::operator[](const int i)
+inline T& Array2D<T>::operator()(const std::size_t i, const std::size_t j)
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_ || j >= n2_) {
         std::cerr << "Array2D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return data_[i*stride1_ + j];
 }
 
 template<typename T>
-inline const T* Array2D<T>::operator[](const int i) const
+inline const T& Array2D<T>::operator()(const std::size_t i, const std::size_t j) const
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_ || j >= n2_) {
         std::cerr << "Array2D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return data_[i*stride1_ + j];
+}
+
+template<typename T>
+inline T* Array2D<T>::operator[](const std::size_t i)
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_) {
+        std::cerr << "Array2D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return PointerTable()[i];
+}
+
+template<typename T>
+inline const T* Array2D<T>::operator[](const std::size_t i) const
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_) {
+        std::cerr << "Array2D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return PointerTable()[i];
 }
 
-// menmber function
+// member function
 
 template<typename T>
-void Array2D<T>::Resize(const int n1, const int n2)
+void Array2D<T>::Resize(const std::size_t n1, const std::size_t n2)
 {
     if (n1 != n1_ || n2 != n2_) {
         DeleteArray();
@@ -727,7 +831,7 @@ void Array2D<T>::Resize(const int n1, const int n2)
 }
 
 template<typename T>
-void Array2D<T>::Assign(const int n1, const int n2, const T &a)
+void Array2D<T>::Assign(const std::size_t n1, const std::size_t n2, const T &a)
 {
     if (n1 != n1_ || n2 != n2_) {
         DeleteArray();
@@ -735,60 +839,107 @@ void Array2D<T>::Assign(const int n1, const int n2, const T &a)
         n2_ = n2;
         AllocateArray();
     }
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            pv_[i][j] = a;
-        }
-    }
+    std::fill(data_, data_ + Size(), a);
 }
 
+template<typename T>
+void Array2D<T>::Swap(Array2D<T> &rhs) noexcept
+{
+    std::swap(n1_, rhs.n1_);
+    std::swap(n2_, rhs.n2_);
+    std::swap(stride1_, rhs.stride1_);
+    std::swap(data_, rhs.data_);
+    T** table = pv_.load(std::memory_order_acquire);
+    pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+    rhs.pv_.store(table, std::memory_order_release);
+    std::swap(status_, rhs.status_);
+}
 
+template<typename T>
+inline void swap(Array2D<T> &a, Array2D<T> &b) noexcept
+{
+    a.Swap(b);
+}
+
+// Frees the pointer table used by operator[]; it is rebuilt on the next operator[].
+template<typename T>
+void Array2D<T>::ReleasePointerTable()
+{
+    T** table = pv_.exchange(nullptr, std::memory_order_acq_rel);
+    if (table != nullptr) {
+        DeletePointerTable(table);
+    }
+}
 
 template<typename T>
 void Array2D<T>::AllocateArray()
 {
     if (status_ == ArrayStatus::empty) {
 
-        try {
-
-            pv_ = new T*[n1_];
-            pv_[0] = new T[n1_ * n2_];
+        stride1_ = n2_;
 
-            for (int i = 0; i < n1_; ++i) {
-                pv_[i] = pv_[0] + i*n2_;
-            }
+        try {
 
+            data_ = new T[Size()];
             status_ = ArrayStatus::allocated;
 
         } catch (const std::bad_alloc& e) {
 
             std::cerr << "Array2D::AllocateArray : Memory allocation failed: " << e.what() << std::endl;
 
-            if (pv_[0] != nullptr) {
-                delete[] pv_[0];
-            }
-            if (pv_ != nullptr) {
-                delete[] pv_;
-            }
-            pv_ = nullptr;
-
+            data_ = nullptr;
             status_ = ArrayStatus::empty;
         }
     }
 }
 
-
 template<typename T>
 void Array2D<T>::DeleteArray()
 {
     if (status_ == ArrayStatus::allocated) {
-        delete [] pv_[0];
-        delete [] pv_;
-        pv_ = nullptr;
+        ReleasePointerTable();
+        delete [] data_;
+        data_ = nullptr;
         status_ = ArrayStatus::empty;
     }
 }
 
+// Builds the operator[] pointer table over data_ on first use. Concurrent
+// callers may both build one; only the first is published, the other is freed.
+template<typename T>
+T** Array2D<T>::PointerTable() const
+{
+    T** table = pv_.load(std::memory_order_acquire);
+    if (table != nullptr || status_ == ArrayStatus::empty || Size() == 0) {
+        return table;
+    }
+
+    T* *p1 = nullptr;
+    try {
+        p1 = new T*[n1_];
+    } catch (const std::bad_alloc& e) {
+        std::cerr << "Array2D::PointerTable : Memory allocation failed: " << e.what() << std::endl;
+        delete [] p1;
+        std::abort();
+    }
+
+    for (std::size_t n = 0; n < n1_; ++n) {
+        p1[n] = data_ + n*n2_;
+    }
+
+    if (!pv_.compare_exchange_strong(table, p1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        DeletePointerTable(p1);
+        return table;
+    }
+    return p1;
+}
+
+template<typename T>
+void Array2D<T>::DeletePointerTable(T** table)
+{
+    delete [] table;
+}
+
 /*
 #############################################################
 class Array3D
@@ -801,127 +952,138 @@ class Array3D
 public:
     // constructor
     Array3D();
-    Array3D(const int n1, const int n2, const int n3);
-    Array3D(const int n1, const int n2, const int n3, const T &a);
-    Array3D(const int n1, const int n2, const int n4, const T *a);
+    Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3);
+    Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T &a);
+    Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T *a);
     Array3D(const Array3D &rhs);
+    Array3D(Array3D &&rhs) noexcept;
 
     // destructor
     ~Array3D();
 
     // operator
     Array3D & operator=(const Array3D &rhs);
+    Array3D & operator=(Array3D &&rhs) noexcept;
     Array3D & operator=(const T &a);
 
-	inline T** operator[](const int i);
-	inline const T* const * operator[](const int i) const;
+    // a(i, j, k) : flat index with precomputed strides
+    inline T& operator()(const std::size_t i, const std::size_t j, const std::size_t k);
+    inline const T& operator()(const std::size_t i, const std::size_t j, const std::size_t k) const;
 
-    // menmber function
-	inline int GetDim1() const { return n1_; }
-	inline int GetDim2() const { return n2_; }
-    inline int GetDim3() const { return n3_; }
+    // a[i][j][k] : through a pointer table built on first use
+    inline T** operator[](const std::size_t i);
+    inline const T* const * operator[](const std::size_t i) const;
 
-	void Resize(const int n1, const int n2, const int n3); 
-	void Assign(const int n1, const int n2, const int n3, const T &a); 
+    // menmber function
+    inline std::size_t GetDim1() const { return n1_; }
+    inline std::size_t GetDim2() const { return n2_; }
+    inline std::size_t GetDim3() const { return n3_; }
+    inline std::size_t Size() const { return n1_ * n2_ * n3_; }
+    inline T* Data() { return data_; }
+    inline const T* Data() const { return data_; }
+    inline bool HasPointerTable() const { return pv_.load(std::memory_order_acquire) != nullptr; }
+
+    void Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3);
+    void Assign(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T &a);
+    void Swap(Array3D &rhs) noexcept;
+    void ReleasePointerTable();
 
 private:
-    int n1_;
-    int n2_;
-    int n3_;
-    T ***pv_;
+    std::size_t n1_;
+    std::size_t n2_;
+    std::size_t n3_;
+    std::size_t stride1_;
+    std::size_t stride2_;
+    T *data_;
+    mutable std::atomic<T***> pv_;
     ArrayStatus status_;
 
     void AllocateArray();
     void DeleteArray();
+    T*** PointerTable() const;
+    static void DeletePointerTable(T*** table);
 };
 
 // constructor
 
 template<typename T>
-Array3D<T>::Array3D() : n1_(0), n2_(0), n3_(0), pv_(nullptr), status_(ArrayStatus::empty) { }
+Array3D<T>::Array3D() : n1_(0), n2_(0), n3_(0), stride1_(0), stride2_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty) { }
 
 template<typename T>
-Array3D<T>::Array3D(const int n1, const int n2, const int n3)
-    : n1_(n1), n2_(n2), n3_(n3), pv_(nullptr), status_(ArrayStatus::empty)
+Array3D<T>::Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3)
+    : n1_(n1), n2_(n2), n3_(n3), stride1_(0), stride2_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array3D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array3D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array3D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array3D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array3D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array3D : n3 == 0" << std::endl;
     }
 #endif
     AllocateArray();
 }
 
 template<typename T>
-Array3D<T>::Array3D(const int n1, const int n2, const int n3, const T &a)
-    : n1_(n1), n2_(n2), n3_(n3), pv_(nullptr), status_(ArrayStatus::empty)
+Array3D<T>::Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T &a)
+    : n1_(n1), n2_(n2), n3_(n3), stride1_(0), stride2_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array3D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array3D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array3D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array3D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array3D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array3D : n3 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            for (int k = 0; k < n3; ++k) {
-                pv_[i][j][k] = a;
-            }
-        }
-    }
+    std::fill(data_, data_ + Size(), a);
 }
 
-
 template<typename T>
-Array3D<T>::Array3D(const int n1, const int n2, const int n3, const T *a)
-    : n1_(n1), n2_(n2), n3_(n3), pv_(nullptr), status_(ArrayStatus::empty)
+Array3D<T>::Array3D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T *a)
+    : n1_(n1), n2_(n2), n3_(n3), stride1_(0), stride2_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array3D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array3D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array3D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array3D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array3D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array3D : n3 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            for (int k = 0; k < n3; ++k) {
-                pv_[i][j][k] = *a++;
-            }
-        }
-    }
+    std::copy(a, a + Size(), data_);
 }
 
-
 template<typename T>
 Array3D<T>::Array3D(const Array3D<T> &rhs)
-    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), pv_(nullptr), status_(ArrayStatus::empty)
+    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), stride1_(0), stride2_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
     AllocateArray();
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            for (int k = 0; k < n3_; ++k) {
-                pv_[i][j][k] = rhs[i][j][k];
-            }
-        }
-    }
+    std::copy(rhs.data_, rhs.data_ + Size(), data_);
+}
+
+template<typename T>
+Array3D<T>::Array3D(Array3D<T> &&rhs) noexcept
+    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), stride1_(rhs.stride1_), stride2_(rhs.stride2_),
+      data_(rhs.data_), pv_(rhs.pv_.load(std::memory_order_acquire)), status_(rhs.status_)
+{
+    rhs.n1_ = 0;
+    rhs.n2_ = 0;
+    rhs.n3_ = 0;
+    rhs.data_ = nullptr;
+    rhs.pv_.store(nullptr, std::memory_order_release);
+    rhs.status_ = ArrayStatus::empty;
 }
 
 // destructor
@@ -946,62 +1108,97 @@ Array3D<T> & Array3D<T>::operator=(const Array3D &rhs)
             AllocateArray();
         }
 
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                for (int k = 0; k < n3_; ++k) {
-                    pv_[i][j][k] = rhs[i][j][k];
-                }
-            }
-        }
+        std::copy(rhs.data_, rhs.data_ + Size(), data_);
 
     }
 
     return *this;
 }
 
+template<typename T>
+Array3D<T> & Array3D<T>::operator=(Array3D<T> &&rhs) noexcept
+{
+    if (this != &rhs) {
+        DeleteArray();
+        n1_ = rhs.n1_;
+        n2_ = rhs.n2_;
+        n3_ = rhs.n3_;
+        stride1_ = rhs.stride1_;
+        stride2_ = rhs.stride2_;
+        data_   = rhs.data_;
+        pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+        status_ = rhs.status_;
+        rhs.n1_ = 0;
+        rhs.n2_ = 0;
+        rhs.n3_ = 0;
+        rhs.data_   = nullptr;
+        rhs.pv_.store(nullptr, std::memory_order_release);
+        rhs.status_ = ArrayStatus::empty;
+    }
+    return *this;
+}
+
 template<typename T>
 Array3D<T> & Array3D<T>::operator=(const T &a)
 {
     if (status_ == ArrayStatus::allocated) {
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                for (int k = 0; k < n3_; ++k) {
-                    pv_[i][j][k] = a;
-                }
-            }
-        }
+        std::fill(data_, data_ + Size(), a);
     }
     return *this;
 }
 
 template<typename T>
-inline T** Array3D<T>::operator[](const int i)
+inline T& Array3D<T>::operator()(const std::size_t i, const std::size_t j, const std::size_t k)
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_ || j >= n2_ || k >= n3_) {
         std::cerr << "Array3D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return data_[i*stride1_ + j*stride2_ + k];
 }
 
 template<typename T>
-inline const T* const * Array3D<T>::operator[](const int i) const
+inline const T& Array3D<T>::operator()(const std::size_t i, const std::size_t j, const std::size_t k) const
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_ || j >= n2_ || k >= n3_) {
         std::cerr << "Array3D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return data_[i*stride1_ + j*stride2_ + k];
+}
+
+template<typename T>
+inline T** Array3D<T>::operator[](const std::size_t i)
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_) {
+        std::cerr << "Array3D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return PointerTable()[i];
+}
+
+template<typename T>
+inline const T* const * Array3D<T>::operator[](const std::size_t i) const
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_) {
+        std::cerr << "Array3D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return PointerTable()[i];
 }
 
 // member function
 
 template<typename T>
-void Array3D<T>::Resize(const int n1, const int n2, const int n3)
+void Array3D<T>::Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3)
 {
     if (n1 != n1_ || n2 != n2_ || n3 != n3_) {
         DeleteArray();
@@ -1013,7 +1210,7 @@ void Array3D<T>::Resize(const int n1, const int n2, const int n3)
 }
 
 template<typename T>
-void Array3D<T>::Assign(const int n1, const int n2, const int n3, const T &a)
+void Array3D<T>::Assign(const std::size_t n1, const std::size_t n2, const std::size_t n3, const T &a)
 {
     if (n1 != n1_ || n2 != n2_ || n3 != n3_) {
         DeleteArray();
@@ -1022,12 +1219,37 @@ void Array3D<T>::Assign(const int n1, const int n2, const int n3, const T &a)
         n3_ = n3;
         AllocateArray();
     }
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            for (int k = 0; k < n3_; ++k) {
-                pv_[i][j][k] = a;
-            }
-        }
+    std::fill(data_, data_ + Size(), a);
+}
+
+template<typename T>
+void Array3D<T>::Swap(Array3D<T> &rhs) noexcept
+{
+    std::swap(n1_, rhs.n1_);
+    std::swap(n2_, rhs.n2_);
+    std::swap(n3_, rhs.n3_);
+    std::swap(stride1_, rhs.stride1_);
+    std::swap(stride2_, rhs.stride2_);
+    std::swap(data_, rhs.data_);
+    T*** table = pv_.load(std::memory_order_acquire);
+    pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+    rhs.pv_.store(table, std::memory_order_release);
+    std::swap(status_, rhs.status_);
+}
+
+template<typename T>
+inline void swap(Array3D<T> &a, Array3D<T> &b) noexcept
+{
+    a.Swap(b);
+}
+
+// Frees the pointer table used by operator[]; it is rebuilt on the next operator[].
+template<typename T>
+void Array3D<T>::ReleasePointerTable()
+{
+    T*** table = pv_.exchange(nullptr, std::memory_order_acq_rel);
+    if (table != nullptr) {
+        DeletePointerTable(table);
     }
 }
 
@@ -1036,36 +1258,19 @@ void Array3D<T>::AllocateArray()
 {
     if (status_ == ArrayStatus::empty) {
 
-        try {
-
-            pv_  = new T**[n1_];
-            pv_[0] = new T*[n1_ * n2_];
-            pv_[0][0] = new T[n1_ * n2_ * n3_];
+        stride2_ = n3_;
+        stride1_ = n2_ * stride2_;
 
-            for (int i = 0; i < n1_; ++i) {
-                pv_[i] = pv_[0] + i*n2_;
-                for (int j = 0; j < n2_; ++j) {
-                    pv_[i][j] = pv_[0][0] + i*n2_*n3_ + j*n3_;
-                }
-            }
+        try {
 
+            data_ = new T[Size()];
             status_ = ArrayStatus::allocated;
 
         } catch (const std::bad_alloc& e) {
 
             std::cerr << "Array3D::AllocateArray : Memory allocation failed: " << e.what() << std::endl;
 
-            if (pv_[0][0] != nullptr) {
-                delete[] pv_[0][0];
-            }
-            if (pv_[0] != nullptr) {
-                delete[] pv_[0];
-            }
-            if (pv_ != nullptr) {
-                delete[] pv_;
-            }
-            pv_ = nullptr;
-
+            data_ = nullptr;
             status_ = ArrayStatus::empty;
         }
     }
@@ -1075,14 +1280,56 @@ template<typename T>
 void Array3D<T>::DeleteArray()
 {
     if (status_ == ArrayStatus::allocated) {
-        delete [] pv_[0][0];
-        delete [] pv_[0];
-        delete [] pv_;
-        pv_ = nullptr;
+        ReleasePointerTable();
+        delete [] data_;
+        data_ = nullptr;
         status_ = ArrayStatus::empty;
     }
 }
 
+// Builds the operator[] pointer table over data_ on first use. Concurrent
+// callers may both build one; only the first is published, the other is freed.
+template<typename T>
+T*** Array3D<T>::PointerTable() const
+{
+    T*** table = pv_.load(std::memory_order_acquire);
+    if (table != nullptr || status_ == ArrayStatus::empty || Size() == 0) {
+        return table;
+    }
+
+    T** *p1 = nullptr;
+    T* *p2 = nullptr;
+    try {
+        p1 = new T**[n1_];
+        p2 = new T*[n1_ * n2_];
+    } catch (const std::bad_alloc& e) {
+        std::cerr << "Array3D::PointerTable : Memory allocation failed: " << e.what() << std::endl;
+        delete [] p1;
+        delete [] p2;
+        std::abort();
+    }
+
+    for (std::size_t n = 0; n < n1_; ++n) {
+        p1[n] = p2 + n*n2_;
+    }
+    for (std::size_t n = 0; n < n1_ * n2_; ++n) {
+        p2[n] = data_ + n*n3_;
+    }
+
+    if (!pv_.compare_exchange_strong(table, p1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        DeletePointerTable(p1);
+        return table;
+    }
+    return p1;
+}
+
+template<typename T>
+void Array3D<T>::DeletePointerTable(T*** table)
+{
+    delete [] table[0];
+    delete [] table;
+}
+
 /*
 #############################################################
 class Array4D
@@ -1095,159 +1342,151 @@ class Array4D
 public:
     // constructor
     Array4D();
-    Array4D(const int n1, const int n2, const int n3, const int n4);
-    Array4D(const int n1, const int n2, const int n3, const int n4, const T &a);
-    Array4D(const int n1, const int n2, const int n3, const int n4, const T *a);
+    Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4);
+    Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T &a);
+    Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T *a);
     Array4D(const Array4D &rhs);
+    Array4D(Array4D &&rhs) noexcept;
 
     // destructor
     ~Array4D();
 
     // operator
     Array4D & operator=(const Array4D &rhs);
+    Array4D & operator=(Array4D &&rhs) noexcept;
     Array4D & operator=(const T &a);
 
-    inline T*** operator[](const int i);
-	inline const T* const * const * operator[](const int i) const;
+    // a(i, j, k, l) : flat index with precomputed strides
+    inline T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l);
+    inline const T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l) const;
 
-    // menmber function
-	inline int GetDim1() const { return n1_; }
-	inline int GetDim2() const { return n2_; }
-    inline int GetDim3() const { return n3_; }
-    inline int GetDim4() const { return n4_; }
+    // a[i][j][k][l] : through a pointer table built on first use
+    inline T*** operator[](const std::size_t i);
+    inline const T* const * const * operator[](const std::size_t i) const;
 
-	void Resize(const int n1, const int n2, const int n3, const int n4); 
-	void Assign(const int n1, const int n2, const int n3, const int n4, const T &a);
+    // menmber function
+    inline std::size_t GetDim1() const { return n1_; }
+    inline std::size_t GetDim2() const { return n2_; }
+    inline std::size_t GetDim3() const { return n3_; }
+    inline std::size_t GetDim4() const { return n4_; }
+    inline std::size_t Size() const { return n1_ * n2_ * n3_ * n4_; }
+    inline T* Data() { return data_; }
+    inline const T* Data() const { return data_; }
+    inline bool HasPointerTable() const { return pv_.load(std::memory_order_acquire) != nullptr; }
+
+    void Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4);
+    void Assign(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T &a);
+    void Swap(Array4D &rhs) noexcept;
+    void ReleasePointerTable();
 
 private:
-    int n1_;
-    int n2_;
-    int n3_;
-    int n4_;
-    T ****pv_;
+    std::size_t n1_;
+    std::size_t n2_;
+    std::size_t n3_;
+    std::size_t n4_;
+    std::size_t stride1_;
+    std::size_t stride2_;
+    std::size_t stride3_;
+    T *data_;
+    mutable std::atomic<T****> pv_;
     ArrayStatus status_;
 
     void AllocateArray();
     void DeleteArray();
-
+    T**** PointerTable() const;
+    static void DeletePointerTable(T**** table);
 };
 
 // constructor
 
 template<typename T>
-Array4D<T>::Array4D() : n1_(0), n2_(0), n3_(0), n4_(0), pv_(nullptr), status_(ArrayStatus::empty) { }
+Array4D<T>::Array4D() : n1_(0), n2_(0), n3_(0), n4_(0), stride1_(0), stride2_(0), stride3_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty) { }
 
 template<typename T>
-Array4D<T>::Array4D(const int n1, const int n2, const int n3, const int n4)
-    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), pv_(nullptr), status_(ArrayStatus::empty)
+Array4D<T>::Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4)
+    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), stride1_(0), stride2_(0), stride3_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array4D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array4D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array4D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array4D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array4D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array4D : n3 == 0" << std::endl;
     }
-    if (n4_ <= 0) {
-        std::cerr << "Array4D : n4 <= 0" << std::endl;
+    if (n4_ == 0) {
+        std::cerr << "Array4D : n4 == 0" << std::endl;
     }
 #endif
     AllocateArray();
 }
 
 template<typename T>
-Array4D<T>::Array4D(const int n1, const int n2, const int n3, const int n4, const T &a)
-    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), pv_(nullptr), status_(ArrayStatus::empty)
+Array4D<T>::Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T &a)
+    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), stride1_(0), stride2_(0), stride3_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array4D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array4D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array4D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array4D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array4D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array4D : n3 == 0" << std::endl;
     }
-    if (n4_ <= 0) {
-        std::cerr << "Array4D : n4 <= 0" << std::endl;
+    if (n4_ == 0) {
+        std::cerr << "Array4D : n4 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            for (int k = 0; k < n3; ++k) {
-                for (int l = 0; l < n4; ++l) {
-                    pv_[i][j][k][l] = a;
-                }
-            }
-        }
-    }
+    std::fill(data_, data_ + Size(), a);
 }
 
-
 template<typename T>
-Array4D<T>::Array4D(const int n1, const int n2, const int n3, const int n4, const T *a)
-    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), pv_(nullptr), status_(ArrayStatus::empty)
+Array4D<T>::Array4D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T *a)
+    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), stride1_(0), stride2_(0), stride3_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array4D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array4D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array4D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array4D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array4D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array4D : n3 == 0" << std::endl;
     }
-    if (n4_ <= 0) {
-        std::cerr << "Array4D : n4 <= 0" << std::endl;
+    if (n4_ == 0) {
+        std::cerr << "Array4D : n4 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            for (int k = 0; k < n3; ++k) {
-                for (int l = 0; l < n4; ++l) {
-                    pv_[i][j][k][l] = *a++;
-                }
-            }
-        }
-    }
+    std::copy(a, a + Size(), data_);
 }
 
-
 template<typename T>
 Array4D<T>::Array4D(const Array4D<T> &rhs)
-    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), n4_(rhs.n4_), pv_(nullptr), status_(ArrayStatus::empty)
+    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), n4_(rhs.n4_), stride1_(0), stride2_(0), stride3_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
-#ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array4D : n1 <= 0" << std::endl;
-    }
-    if (n2_ <= 0) {
-        std::cerr << "Array4D : n2 <= 0" << std::endl;
-    }
-    if (n3_ <= 0) {
-        std::cerr << "Array4D : n3 <= 0" << std::endl;
-    }
-    if (n4_ <= 0) {
-        std::cerr << "Array4D : n4 <= 0" << std::endl;
-    }
-#endif
     AllocateArray();
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            for (int k = 0; k < n3_; ++k) {
-                for (int l = 0; l < n4_; ++l) {
-                    pv_[i][j][k][l] = rhs[i][j][k][l];
-                }
-            }
-        }
-    }
+    std::copy(rhs.data_, rhs.data_ + Size(), data_);
+}
+
+template<typename T>
+Array4D<T>::Array4D(Array4D<T> &&rhs) noexcept
+    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), n4_(rhs.n4_), stride1_(rhs.stride1_), stride2_(rhs.stride2_), stride3_(rhs.stride3_),
+      data_(rhs.data_), pv_(rhs.pv_.load(std::memory_order_acquire)), status_(rhs.status_)
+{
+    rhs.n1_ = 0;
+    rhs.n2_ = 0;
+    rhs.n3_ = 0;
+    rhs.n4_ = 0;
+    rhs.data_ = nullptr;
+    rhs.pv_.store(nullptr, std::memory_order_release);
+    rhs.status_ = ArrayStatus::empty;
 }
 
 // destructor
@@ -1273,69 +1512,100 @@ Array4D<T> & Array4D<T>::operator=(const Array4D &rhs)
             AllocateArray();
         }
 
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                for (int k = 0; k < n3_; ++k) {
-                    for (int l = 0; l < n4_; ++l) {
-                        pv_[i][j][k][l] = rhs[i][j][k][l];
-                    }
-                }
-            }
-        }
+        std::copy(rhs.data_, rhs.data_ + Size(), data_);
 
     }
 
     return *this;
 }
 
+template<typename T>
+Array4D<T> & Array4D<T>::operator=(Array4D<T> &&rhs) noexcept
+{
+    if (this != &rhs) {
+        DeleteArray();
+        n1_ = rhs.n1_;
+        n2_ = rhs.n2_;
+        n3_ = rhs.n3_;
+        n4_ = rhs.n4_;
+        stride1_ = rhs.stride1_;
+        stride2_ = rhs.stride2_;
+        stride3_ = rhs.stride3_;
+        data_   = rhs.data_;
+        pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+        status_ = rhs.status_;
+        rhs.n1_ = 0;
+        rhs.n2_ = 0;
+        rhs.n3_ = 0;
+        rhs.n4_ = 0;
+        rhs.data_   = nullptr;
+        rhs.pv_.store(nullptr, std::memory_order_release);
+        rhs.status_ = ArrayStatus::empty;
+    }
+    return *this;
+}
+
 template<typename T>
 Array4D<T> & Array4D<T>::operator=(const T &a)
 {
     if (status_ == ArrayStatus::allocated) {
+        std::fill(data_, data_ + Size(), a);
+    }
+    return *this;
+}
 
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                for (int k = 0; k < n3_; ++k) {
-                    for (int l = 0; l < n4_; ++l) {
-                        pv_[i][j][k][l] = a;
-                    }
-                }
-            }
-        }
-
+template<typename T>
+inline T& Array4D<T>::operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l)
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_ || j >= n2_ || k >= n3_ || l >= n4_) {
+        std::cerr << "Array4D : out of index range" << std::endl;
+        std::abort();
     }
+#endif
+    return data_[i*stride1_ + j*stride2_ + k*stride3_ + l];
+}
 
-    return *this;
+template<typename T>
+inline const T& Array4D<T>::operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l) const
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_ || j >= n2_ || k >= n3_ || l >= n4_) {
+        std::cerr << "Array4D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return data_[i*stride1_ + j*stride2_ + k*stride3_ + l];
 }
 
 template<typename T>
-inline T*** Array4D<T>::operator[](const int i)
+inline T*** Array4D<T>::operator[](const std::size_t i)
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_) {
         std::cerr << "Array4D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return PointerTable()[i];
 }
 
 template<typename T>
-inline const T* const * const * Array4D<T>::operator[](const int i) const
+inline const T* const * const * Array4D<T>::operator[](const std::size_t i) const
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_) {
         std::cerr << "Array4D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return PointerTable()[i];
 }
 
 // member function
 
 template<typename T>
-void Array4D<T>::Resize(const int n1, const int n2, const int n3, const int n4)
+void Array4D<T>::Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4)
 {
     if (n1 != n1_ || n2 != n2_ || n3 != n3_ || n4 != n4_) {
         DeleteArray();
@@ -1348,7 +1618,7 @@ void Array4D<T>::Resize(const int n1, const int n2, const int n3, const int n4)
 }
 
 template<typename T>
-void Array4D<T>::Assign(const int n1, const int n2, const int n3, const int n4, const T &a)
+void Array4D<T>::Assign(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const T &a)
 {
     if (n1 != n1_ || n2 != n2_ || n3 != n3_ || n4 != n4_) {
         DeleteArray();
@@ -1358,14 +1628,39 @@ void Array4D<T>::Assign(const int n1, const int n2, const int n3, const int n4,
         n4_ = n4;
         AllocateArray();
     }
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            for (int k = 0; k < n3_; ++k) {
-                for (int l = 0; l < n4_; ++l) {
-                    pv_[i][j][k][l] = a;
-                }
-            }
-        }
+    std::fill(data_, data_ + Size(), a);
+}
+
+template<typename T>
+void Array4D<T>::Swap(Array4D<T> &rhs) noexcept
+{
+    std::swap(n1_, rhs.n1_);
+    std::swap(n2_, rhs.n2_);
+    std::swap(n3_, rhs.n3_);
+    std::swap(n4_, rhs.n4_);
+    std::swap(stride1_, rhs.stride1_);
+    std::swap(stride2_, rhs.stride2_);
+    std::swap(stride3_, rhs.stride3_);
+    std::swap(data_, rhs.data_);
+    T**** table = pv_.load(std::memory_order_acquire);
+    pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+    rhs.pv_.store(table, std::memory_order_release);
+    std::swap(status_, rhs.status_);
+}
+
+template<typename T>
+inline void swap(Array4D<T> &a, Array4D<T> &b) noexcept
+{
+    a.Swap(b);
+}
+
+// Frees the pointer table used by operator[]; it is rebuilt on the next operator[].
+template<typename T>
+void Array4D<T>::ReleasePointerTable()
+{
+    T**** table = pv_.exchange(nullptr, std::memory_order_acq_rel);
+    if (table != nullptr) {
+        DeletePointerTable(table);
     }
 }
 
@@ -1374,43 +1669,20 @@ void Array4D<T>::AllocateArray()
 {
     if (status_ == ArrayStatus::empty) {
 
-        try {
+        stride3_ = n4_;
+        stride2_ = n3_ * stride3_;
+        stride1_ = n2_ * stride2_;
 
-            pv_          = new T***[n1_];
-            pv_[0]       = new T**[n1_*n2_];
-            pv_[0][0]    = new T*[n1_*n2_*n3_];
-            pv_[0][0][0] = new T[n1_*n2_*n3_*n4_];
-
-            for (int i = 0; i < n1_; ++i) {
-                pv_[i] = pv_[0] + i*n2_;
-                for (int j = 0; j < n2_; ++j) {
-                    pv_[i][j] = pv_[0][0] + i*n2_*n3_ + j*n3_;
-                    for (int k = 0; k < n3_; ++k) {
-                        pv_[i][j][k] = pv_[0][0][0] + i*n2_*n3_*n4_ + j*n3_*n4_ + k*n4_;
-                    }
-                }
-            }
+        try {
 
+            data_ = new T[Size()];
             status_ = ArrayStatus::allocated;
 
         } catch (const std::bad_alloc& e) {
 
-            std::cerr << "Array3D::AllocateArray : Memory allocation failed: " << e.what() << std::endl;
-
-            if (pv_[0][0][0] != nullptr) {
-                delete[] pv_[0][0][0];
-            }
-            if (pv_[0][0] != nullptr) {
-                delete[] pv_[0][0];
-            }
-            if (pv_[0] != nullptr) {
-                delete[] pv_[0];
-            }
-            if (pv_ != nullptr) {
-                delete[] pv_;
-            }
-            pv_ = nullptr;
+            std::cerr << "Array4D::AllocateArray : Memory allocation failed: " << e.what() << std::endl;
 
+            data_ = nullptr;
             status_ = ArrayStatus::empty;
         }
     }
@@ -1420,15 +1692,63 @@ template<typename T>
 void Array4D<T>::DeleteArray()
 {
     if (status_ == ArrayStatus::allocated) {
-        delete [] pv_[0][0][0];
-        delete [] pv_[0][0];
-        delete [] pv_[0];
-        delete [] pv_;
-        pv_ = nullptr;
+        ReleasePointerTable();
+        delete [] data_;
+        data_ = nullptr;
         status_ = ArrayStatus::empty;
     }
 }
 
+// Builds the operator[] pointer table over data_ on first use. Concurrent
+// callers may both build one; only the first is published, the other is freed.
+template<typename T>
+T**** Array4D<T>::PointerTable() const
+{
+    T**** table = pv_.load(std::memory_order_acquire);
+    if (table != nullptr || status_ == ArrayStatus::empty || Size() == 0) {
+        return table;
+    }
+
+    T*** *p1 = nullptr;
+    T** *p2 = nullptr;
+    T* *p3 = nullptr;
+    try {
+        p1 = new T***[n1_];
+        p2 = new T**[n1_ * n2_];
+        p3 = new T*[n1_ * n2_ * n3_];
+    } catch (const std::bad_alloc& e) {
+        std::cerr << "Array4D::PointerTable : Memory allocation failed: " << e.what() << std::endl;
+        delete [] p1;
+        delete [] p2;
+        delete [] p3;
+        std::abort();
+    }
+
+    for (std::size_t n = 0; n < n1_; ++n) {
+        p1[n] = p2 + n*n2_;
+    }
+    for (std::size_t n = 0; n < n1_ * n2_; ++n) {
+        p2[n] = p3 + n*n3_;
+    }
+    for (std::size_t n = 0; n < n1_ * n2_ * n3_; ++n) {
+        p3[n] = data_ + n*n4_;
+    }
+
+    if (!pv_.compare_exchange_strong(table, p1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        DeletePointerTable(p1);
+        return table;
+    }
+    return p1;
+}
+
+template<typename T>
+void Array4D<T>::DeletePointerTable(T**** table)
+{
+    delete [] table[0][0];
+    delete [] table[0];
+    delete [] table;
+}
+
 /*
 #############################################################
 class Array5D
@@ -1441,179 +1761,164 @@ class Array5D
 public:
     // constructor
     Array5D();
-    Array5D(const int n1, const int n2, const int n3, const int n4, const int n5);
-    Array5D(const int n1, const int n2, const int n3, const int n4, const int n5, const T &a);
-    Array5D(const int n1, const int n2, const int n3, const int n4, const int n5, const T *a);
+    Array5D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5);
+    Array5D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const T &a);
+    Array5D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const T *a);
     Array5D(const Array5D &rhs);
+    Array5D(Array5D &&rhs) noexcept;
 
     // destructor
     ~Array5D();
 
     // operator
     Array5D & operator=(const Array5D &rhs);
+    Array5D & operator=(Array5D &&rhs) noexcept;
     Array5D & operator=(const T &a);
 
-    inline T**** operator[](const int i);
-	inline const T* const * const * const * operator[](const int i) const;
+    // a(i, j, k, l, m) : flat index with precomputed strides
+    inline T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m);
+    inline const T& operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m) const;
 
-    // menmber function
-	inline int GetDim1() const { return n1_; }
-	inline int GetDim2() const { return n2_; }
-    inline int GetDim3() const { return n3_; }
-    inline int GetDim4() const { return n4_; }
-    inline int GetDim5() const { return n5_; }
+    // a[i][j][k][l][m] : through a pointer table built on first use
+    inline T**** operator[](const std::size_t i);
+    inline const T* const * const * const * operator[](const std::size_t i) const;
 
-	void Resize(const int n1, const int n2, const int n3, const int n4, const int n5); 
-	void Assign(const int n1, const int n2, const int n3, const int n4, const int n5, const T &a);
+    // menmber function
+    inline std::size_t GetDim1() const { return n1_; }
+    inline std::size_t GetDim2() const { return n2_; }
+    inline std::size_t GetDim3() const { return n3_; }
+    inline std::size_t GetDim4() const { return n4_; }
+    inline std::size_t GetDim5() const { return n5_; }
+    inline std::size_t Size() const { return n1_ * n2_ * n3_ * n4_ * n5_; }
+    inline T* Data() { return data_; }
+    inline const T* Data() const { return data_; }
+    inline bool HasPointerTable() const { return pv_.load(std::memory_order_acquire) != nullptr; }
+
+    void Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5);
+    void Assign(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const T &a);
+    void Swap(Array5D &rhs) noexcept;
+    void ReleasePointerTable();
 
 private:
-    int n1_;
-    int n2_;
-    int n3_;
-    int n4_;
-    int n5_;
-    T *****pv_;
+    std::size_t n1_;
+    std::size_t n2_;
+    std::size_t n3_;
+    std::size_t n4_;
+    std::size_t n5_;
+    std::size_t stride1_;
+    std::size_t stride2_;
+    std::size_t stride3_;
+    std::size_t stride4_;
+    T *data_;
+    mutable std::atomic<T*****> pv_;
     ArrayStatus status_;
 
     void AllocateArray();
     void DeleteArray();
-
+    T***** PointerTable() const;
+    static void DeletePointerTable(T***** table);
 };
 
 // constructor
 
 template<typename T>
-Array5D<T>::Array5D() : n1_(0), n2_(0), n3_(0), n4_(0), n5_(0), pv_(nullptr), status_(ArrayStatus::empty) { }
+Array5D<T>::Array5D() : n1_(0), n2_(0), n3_(0), n4_(0), n5_(0), stride1_(0), stride2_(0), stride3_(0), stride4_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty) { }
 
 template<typename T>
-Array5D<T>::Array5D(const int n1, const int n2, const int n3, const int n4, const int n5)
-    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), n5_(n5), pv_(nullptr), status_(ArrayStatus::empty)
+Array5D<T>::Array5D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5)
+    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), n5_(n5), stride1_(0), stride2_(0), stride3_(0), stride4_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array5D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array5D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array5D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array5D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array5D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array5D : n3 == 0" << std::endl;
     }
-    if (n4_ <= 0) {
-        std::cerr << "Array5D : n4 <= 0" << std::endl;
+    if (n4_ == 0) {
+        std::cerr << "Array5D : n4 == 0" << std::endl;
     }
-    if (n5_ <= 0) {
-        std::cerr << "Array5D : n5 <= 0" << std::endl;
+    if (n5_ == 0) {
+        std::cerr << "Array5D : n5 == 0" << std::endl;
     }
 #endif
     AllocateArray();
 }
 
 template<typename T>
-Array5D<T>::Array5D(const int n1, const int n2, const int n3, const int n4, const int n5, const T &a)
-    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), n5_(n5), pv_(nullptr), status_(ArrayStatus::empty)
+Array5D<T>::Array5D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const T &a)
+    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), n5_(n5), stride1_(0), stride2_(0), stride3_(0), stride4_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array5D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array5D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array5D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array5D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array5D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array5D : n3 == 0" << std::endl;
     }
-    if (n4_ <= 0) {
-        std::cerr << "Array5D : n4 <= 0" << std::endl;
+    if (n4_ == 0) {
+        std::cerr << "Array5D : n4 == 0" << std::endl;
     }
-    if (n5_ <= 0) {
-        std::cerr << "Array5D : n5 <= 0" << std::endl;
+    if (n5_ == 0) {
+        std::cerr << "Array5D : n5 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            for (int k = 0; k < n3; ++k) {
-                for (int l = 0; l < n4; ++l) {
-                    for (int m = 0; m < n5; ++m) {
-                        pv_[i][j][k][l][m] = a;
-                    }
-                }
-            }
-        }
-    }
+    std::fill(data_, data_ + Size(), a);
 }
 
-
 template<typename T>
-Array5D<T>::Array5D(const int n1, const int n2, const int n3, const int n4, const int n5, const T *a)
-    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), n5_(n5), pv_(nullptr), status_(ArrayStatus::empty)
+Array5D<T>::Array5D(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const T *a)
+    : n1_(n1), n2_(n2), n3_(n3), n4_(n4), n5_(n5), stride1_(0), stride2_(0), stride3_(0), stride4_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
 #ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array5D : n1 <= 0" << std::endl;
+    if (n1_ == 0) {
+        std::cerr << "Array5D : n1 == 0" << std::endl;
     }
-    if (n2_ <= 0) {
-        std::cerr << "Array5D : n2 <= 0" << std::endl;
+    if (n2_ == 0) {
+        std::cerr << "Array5D : n2 == 0" << std::endl;
     }
-    if (n3_ <= 0) {
-        std::cerr << "Array5D : n3 <= 0" << std::endl;
+    if (n3_ == 0) {
+        std::cerr << "Array5D : n3 == 0" << std::endl;
     }
-    if (n4_ <= 0) {
-        std::cerr << "Array5D : n4 <= 0" << std::endl;
+    if (n4_ == 0) {
+        std::cerr << "Array5D : n4 == 0" << std::endl;
     }
-    if (n5_ <= 0) {
-        std::cerr << "Array5D : n5 <= 0" << std::endl;
+    if (n5_ == 0) {
+        std::cerr << "Array5D : n5 == 0" << std::endl;
     }
 #endif
     AllocateArray();
-    for (int i = 0; i < n1; ++i) {
-        for (int j = 0; j < n2; ++j) {
-            for (int k = 0; k < n3; ++k) {
-                for (int l = 0; l < n4; ++l) {
-                    for (int m = 0; m < n5; ++m) {
-                        pv_[i][j][k][l][m] = *a++;
-                    }
-                }
-            }
-        }
-    }
+    std::copy(a, a + Size(), data_);
 }
 
-
 template<typename T>
 Array5D<T>::Array5D(const Array5D<T> &rhs)
-    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), n4_(rhs.n4_), n5_(rhs.n5_), pv_(nullptr), status_(ArrayStatus::empty)
+    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), n4_(rhs.n4_), n5_(rhs.n5_), stride1_(0), stride2_(0), stride3_(0), stride4_(0), data_(nullptr), pv_(nullptr), status_(ArrayStatus::empty)
 {
-#ifdef ENABLE_ARGUMENT_CHECK
-    if (n1_ <= 0) {
-        std::cerr << "Array5D : n1 <= 0" << std::endl;
-    }
-    if (n2_ <= 0) {
-        std::cerr << "Array5D : n2 <= 0" << std::endl;
-    }
-    if (n3_ <= 0) {
-        std::cerr << "Array5D : n3 <= 0" << std::endl;
-    }
-    if (n4_ <= 0) {
-        std::cerr << "Array5D : n4 <= 0" << std::endl;
-    }
-    if (n5_ <= 0) {
-        std::cerr << "Array5D : n5 <= 0" << std::endl;
-    }
-#endif
     AllocateArray();
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            for (int k = 0; k < n3_; ++k) {
-                for (int l = 0; l < n4_; ++l) {
-                    for (int m = 0; m < n5_; ++m) {
-                        pv_[i][j][k][l][m] = rhs[i][j][k][l][m];
-                    }
-                }
-            }
-        }
-    }
+    std::copy(rhs.data_, rhs.data_ + Size(), data_);
+}
+
+template<typename T>
+Array5D<T>::Array5D(Array5D<T> &&rhs) noexcept
+    : n1_(rhs.n1_), n2_(rhs.n2_), n3_(rhs.n3_), n4_(rhs.n4_), n5_(rhs.n5_), stride1_(rhs.stride1_), stride2_(rhs.stride2_), stride3_(rhs.stride3_), stride4_(rhs.stride4_),
+      data_(rhs.data_), pv_(rhs.pv_.load(std::memory_order_acquire)), status_(rhs.status_)
+{
+    rhs.n1_ = 0;
+    rhs.n2_ = 0;
+    rhs.n3_ = 0;
+    rhs.n4_ = 0;
+    rhs.n5_ = 0;
+    rhs.data_ = nullptr;
+    rhs.pv_.store(nullptr, std::memory_order_release);
+    rhs.status_ = ArrayStatus::empty;
 }
 
 // destructor
@@ -1640,85 +1945,103 @@ Array5D<T> & Array5D<T>::operator=(const Array5D &rhs)
             AllocateArray();
         }
 
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                for (int k = 0; k < n3_; ++k) {
-                    for (int l = 0; l < n4_; ++l) {
-                        for (int m = 0; m < n5_; ++m) {
-                            pv_[i][j][k][l][m] = rhs[i][j][k][l][m];
-                        }
-                    }
-                }
-            }
-        }
+        std::copy(rhs.data_, rhs.data_ + Size(), data_);
 
     }
 
     return *this;
 }
 
+template<typename T>
+Array5D<T> & Array5D<T>::operator=(Array5D<T> &&rhs) noexcept
+{
+    if (this != &rhs) {
+        DeleteArray();
+        n1_ = rhs.n1_;
+        n2_ = rhs.n2_;
+        n3_ = rhs.n3_;
+        n4_ = rhs.n4_;
+        n5_ = rhs.n5_;
+        stride1_ = rhs.stride1_;
+        stride2_ = rhs.stride2_;
+        stride3_ = rhs.stride3_;
+        stride4_ = rhs.stride4_;
+        data_   = rhs.data_;
+        pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+        status_ = rhs.status_;
+        rhs.n1_ = 0;
+        rhs.n2_ = 0;
+        rhs.n3_ = 0;
+        rhs.n4_ = 0;
+        rhs.n5_ = 0;
+        rhs.data_   = nullptr;
+        rhs.pv_.store(nullptr, std::memory_order_release);
+        rhs.status_ = ArrayStatus::empty;
+    }
+    return *this;
+}
 
 template<typename T>
 Array5D<T> & Array5D<T>::operator=(const T &a)
 {
     if (status_ == ArrayStatus::allocated) {
-
-        for (int i = 0; i < n1_; ++i) {
-            for (int j = 0; j < n2_; ++j) {
-                for (int k = 0; k < n3_; ++k) {
-                    for (int l = 0; l < n4_; ++l) {
-                        for (int m = 0; m < n5_; ++m) {
-                            pv_[i][j][k][l][m] = a;
-                        }
-                    }
-                }
-            }
-        }
-
+        std::fill(data_, data_ + Size(), a);
     }
-
     return *this;
 }
 
 template<typename T>
-inline T**** Array5D<T>::operator[](const int i)
+inline T& Array5D<T>::operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m)
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_ || j >= n2_ || k >= n3_ || l >= n4_ || m >= n5_) {
         std::cerr << "Array5D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return data_[i*stride1_ + j*stride2_ + k*stride3_ + l*stride4_ + m];
 }
 
-// template<typename T>
-// inline T** Array4D<T>::operator[](const int i)
-// {
-// #ifdef CHECK_BOUNDS_
-//     if (i < 0 || i >= n1_) {
-//         throw("Array2D subscript out of bounds");
-//     }
-// #endif
-//     return pv_[i];
-// }
+template<typename T>
+inline const T& Array5D<T>::operator()(const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t l, const std::size_t m) const
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_ || j >= n2_ || k >= n3_ || l >= n4_ || m >= n5_) {
+        std::cerr << "Array5D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return data_[i*stride1_ + j*stride2_ + k*stride3_ + l*stride4_ + m];
+}
 
 template<typename T>
-inline const T* const * const * const * Array5D<T>::operator[](const int i) const
+inline T**** Array5D<T>::operator[](const std::size_t i)
 {
 #ifdef ENABLE_INDEX_RANGE_CHECK
-    if (i < 0 || i >= n1_) {
+    if (i >= n1_) {
         std::cerr << "Array5D : out of index range" << std::endl;
         std::abort();
     }
 #endif
-    return pv_[i];
+    return PointerTable()[i];
+}
+
+template<typename T>
+inline const T* const * const * const * Array5D<T>::operator[](const std::size_t i) const
+{
+#ifdef ENABLE_INDEX_RANGE_CHECK
+    if (i >= n1_) {
+        std::cerr << "Array5D : out of index range" << std::endl;
+        std::abort();
+    }
+#endif
+    return PointerTable()[i];
 }
 
 // member function
 
 template<typename T>
-void Array5D<T>::Resize(const int n1, const int n2, const int n3, const int n4, const int n5)
+void Array5D<T>::Resize(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5)
 {
     if (n1 != n1_ || n2 != n2_ || n3 != n3_ || n4 != n4_ || n5 != n5_) {
         DeleteArray();
@@ -1732,7 +2055,7 @@ void Array5D<T>::Resize(const int n1, const int n2, const int n3, const int n4,
 }
 
 template<typename T>
-void Array5D<T>::Assign(const int n1, const int n2, const int n3, const int n4, const int n5, const T &a)
+void Array5D<T>::Assign(const std::size_t n1, const std::size_t n2, const std::size_t n3, const std::size_t n4, const std::size_t n5, const T &a)
 {
     if (n1 != n1_ || n2 != n2_ || n3 != n3_ || n4 != n4_ || n5 != n5_) {
         DeleteArray();
@@ -1743,19 +2066,42 @@ void Array5D<T>::Assign(const int n1, const int n2, const int n3, const int n4,
         n5_ = n5;
         AllocateArray();
     }
+    std::fill(data_, data_ + Size(), a);
+}
 
-    for (int i = 0; i < n1_; ++i) {
-        for (int j = 0; j < n2_; ++j) {
-            for (int k = 0; k < n3_; ++k) {
-                for (int l = 0; l < n4_; ++l) {
-                    for (int m = 0; m < n5_; ++m) {
-                        pv_[i][j][k][l][m] = a;
-                    }
-                }
-            }
-        }
+template<typename T>
+void Array5D<T>::Swap(Array5D<T> &rhs) noexcept
+{
+    std::swap(n1_, rhs.n1_);
+    std::swap(n2_, rhs.n2_);
+    std::swap(n3_, rhs.n3_);
+    std::swap(n4_, rhs.n4_);
+    std::swap(n5_, rhs.n5_);
+    std::swap(stride1_, rhs.stride1_);
+    std::swap(stride2_, rhs.stride2_);
+    std::swap(stride3_, rhs.stride3_);
+    std::swap(stride4_, rhs.stride4_);
+    std::swap(data_, rhs.data_);
+    T***** table = pv_.load(std::memory_order_acquire);
+    pv_.store(rhs.pv_.load(std::memory_order_acquire), std::memory_order_release);
+    rhs.pv_.store(table, std::memory_order_release);
+    std::swap(status_, rhs.status_);
+}
+
+template<typename T>
+inline void swap(Array5D<T> &a, Array5D<T> &b) noexcept
+{
+    a.Swap(b);
+}
+
+// Frees the pointer table used by operator[]; it is rebuilt on the next operator[].
+template<typename T>
+void Array5D<T>::ReleasePointerTable()
+{
+    T***** table = pv_.exchange(nullptr, std::memory_order_acq_rel);
+    if (table != nullptr) {
+        DeletePointerTable(table);
     }
-    
 }
 
 template<typename T>
@@ -1763,50 +2109,21 @@ void Array5D<T>::AllocateArray()
 {
     if (status_ == ArrayStatus::empty) {
 
+        stride4_ = n5_;
+        stride3_ = n4_ * stride4_;
+        stride2_ = n3_ * stride3_;
+        stride1_ = n2_ * stride2_;
+
         try {
 
-            pv_ = new T****[n1_];
-            pv_[0] = new T***[n1_*n2_];
-            pv_[0][0] = new T**[n1_*n2_*n3_];
-            pv_[0][0][0] = new T*[n1_*n2_*n3_*n4_];
-            pv_[0][0][0][0] = new T[n1_*n2_*n3_*n4_*n5_];
-
-            for (int i = 0; i < n1_; ++i) {
-                pv_[i] = pv_[0] + i*n2_;
-                for (int j = 0; j < n2_; ++j) {
-                    pv_[i][j] = pv_[0][0] + i*n2_*n3_ + j*n3_;
-                    for (int k = 0; k < n3_; ++k) {
-                        pv_[i][j][k] = pv_[0][0][0] + i*n2_*n3_*n4_ + j*n3_*n4_ + k*n4_;
-                        for (int l = 0; l < n4_; ++l) {
-                            pv_[i][j][k][l] = pv_[0][0][0][0] + i*n2_*n3_*n4_*n5_ + j*n3_*n4_*n5_ + k*n4_*n5_ + l*n5_;
-                        }
-                    }
-                }
-            }
-    
+            data_ = new T[Size()];
             status_ = ArrayStatus::allocated;
 
         } catch (const std::bad_alloc& e) {
 
             std::cerr << "Array5D::AllocateArray : Memory allocation failed: " << e.what() << std::endl;
 
-            if (pv_[0][0][0][0] != nullptr) {
-                delete[] pv_[0][0][0][0];
-            }
-            if (pv_[0][0][0] != nullptr) {
-                delete[] pv_[0][0][0];
-            }
-            if (pv_[0][0] != nullptr) {
-                delete[] pv_[0][0];
-            }
-            if (pv_[0] != nullptr) {
-                delete[] pv_[0];
-            }
-            if (pv_ != nullptr) {
-                delete[] pv_;
-            }
-            pv_ = nullptr;
-
+            data_ = nullptr;
             status_ = ArrayStatus::empty;
         }
     }
@@ -1816,16 +2133,69 @@ template<typename T>
 void Array5D<T>::DeleteArray()
 {
     if (status_ == ArrayStatus::allocated) {
-        delete [] pv_[0][0][0][0];
-        delete [] pv_[0][0][0];
-        delete [] pv_[0][0];
-        delete [] pv_[0];
-        delete [] pv_;
-        pv_ = nullptr;
+        ReleasePointerTable();
+        delete [] data_;
+        data_ = nullptr;
         status_ = ArrayStatus::empty;
     }
 }
 
+// Builds the operator[] pointer table over data_ on first use. Concurrent
+// callers may both build one; only the first is published, the other is freed.
+template<typename T>
+T***** Array5D<T>::PointerTable() const
+{
+    T***** table = pv_.load(std::memory_order_acquire);
+    if (table != nullptr || status_ == ArrayStatus::empty || Size() == 0) {
+        return table;
+    }
+
+    T**** *p1 = nullptr;
+    T*** *p2 = nullptr;
+    T** *p3 = nullptr;
+    T* *p4 = nullptr;
+    try {
+        p1 = new T****[n1_];
+        p2 = new T***[n1_ * n2_];
+        p3 = new T**[n1_ * n2_ * n3_];
+        p4 = new T*[n1_ * n2_ * n3_ * n4_];
+    } catch (const std::bad_alloc& e) {
+        std::cerr << "Array5D::PointerTable : Memory allocation failed: " << e.what() << std::endl;
+        delete [] p1;
+        delete [] p2;
+        delete [] p3;
+        delete [] p4;
+        std::abort();
+    }
+
+    for (std::size_t n = 0; n < n1_; ++n) {
+        p1[n] = p2 + n*n2_;
+    }
+    for (std::size_t n = 0; n < n1_ * n2_; ++n) {
+        p2[n] = p3 + n*n3_;
+    }
+    for (std::size_t n = 0; n < n1_ * n2_ * n3_; ++n) {
+        p3[n] = p4 + n*n4_;
+    }
+    for (std::size_t n = 0; n < n1_ * n2_ * n3_ * n4_; ++n) {
+        p4[n] = data_ + n*n5_;
+    }
+
+    if (!pv_.compare_exchange_strong(table, p1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        DeletePointerTable(p1);
+        return table;
+    }
+    return p1;
+}
+
+template<typename T>
+void Array5D<T>::DeletePointerTable(T***** table)
+{
+    delete [] table[0][0][0];
+    delete [] table[0][0];
+    delete [] table[0];
+    delete [] table;
+}
 
 /*
 #############################################################
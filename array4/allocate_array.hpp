@@ -109,7 +109,7 @@ namespace array
         a[0]          = new T***[n1*n2];
         a[0][0]       = new T**[n1*n2*n3];
         a[0][0][0]    = new T*[n1*n2*n3*n4];
-        a[0][0][0][0] = new T[n1*n2*n3*n4];
+        a[0][0][0][0] = new T[n1*n2*n3*n4*n5];
         for (int i = 0; i < n1; ++i) {
             a[i] = a[0] + i*n2;
             for (int j = 0; j < n2; ++j) {
@@ -125,6 +125,181 @@ namespace array
         return a;
     }
 
+    template <typename T>
+    void Delete5dArray(T *****a)
+    {
+        delete [] a[0][0][0][0];
+        delete [] a[0][0][0];
+        delete [] a[0][0];
+        delete [] a[0];
+        delete [] a;
+    }
+
+    /* Flat N-D array */
+    /*
+        One contiguous block indexed as a(i, j, k) with precomputed strides,
+        so an access costs one load instead of a chain of pointer loads and
+        no pointer table is allocated. Code that needs a[i][j][k] can build
+        a table over the same block with Make2dPointerTable..Make5dPointerTable.
+    */
+    template <typename T, int N>
+    struct FlatArray
+    {
+        T   *data;
+        int  n[N];
+        long stride[N];  /* stride[N-1] == 1; long so blocks may exceed 2^31 elements */
+
+        template <typename... Index>
+        inline T& operator()(const Index... index) const
+        {
+            static_assert(sizeof...(Index) == N, "FlatArray: wrong number of indices");
+            const long idx[N] = {static_cast<long>(index)...};
+            long offset = idx[N-1];
+            for (int d = 0; d < N-1; ++d) {
+                offset += idx[d] * stride[d];
+            }
+            return data[offset];
+        }
+
+        inline long Size() const
+        {
+            long size = 1;
+            for (int d = 0; d < N; ++d) {
+                size *= n[d];
+            }
+            return size;
+        }
+    };
+
+    template <typename T>
+    using Flat2dArray = FlatArray<T, 2>;
+    template <typename T>
+    using Flat3dArray = FlatArray<T, 3>;
+    template <typename T>
+    using Flat4dArray = FlatArray<T, 4>;
+    template <typename T>
+    using Flat5dArray = FlatArray<T, 5>;
+
+    template <typename T, typename... Dims>
+    FlatArray<T, sizeof...(Dims)> AllocateFlatArray(const Dims... dims)
+    {
+        constexpr int N = sizeof...(Dims);
+        FlatArray<T, N> a;
+        const int n[N] = {static_cast<int>(dims)...};
+        for (int d = 0; d < N; ++d) {
+            a.n[d] = n[d];
+        }
+        a.stride[N-1] = 1;
+        for (int d = N-2; d >= 0; --d) {
+            a.stride[d] = a.stride[d+1] * static_cast<long>(a.n[d+1]);
+        }
+        a.data = new T[a.Size()];
+        return a;
+    }
+
+    template <typename T, int N>
+    void DeleteFlatArray(FlatArray<T, N> &a)
+    {
+        delete[] a.data;
+        a.data = nullptr;
+    }
+
+    /* Pointer tables over a FlatArray (free with the matching Delete*PointerTable) */
+    template <typename T>
+    T** Make2dPointerTable(const FlatArray<T, 2> &a)
+    {
+        T **p = new T*[a.n[0]];
+        for (int i = 0; i < a.n[0]; ++i) {
+            p[i] = a.data + static_cast<long>(i)*a.stride[0];
+        }
+        return p;
+    }
+
+    template <typename T>
+    void Delete2dPointerTable(T **p)
+    {
+        delete[] p;
+    }
+
+    template <typename T>
+    T*** Make3dPointerTable(const FlatArray<T, 3> &a)
+    {
+        T ***p = new T**[a.n[0]];
+        p[0]   = new T*[a.n[0]*a.n[1]];
+        for (int i = 0; i < a.n[0]; ++i) {
+            p[i] = p[0] + i*a.n[1];
+            for (int j = 0; j < a.n[1]; ++j) {
+                p[i][j] = a.data + static_cast<long>(i)*a.stride[0] + static_cast<long>(j)*a.stride[1];
+            }
+        }
+        return p;
+    }
+
+    template <typename T>
+    void Delete3dPointerTable(T ***p)
+    {
+        delete[] p[0];
+        delete[] p;
+    }
+
+    template <typename T>
+    T**** Make4dPointerTable(const FlatArray<T, 4> &a)
+    {
+        T ****p = new T***[a.n[0]];
+        p[0]    = new T**[a.n[0]*a.n[1]];
+        p[0][0] = new T*[a.n[0]*a.n[1]*a.n[2]];
+        for (int i = 0; i < a.n[0]; ++i) {
+            p[i] = p[0] + i*a.n[1];
+            for (int j = 0; j < a.n[1]; ++j) {
+                p[i][j] = p[0][0] + (i*a.n[1] + j)*a.n[2];
+                for (int k = 0; k < a.n[2]; ++k) {
+                    p[i][j][k] = a.data + static_cast<long>(i)*a.stride[0] + static_cast<long>(j)*a.stride[1] + static_cast<long>(k)*a.stride[2];
+                }
+            }
+        }
+        return p;
+    }
+
+    template <typename T>
+    void Delete4dPointerTable(T ****p)
+    {
+        delete[] p[0][0];
+        delete[] p[0];
+        delete[] p;
+    }
+
+    template <typename T>
+    T***** Make5dPointerTable(const FlatArray<T, 5> &a)
+    {
+        T *****p   = new T****[a.n[0]];
+        p[0]       = new T***[a.n[0]*a.n[1]];
+        p[0][0]    = new T**[a.n[0]*a.n[1]*a.n[2]];
+        p[0][0][0] = new T*[a.n[0]*a.n[1]*a.n[2]*a.n[3]];
+        for (int i = 0; i < a.n[0]; ++i) {
+            p[i] = p[0] + i*a.n[1];
+            for (int j = 0; j < a.n[1]; ++j) {
+                p[i][j] = p[0][0] + (i*a.n[1] + j)*a.n[2];
+                for (int k = 0; k < a.n[2]; ++k) {
+                    p[i][j][k] = p[0][0][0] + ((i*a.n[1] + j)*a.n[2] + k)*a.n[3];
+                    for (int l = 0; l < a.n[3]; ++l) {
+                        p[i][j][k][l] = a.data + static_cast<long>(i)*a.stride[0] + static_cast<long>(j)*a.stride[1]
+                                      + static_cast<long>(k)*a.stride[2] + static_cast<long>(l)*a.stride[3];
+                    }
+                }
+            }
+        }
+        return p;
+    }
+
+    template <typename T>
+    void Delete5dPointerTable(T *****p)
+    {
+        delete[] p[0][0][0];
+        delete[] p[0][0];
+        delete[] p[0];
+        delete[] p;
+    }
+
 } 
 
 
@@ -0,0 +1,131 @@
+// array1: ArrayBase-derived Array1D..Array6D (aligned allocator, thread pool).
+//     g++ -std=c++17 -O3 -march=native -pthread -I../array1 bench_array1.cpp -o bench_array1
+// Threads: ARRAY_NUM_THREADS=<n>.
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "array.hpp"
+#include "harness.hpp"
+
+namespace {
+
+    template <std::size_t Rank> struct ArrayOf;
+    template <> struct ArrayOf<1> { using type = array::Array1D<double>; };
+    template <> struct ArrayOf<2> { using type = array::Array2D<double>; };
+    template <> struct ArrayOf<3> { using type = array::Array3D<double>; };
+    template <> struct ArrayOf<4> { using type = array::Array4D<double>; };
+    template <> struct ArrayOf<5> { using type = array::Array5D<double>; };
+    template <> struct ArrayOf<6> { using type = array::Array6D<double>; };
+
+    template <std::size_t Rank>
+    struct Traits {
+        using type = typename ArrayOf<Rank>::type;
+
+        static type Make(const std::array<std::size_t, Rank>& shape) {
+            return std::apply([](const auto... n) { return type(n...); }, shape);
+        }
+
+        static void Fill(type& a, const double value) { a.Fill(value); }
+        static void Copy(type& dst, const type& src) { dst.Copy(src); }
+        static double Sum(const type& a) { return array::Sum(a); }
+
+        template <typename... Indices>
+        static double& At(type& a, const Indices... index) { return a(index...); }
+
+        template <typename... Indices>
+        static const double& At(const type& a, const Indices... index) { return a(index...); }
+    };
+
+    // ParallelFor variant of the row-major write, to compare with the plain loop.
+    template <std::size_t Rank>
+    void RunParallelFor(bench::Harness& harness) {
+        const std::array<std::size_t, Rank> shape = bench::CubeShape<Rank>(harness.GetOptions().size);
+        const std::size_t n = bench::Product(shape);
+        auto a = Traits<Rank>::Make(shape);
+        harness.Run("write_parallel_for", Rank, n, static_cast<double>(n * sizeof(double)), 0.0, [&] {
+            array::ForEachIndex(a, [&](const auto... index) { a(index...) = 2.0; });
+            bench::DoNotOptimize(a);
+        });
+
+        // Same (2*Rank+1)-point stencil as the "stencil" case, through the stencil engine.
+        auto b = Traits<Rank>::Make(shape);
+        const auto laplacian = array::Stencil<double, Rank>::Laplacian();
+        harness.Run("apply_stencil", Rank, n, 2.0 * static_cast<double>(n * sizeof(double)), static_cast<double>(n) * (2.0 * Rank + 1.0), [&] {
+            array::ApplyStencil(laplacian, a, b, 1);
+            bench::DoNotOptimize(b);
+        });
+        if constexpr (Rank == 2 || Rank == 3) {
+            // Four explicit diffusion steps per rep, fused by temporal blocking.
+            auto diffusion = array::Stencil<double, Rank>::Laplacian(0.1);
+            diffusion.Add({}, 1.0);
+            auto u = Traits<Rank>::Make(shape);
+            u.Fill(1.0);
+            harness.Run("iterate_stencil_tb4", Rank, n, 2.0 * static_cast<double>(n * sizeof(double)), 4.0 * static_cast<double>(n) * (2.0 * Rank + 2.0), [&] {
+                array::IterateStencil(diffusion, u, b, 1, 4, 4);
+                bench::DoNotOptimize(u);
+            });
+        }
+        if constexpr (Rank == 3) {
+            // Halo exchange of a domain of the same extents with two ghost
+            // layers: pack all 26 faces, edges and corners, then unpack them.
+            using Halo = array::HaloArray<double, Rank>;
+            Halo h(shape, 2, 1.0);
+            std::vector<std::vector<double>> buffers;
+            Halo::ForEachDirection([&](const typename Halo::Direction& d) { buffers.emplace_back(h.PackSize(d)); });
+            std::size_t halo = 0;
+            for (const auto& buffer : buffers) halo += buffer.size();
+            harness.Run("halo_pack_unpack", Rank, halo, 4.0 * static_cast<double>(halo * sizeof(double)), 0.0, [&] {
+                std::size_t k = 0;
+                Halo::ForEachDirection([&](const typename Halo::Direction& d) { h.Pack(d, buffers[k++].data()); });
+                k = 0;
+                Halo::ForEachDirection([&](const typename Halo::Direction& d) { h.Unpack(Halo::Opposite(d), buffers[k++].data()); });
+                bench::DoNotOptimize(h);
+            });
+        }
+
+        if constexpr (Rank >= 2) {
+            typename Traits<Rank>::type::template rebind_layout<array::ColumnMajor> f;
+            harness.Run("to_column_major", Rank, n, 2.0 * static_cast<double>(n * sizeof(double)), 0.0, [&] {
+                array::ConvertLayout(a, f);
+                bench::DoNotOptimize(f);
+            });
+            if constexpr (Rank == 2) {
+                decltype(a) t;
+                harness.Run("transpose", Rank, n, 2.0 * static_cast<double>(n * sizeof(double)), 0.0, [&] {
+                    array::Transpose(a, t);
+                    bench::DoNotOptimize(t);
+                });
+
+                // Same column sweep as "sum_column_major", with the rows padded
+                // so that power-of-two extents do not alias in the cache.
+                const decltype(a) p(shape[0], shape[1], array::Padding::Auto(), 1.0);
+                harness.Run("sum_column_major_padded", Rank, n, static_cast<double>(n * sizeof(double)), static_cast<double>(n), [&] {
+                    double sum = 0.0;
+                    bench::ForColumnMajor(shape, [&](const auto... index) { sum += p(index...); });
+                    bench::DoNotOptimize(sum);
+                });
+
+                // Square GEMM on the same matrices: 2 n^3 flops, three matrices of traffic at best.
+                const double side = static_cast<double>(shape[0]);
+                decltype(a) b = a, c;
+                harness.Run("matmul", Rank, n, 3.0 * static_cast<double>(n * sizeof(double)), 2.0 * side * side * side, [&] {
+                    array::MatMul(a, b, c);
+                    bench::DoNotOptimize(c);
+                });
+            }
+        }
+    }
+
+    template <std::size_t... Ranks>
+    void RunAll(bench::Harness& harness, std::index_sequence<Ranks...>) {
+        ((bench::RunStandardCases<Traits, Ranks + 1>(harness), RunParallelFor<Ranks + 1>(harness)), ...);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Harness harness("array1", bench::ParseOptions(argc, argv));
+    RunAll(harness, std::make_index_sequence<6>{});
+    return 0;
+}
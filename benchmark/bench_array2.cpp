@@ -0,0 +1,64 @@
+// array2: Array<T, Rank> with compile-time rank (OpenMP bulk operations).
+//     g++ -std=c++17 -O3 -march=native -fopenmp -I../array2 bench_array2.cpp -o bench_array2
+// Threads: OMP_NUM_THREADS=<n>.
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+
+#include "array.hpp"
+#include "harness.hpp"
+
+namespace {
+
+    template <std::size_t Rank>
+    struct Traits {
+        using type = array::Array<double, Rank>;
+
+        static type Make(const std::array<std::size_t, Rank>& shape) {
+            return std::apply([](const auto... n) { return type(static_cast<types::Size>(n)...); }, shape);
+        }
+
+        static void Fill(type& a, const double value) { a.Fill(value); }
+        static void Copy(type& dst, const type& src) { dst = src; }
+
+        template <typename... Indices>
+        static double& At(type& a, const Indices... index) { return a(index...); }
+
+        template <typename... Indices>
+        static const double& At(const type& a, const Indices... index) { return a(index...); }
+    };
+
+    template <std::size_t Rank>
+    void RunConvertLayout(bench::Harness& harness) {
+        if constexpr (Rank >= 2) {
+            const std::array<std::size_t, Rank> shape = bench::CubeShape<Rank>(harness.GetOptions().size);
+            const std::size_t n = bench::Product(shape);
+            auto a = Traits<Rank>::Make(shape);
+            a.Fill(1.0);
+            array::Array<double, Rank, array::ColumnMajor> f;
+            harness.Run("to_column_major", Rank, n, 2.0 * static_cast<double>(n * sizeof(double)), 0.0, [&] {
+                array::ConvertLayout(a, f);
+                bench::DoNotOptimize(f);
+            });
+            if constexpr (Rank == 2) {
+                decltype(a) t;
+                harness.Run("transpose", Rank, n, 2.0 * static_cast<double>(n * sizeof(double)), 0.0, [&] {
+                    array::Transpose(a, t);
+                    bench::DoNotOptimize(t);
+                });
+            }
+        }
+    }
+
+    template <std::size_t... Ranks>
+    void RunAll(bench::Harness& harness, std::index_sequence<Ranks...>) {
+        ((bench::RunStandardCases<Traits, Ranks + 1>(harness), RunConvertLayout<Ranks + 1>(harness)), ...);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Harness harness("array2", bench::ParseOptions(argc, argv));
+    RunAll(harness, std::make_index_sequence<6>{});
+    return 0;
+}
@@ -0,0 +1,78 @@
+// array3: Array1D..Array5D (flat storage, lazy operator[] pointer table).
+//     g++ -std=c++17 -O3 -march=native -I../array3 bench_array3.cpp -o bench_array3
+// array.hpp defines ENABLE_INDEX_RANGE_CHECK, so operator() is range checked.
+
+#include <array>
+#include <cstddef>
+
+#include "array.hpp"
+#include "harness.hpp"
+
+namespace {
+
+    template <std::size_t Rank> struct ArrayOf;
+    template <> struct ArrayOf<1> { using type = array::Array1D<double>; };
+    template <> struct ArrayOf<2> { using type = array::Array2D<double>; };
+    template <> struct ArrayOf<3> { using type = array::Array3D<double>; };
+    template <> struct ArrayOf<4> { using type = array::Array4D<double>; };
+    template <> struct ArrayOf<5> { using type = array::Array5D<double>; };
+
+    template <typename P>
+    inline decltype(auto) Subscript(P&& p) { return std::forward<P>(p); }
+
+    template <typename P, typename... Indices>
+    inline decltype(auto) Subscript(P&& p, const std::size_t i, const Indices... rest) {
+        return Subscript(p[i], rest...);
+    }
+
+    // Array1D has only operator[]; the higher ranks use the flat operator().
+    template <typename A, typename... Indices>
+    inline decltype(auto) Element(A& a, const Indices... index) {
+        if constexpr (sizeof...(Indices) == 1) {
+            return Subscript(a, index...);
+        } else {
+            return a(index...);
+        }
+    }
+
+    template <std::size_t Rank>
+    struct Traits {
+        using type = typename ArrayOf<Rank>::type;
+
+        static type Make(const std::array<std::size_t, Rank>& shape) {
+            return std::apply([](const auto... n) { return type(n...); }, shape);
+        }
+
+        static void Fill(type& a, const double value) { a = value; }
+        static void Copy(type& dst, const type& src) { dst = src; }
+
+        template <typename... Indices>
+        static double& At(type& a, const Indices... index) { return Element(a, index...); }
+
+        template <typename... Indices>
+        static const double& At(const type& a, const Indices... index) { return Element(a, index...); }
+    };
+
+    // Legacy a[i][j]... access through the pointer table.
+    template <std::size_t Rank>
+    void RunSubscript(bench::Harness& harness) {
+        const std::array<std::size_t, Rank> shape = bench::CubeShape<Rank>(harness.GetOptions().size);
+        const std::size_t n = bench::Product(shape);
+        auto a = Traits<Rank>::Make(shape);
+        harness.Run("write_row_major_subscript", Rank, n, static_cast<double>(n * sizeof(double)), 0.0, [&] {
+            bench::ForRowMajor(shape, [&](const auto... index) { Subscript(a, index...) = 2.0; });
+            bench::DoNotOptimize(a);
+        });
+    }
+
+    template <std::size_t... Ranks>
+    void RunAll(bench::Harness& harness, std::index_sequence<Ranks...>) {
+        ((bench::RunStandardCases<Traits, Ranks + 1>(harness), RunSubscript<Ranks + 1>(harness)), ...);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Harness harness("array3", bench::ParseOptions(argc, argv));
+    RunAll(harness, std::make_index_sequence<5>{});
+    return 0;
+}
@@ -0,0 +1,85 @@
+// array4: raw pointer tables from AllocateNdArray (ranks 1-5).
+//     g++ -std=c++17 -O3 -march=native -I../array4 bench_array4.cpp -o bench_array4
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "allocate_array.hpp"
+#include "harness.hpp"
+
+namespace {
+
+    template <std::size_t Rank> struct PointerOf { using type = typename PointerOf<Rank - 1>::type*; };
+    template <> struct PointerOf<0> { using type = double; };
+
+    // Owns one AllocateNdArray result so that the harness can scope it.
+    template <std::size_t Rank>
+    struct Table {
+        using pointer = typename PointerOf<Rank>::type;
+
+        pointer p;
+        std::size_t size;
+
+        explicit Table(const std::array<std::size_t, Rank>& shape) : p(Allocate(shape)), size(bench::Product(shape)) { }
+        Table(const Table&) = delete;
+        Table& operator=(const Table&) = delete;
+        ~Table() { Delete(p); }
+
+        double* Data() const {
+            if constexpr (Rank == 1) return p;
+            else if constexpr (Rank == 2) return p[0];
+            else if constexpr (Rank == 3) return p[0][0];
+            else if constexpr (Rank == 4) return p[0][0][0];
+            else return p[0][0][0][0];
+        }
+
+        static pointer Allocate(const std::array<std::size_t, Rank>& s) {
+            if constexpr (Rank == 1) return array::Allocate1dArray<double>(static_cast<int>(s[0]));
+            else if constexpr (Rank == 2) return array::Allocate2dArray<double>(static_cast<int>(s[0]), static_cast<int>(s[1]));
+            else if constexpr (Rank == 3) return array::Allocate3dArray<double>(static_cast<int>(s[0]), static_cast<int>(s[1]), static_cast<int>(s[2]));
+            else if constexpr (Rank == 4) return array::Allocate4dArray<double>(static_cast<int>(s[0]), static_cast<int>(s[1]), static_cast<int>(s[2]), static_cast<int>(s[3]));
+            else return array::Allocate5dArray<double>(static_cast<int>(s[0]), static_cast<int>(s[1]), static_cast<int>(s[2]), static_cast<int>(s[3]), static_cast<int>(s[4]));
+        }
+
+        static void Delete(pointer p) {
+            if constexpr (Rank == 1) array::Delete1dArray(p);
+            else if constexpr (Rank == 2) array::Delete2dArray(p);
+            else if constexpr (Rank == 3) array::Delete3dArray(p);
+            else if constexpr (Rank == 4) array::Delete4dArray(p);
+            else array::Delete5dArray(p);
+        }
+    };
+
+    template <typename P>
+    inline P& Subscript(P& p) { return p; }
+
+    template <typename P, typename... Indices>
+    inline decltype(auto) Subscript(P* p, const std::size_t i, const Indices... rest) {
+        return Subscript(p[i], rest...);
+    }
+
+    template <std::size_t Rank>
+    struct Traits {
+        using type = Table<Rank>;
+
+        static type Make(const std::array<std::size_t, Rank>& shape) { return type(shape); }
+
+        static void Fill(type& a, const double value) { std::fill(a.Data(), a.Data() + a.size, value); }
+        static void Copy(type& dst, const type& src) { std::copy(src.Data(), src.Data() + src.size, dst.Data()); }
+
+        template <typename... Indices>
+        static double& At(const type& a, const Indices... index) { return Subscript(a.p, index...); }
+    };
+
+    template <std::size_t... Ranks>
+    void RunAll(bench::Harness& harness, std::index_sequence<Ranks...>) {
+        (bench::RunStandardCases<Traits, Ranks + 1>(harness), ...);
+    }
+}
+
+int main(int argc, char** argv) {
+    bench::Harness harness("array4", bench::ParseOptions(argc, argv));
+    RunAll(harness, std::make_index_sequence<5>{});
+    return 0;
+}
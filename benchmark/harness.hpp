@@ -0,0 +1,290 @@
+#ifndef BENCHMARK_HARNESS_HPP_
+#define BENCHMARK_HARNESS_HPP_
+
+/*
+    Common harness for the per-implementation benchmarks
+    (bench_array1.cpp .. bench_array4.cpp). Each driver is built on its own,
+    because the four libraries share namespace and class names, e.g.
+
+        g++ -std=c++17 -O3 -march=native -pthread -I../array1 bench_array1.cpp -o bench_array1
+        ./bench_array1 --size 4194304 --reps 15 --warmup 3 --format json --filter fill
+
+    Every case is run `warmup` times untimed, then `reps` times timed with
+    std::chrono::steady_clock. One line per case is printed as CSV (default)
+    or JSON lines, with min/median/p90/max in milliseconds and bandwidth
+    (GB/s) and arithmetic rate (GFLOP/s) derived from the median.
+*/
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+    struct Options {
+        std::size_t size = std::size_t(1) << 22;  // target element count per array
+        int reps = 11;
+        int warmup = 2;
+        bool json = false;
+        std::string filter;                       // run only cases whose name contains this
+    };
+
+    inline Options ParseOptions(const int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const char* arg = argv[i];
+            const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+            if (std::strcmp(arg, "--size") == 0 && value) {
+                options.size = std::strtoull(value, nullptr, 10); ++i;
+            } else if (std::strcmp(arg, "--reps") == 0 && value) {
+                options.reps = std::max(1, std::atoi(value)); ++i;
+            } else if (std::strcmp(arg, "--warmup") == 0 && value) {
+                options.warmup = std::max(0, std::atoi(value)); ++i;
+            } else if (std::strcmp(arg, "--format") == 0 && value) {
+                options.json = std::strcmp(value, "json") == 0; ++i;
+            } else if (std::strcmp(arg, "--filter") == 0 && value) {
+                options.filter = value; ++i;
+            } else {
+                std::fprintf(stderr, "usage: %s [--size N] [--reps N] [--warmup N] [--format csv|json] [--filter NAME]\n", argv[0]);
+                std::exit(1);
+            }
+        }
+        return options;
+    }
+
+    // Extents of a rank-R array with about `size` elements (equal sides).
+    template <std::size_t Rank>
+    inline std::array<std::size_t, Rank> CubeShape(const std::size_t size) {
+        std::array<std::size_t, Rank> shape;
+        const double side = std::pow(static_cast<double>(size), 1.0 / static_cast<double>(Rank));
+        shape.fill(std::max<std::size_t>(4, static_cast<std::size_t>(side + 0.5)));
+        return shape;
+    }
+
+    template <std::size_t Rank>
+    inline std::size_t Product(const std::array<std::size_t, Rank>& shape) {
+        std::size_t n = 1;
+        for (std::size_t dim : shape) n *= dim;
+        return n;
+    }
+
+    // Keeps the optimizer from discarding a computed value.
+    template <typename T>
+    inline void DoNotOptimize(const T& value) {
+    #if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+    #else
+        static volatile T sink;
+        sink = value;
+    #endif
+    }
+
+    // #######################
+    // Loop orders
+    // #######################
+
+    // Last index innermost (row-major traversal).
+    template <std::size_t Axis, std::size_t Rank, typename F, typename... Indices>
+    inline void RowMajorLoop(const std::array<std::size_t, Rank>& begin, const std::array<std::size_t, Rank>& end, F& f, const Indices... outer) {
+        if constexpr (Axis == Rank) {
+            f(outer...);
+        } else {
+            for (std::size_t i = begin[Axis]; i < end[Axis]; ++i) {
+                RowMajorLoop<Axis + 1>(begin, end, f, outer..., i);
+            }
+        }
+    }
+
+    // First index innermost (column-major traversal).
+    template <std::size_t Remaining, std::size_t Rank, typename F, typename... Indices>
+    inline void ColumnMajorLoop(const std::array<std::size_t, Rank>& begin, const std::array<std::size_t, Rank>& end, F& f, const Indices... inner) {
+        if constexpr (Remaining == 0) {
+            f(inner...);
+        } else {
+            for (std::size_t i = begin[Remaining - 1]; i < end[Remaining - 1]; ++i) {
+                ColumnMajorLoop<Remaining - 1>(begin, end, f, i, inner...);
+            }
+        }
+    }
+
+    template <std::size_t Rank, typename F>
+    inline void ForRowMajor(const std::array<std::size_t, Rank>& shape, F&& f) {
+        RowMajorLoop<0>(std::array<std::size_t, Rank>{}, shape, f);
+    }
+
+    template <std::size_t Rank, typename F>
+    inline void ForColumnMajor(const std::array<std::size_t, Rank>& shape, F&& f) {
+        ColumnMajorLoop<Rank>(std::array<std::size_t, Rank>{}, shape, f);
+    }
+
+    // Interior points [1, n-1) of every axis, row-major.
+    template <std::size_t Rank, typename F>
+    inline void ForInterior(const std::array<std::size_t, Rank>& shape, F&& f) {
+        std::array<std::size_t, Rank> begin, end;
+        begin.fill(1);
+        for (std::size_t axis = 0; axis < Rank; ++axis) end[axis] = shape[axis] - 1;
+        RowMajorLoop<0>(begin, end, f);
+    }
+
+    // (2*Rank+1)-point Laplacian-type stencil: out = sum of the 2*Rank axis
+    // neighbours - 2*Rank*center. `at(array, i, j, ...)` is the element accessor.
+    template <std::size_t Rank, typename In, typename Out, typename At>
+    inline void Stencil(const std::array<std::size_t, Rank>& shape, const In& in, Out& out, At at) {
+        ForInterior(shape, [&](const auto... index) {
+            const std::array<std::size_t, Rank> c = {index...};
+            double sum = -2.0 * static_cast<double>(Rank) * at(in, index...);
+            for (std::size_t axis = 0; axis < Rank; ++axis) {
+                std::array<std::size_t, Rank> lo = c, hi = c;
+                --lo[axis];
+                ++hi[axis];
+                sum += std::apply([&](const auto... i) { return at(in, i...); }, lo);
+                sum += std::apply([&](const auto... i) { return at(in, i...); }, hi);
+            }
+            at(out, index...) = sum;
+        });
+    }
+
+    // #######################
+    // Harness
+    // #######################
+
+    struct Result {
+        double min_ms, median_ms, p90_ms, max_ms;
+    };
+
+    class Harness {
+    public:
+        Harness(const char* implementation, const Options& options) : implementation_(implementation), options_(options) {
+            if (!options_.json) {
+                std::printf("implementation,case,rank,elements,reps,min_ms,median_ms,p90_ms,max_ms,gbytes_per_s,gflops\n");
+            }
+        }
+
+        const Options& GetOptions() const { return options_; }
+
+        // Times body() and reports it. `bytes` and `flops` are per call.
+        template <typename Body>
+        void Run(const std::string& name, const std::size_t rank, const std::size_t elements,
+                 const double bytes, const double flops, Body&& body) {
+            if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) return;
+
+            for (int i = 0; i < options_.warmup; ++i) body();
+
+            std::vector<double> samples;
+            samples.reserve(options_.reps);
+            for (int i = 0; i < options_.reps; ++i) {
+                const auto start = std::chrono::steady_clock::now();
+                body();
+                const auto stop = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+            }
+            std::sort(samples.begin(), samples.end());
+            const Result r = {samples.front(), Percentile(samples, 0.5), Percentile(samples, 0.9), samples.back()};
+            const double seconds = r.median_ms * 1.0e-3;
+            const double gbps = seconds > 0.0 ? bytes / seconds * 1.0e-9 : 0.0;
+            const double gflops = seconds > 0.0 ? flops / seconds * 1.0e-9 : 0.0;
+
+            if (options_.json) {
+                std::printf("{\"implementation\":\"%s\",\"case\":\"%s\",\"rank\":%zu,\"elements\":%zu,\"reps\":%d,"
+                            "\"min_ms\":%.6f,\"median_ms\":%.6f,\"p90_ms\":%.6f,\"max_ms\":%.6f,\"gbytes_per_s\":%.4f,\"gflops\":%.4f}\n",
+                            implementation_, name.c_str(), rank, elements, options_.reps,
+                            r.min_ms, r.median_ms, r.p90_ms, r.max_ms, gbps, gflops);
+            } else {
+                std::printf("%s,%s,%zu,%zu,%d,%.6f,%.6f,%.6f,%.6f,%.4f,%.4f\n",
+                            implementation_, name.c_str(), rank, elements, options_.reps,
+                            r.min_ms, r.median_ms, r.p90_ms, r.max_ms, gbps, gflops);
+            }
+            std::fflush(stdout);
+        }
+
+    private:
+        const char* implementation_;
+        Options options_;
+
+        static double Percentile(const std::vector<double>& sorted, const double q) {
+            const double position = q * static_cast<double>(sorted.size() - 1);
+            const std::size_t lo = static_cast<std::size_t>(position);
+            const std::size_t hi = std::min(lo + 1, sorted.size() - 1);
+            return sorted[lo] + (sorted[hi] - sorted[lo]) * (position - static_cast<double>(lo));
+        }
+    };
+
+    // True if Traits provides a library reduction Sum(const type&).
+    template <typename Traits>
+    constexpr auto HasSum(int) -> decltype(Traits::Sum(std::declval<const typename Traits::type&>()), bool()) { return true; }
+
+    template <typename Traits>
+    constexpr bool HasSum(...) { return false; }
+
+    // Standard case set shared by all drivers. `Traits<Rank>` supplies
+    //   using type; static type Make(shape); static void Fill(type&, double);
+    //   static double& At(type&, i...); static const double& At(const type&, i...);
+    //   static void Copy(type& dst, const type& src);
+    // and optionally static double Sum(const type&) for a library reduction.
+    template <template <std::size_t> class Traits, std::size_t Rank>
+    void RunStandardCases(Harness& harness) {
+        using A = typename Traits<Rank>::type;
+        const std::array<std::size_t, Rank> shape = CubeShape<Rank>(harness.GetOptions().size);
+        const std::size_t n = Product(shape);
+        const double bytes = static_cast<double>(n * sizeof(double));
+        auto at = [](auto& a, const auto... index) -> decltype(auto) { return Traits<Rank>::At(a, index...); };
+
+        harness.Run("alloc", Rank, n, 0.0, 0.0, [&] {
+            A a = Traits<Rank>::Make(shape);
+            DoNotOptimize(a);
+        });
+
+        A a = Traits<Rank>::Make(shape);
+        A b = Traits<Rank>::Make(shape);
+
+        harness.Run("fill", Rank, n, bytes, 0.0, [&] { Traits<Rank>::Fill(a, 1.0); DoNotOptimize(a); });
+
+        harness.Run("write_row_major", Rank, n, bytes, 0.0, [&] {
+            ForRowMajor(shape, [&](const auto... index) { at(a, index...) = 2.0; });
+            DoNotOptimize(a);
+        });
+
+        harness.Run("write_column_major", Rank, n, bytes, 0.0, [&] {
+            ForColumnMajor(shape, [&](const auto... index) { at(a, index...) = 3.0; });
+            DoNotOptimize(a);
+        });
+
+        harness.Run("sum_row_major", Rank, n, bytes, static_cast<double>(n), [&] {
+            double sum = 0.0;
+            ForRowMajor(shape, [&](const auto... index) { sum += at(static_cast<const A&>(a), index...); });
+            DoNotOptimize(sum);
+        });
+
+        harness.Run("sum_column_major", Rank, n, bytes, static_cast<double>(n), [&] {
+            double sum = 0.0;
+            ForColumnMajor(shape, [&](const auto... index) { sum += at(static_cast<const A&>(a), index...); });
+            DoNotOptimize(sum);
+        });
+
+        if constexpr (HasSum<Traits<Rank>>(0)) {
+            harness.Run("sum_library", Rank, n, bytes, static_cast<double>(n), [&] {
+                DoNotOptimize(Traits<Rank>::Sum(a));
+            });
+        }
+
+        harness.Run("copy", Rank, n, 2.0 * bytes, 0.0, [&] { Traits<Rank>::Copy(b, a); DoNotOptimize(b); });
+
+        const double points = static_cast<double>(n);
+        harness.Run("stencil", Rank, n, 2.0 * bytes, points * (2.0 * Rank + 1.0), [&] {
+            Stencil<Rank>(shape, a, b, [](auto& x, const auto... index) -> decltype(auto) { return Traits<Rank>::At(x, index...); });
+            DoNotOptimize(b);
+        });
+    }
+
+}
+
+#endif /* BENCHMARK_HARNESS_HPP_ */